@@ -1,27 +1,8 @@
-QT       += core gui network charts
+TEMPLATE = subdirs
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+SUBDIRS += \
+    app \
+    benchmarks \
+    tests
 
-CONFIG += c++17
-
-# You can make your code fail to compile if it uses deprecated APIs.
-# In order to do so, uncomment the following line.
-#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
-
-SOURCES += \
-    chartwindow.cpp \
-    dataworker.cpp \
-    jsonstorage.cpp \
-    main.cpp \
-    mainwindow.cpp
-
-HEADERS += \
-    chartwindow.h \
-    dataworker.h \
-    jsonstorage.h \
-    mainwindow.h
-
-# Default rules for deployment.
-qnx: target.path = /tmp/$${TARGET}/bin
-else: unix:!android: target.path = /opt/$${TARGET}/bin
-!isEmpty(target.path): INSTALLS += target
+app.file = app.pro
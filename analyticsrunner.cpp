@@ -0,0 +1,164 @@
+/**
+ * @file analyticsrunner.cpp
+ * @brief Implementacja zestawień z lokalnej bazy w wierszu poleceń.
+ */
+#include "analyticsrunner.h"
+#include "commandline.h"
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstring>
+
+/**
+ * @brief Sprawdza, czy program został uruchomiony w trybie zestawień.
+ * @param argc Liczba argumentów.
+ * @param argv Tablica argumentów.
+ * @return true, jeśli wśród argumentów jest --analyze.
+ */
+bool AnalyticsRunner::isRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--analyze") == 0)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Odczytuje parametry zestawienia z argumentów wywołania.
+ *
+ * Data końcowa podana bez godziny obejmuje całą dobę.
+ *
+ * @param arguments Argumenty wywołania.
+ * @param options Odczytane parametry.
+ * @param error Opis błędu.
+ * @return true, jeśli argumenty są prawidłowe.
+ */
+bool AnalyticsRunner::parseArguments(const QStringList &arguments, Options &options, QString &error)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Zestawienia z lokalnej bazy pomiarów wszystkich stacji.");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "analyze", "Tryb zestawień (bez interfejsu graficznego)." },
+        { "params", "Nazwy lub kody parametrów rozdzielone przecinkami, np. PM10,PM2.5.", "codes" },
+        { "stations", "Identyfikatory stacji rozdzielone przecinkami (domyślnie wszystkie).", "ids" },
+        { "from", "Początek zakresu (yyyy-MM-dd [HH[:mm]]).", "date" },
+        { "to", "Koniec zakresu (yyyy-MM-dd [HH[:mm]]), domyślnie teraz.", "date" },
+        { "days", "Zakres: ostatnie N dni.", "n" },
+        { "aggregate", "Wartość rankingu: mean, max, count, exceedances, exceedance-days.", "name", "mean" },
+        { "threshold", "Próg przekroczeń.", "value", QString::number(options.query.threshold) },
+        { "top", "Liczba pozycji rankingu dla każdego parametru.", "n" },
+        { "json", "Wypisz wyniki w formacie JSON." },
+    });
+
+    if (!parser.parse(arguments)) {
+        error = parser.errorText();
+        return false;
+    }
+    if (parser.isSet("help")) {
+        error = parser.helpText();
+        return false;
+    }
+
+    ArchiveAnalytics::Query &query = options.query;
+    if (parser.isSet("params"))
+        query.params = parser.value("params").split(',', Qt::SkipEmptyParts);
+    if (parser.isSet("stations")) {
+        const QStringList parts = parser.value("stations").split(',', Qt::SkipEmptyParts);
+        for (const QString &part : parts) {
+            bool ok = false;
+            query.stationIds.append(part.trimmed().toInt(&ok));
+            if (!ok) {
+                error = "Nieprawidłowa lista stacji: " + parser.value("stations");
+                return false;
+            }
+        }
+    }
+
+    const QString to = parser.value("to");
+    query.to = parser.isSet("to") ? parseCommandLineDate(to) : QDateTime::currentDateTime();
+    if (parser.isSet("to") && query.to.isValid() && to.trimmed().size() == 10)
+        query.to = query.to.addDays(1).addMSecs(-1);
+    if (parser.isSet("days"))
+        query.from = query.to.addDays(-parser.value("days").toInt());
+    else if (parser.isSet("from"))
+        query.from = parseCommandLineDate(parser.value("from"));
+    if (!query.from.isValid() || !query.to.isValid() || query.from > query.to) {
+        error = "Podaj prawidłowy zakres dat (--from/--to albo --days).";
+        return false;
+    }
+
+    if (!ArchiveAnalytics::parseAggregate(parser.value("aggregate"), query.aggregate)) {
+        error = "Nieznany agregat: " + parser.value("aggregate");
+        return false;
+    }
+    bool ok = false;
+    query.threshold = parser.value("threshold").toDouble(&ok);
+    if (!ok) {
+        error = "Nieprawidłowy próg: " + parser.value("threshold");
+        return false;
+    }
+    options.top = qMax(0, parser.value("top").toInt());
+    options.json = parser.isSet("json");
+    return true;
+}
+
+/**
+ * @brief Konstruktor klasy AnalyticsRunner.
+ * @param options Parametry zestawienia.
+ */
+AnalyticsRunner::AnalyticsRunner(const Options &options)
+    : options(options), out(stdout), err(stderr)
+{
+}
+
+/**
+ * @brief Oblicza zestawienie i wypisuje wyniki.
+ *
+ * Na standardowe wyjście trafia ranking, a na wyjście błędów liczba pozycji i czas obliczeń.
+ *
+ * @return Kod zakończenia.
+ */
+int AnalyticsRunner::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+    const QVector<ArchiveAnalytics::Row> rows = ArchiveAnalytics::run(options.query);
+    const qint64 elapsed = timer.elapsed();
+
+    QJsonArray array;
+    if (!options.json)
+        out << "miejsce\tparametr\tstacja_id\tstacja\twartosc\tpomiary\tmin\tmax\tsrednia\tprzekroczenia\n";
+    for (const ArchiveAnalytics::Row &row : rows) {
+        if (options.top > 0 && row.rank > options.top)
+            continue;
+        if (options.json) {
+            QJsonObject object;
+            object.insert("rank", row.rank);
+            object.insert("paramName", row.paramName);
+            object.insert("stationId", row.stationId);
+            object.insert("stationName", row.stationName);
+            object.insert("value", row.value);
+            object.insert("count", row.totals.count);
+            object.insert("min", row.totals.min);
+            object.insert("max", row.totals.max);
+            object.insert("mean", row.totals.mean());
+            object.insert("exceedances", row.exceedances);
+            array.append(object);
+        } else {
+            out << row.rank << '\t' << row.paramName << '\t' << row.stationId << '\t' << row.stationName << '\t'
+                << row.value << '\t' << row.totals.count << '\t' << row.totals.min << '\t' << row.totals.max << '\t'
+                << row.totals.mean() << '\t' << row.exceedances << '\n';
+        }
+    }
+    if (options.json)
+        out << QJsonDocument(array).toJson();
+    out.flush();
+
+    err << "Pozycje: " << rows.size() << ", czas: " << elapsed << " ms\n";
+    err.flush();
+    return rows.isEmpty() ? 1 : 0;
+}
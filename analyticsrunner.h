@@ -0,0 +1,71 @@
+/**
+ * @file analyticsrunner.h
+ * @brief Definicja klasy AnalyticsRunner - zestawień z lokalnej bazy w wierszu poleceń.
+ */
+
+#ifndef ANALYTICSRUNNER_H
+#define ANALYTICSRUNNER_H
+
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include "archiveanalytics.h"
+
+/**
+ * @class AnalyticsRunner
+ * @brief Wypisuje ranking stacji obliczony przez ArchiveAnalytics.
+ *
+ * Tryb uruchamiany jest argumentem --analyze i działa bez interfejsu graficznego,
+ * wyłącznie na danych zapisanych w lokalnej bazie (bez zapytań do sieci). Przykład:
+ * "--analyze --params PM2.5 --from 2025-01-01 --to 2025-01-31 --aggregate mean".
+ * Wyniki wypisywane są w formacie TSV lub JSON.
+ */
+class AnalyticsRunner
+{
+public:
+    /**
+     * @struct Options
+     * @brief Parametry zestawienia.
+     */
+    struct Options {
+        ArchiveAnalytics::Query query;  ///< Zapytanie.
+        int top = 0;                    ///< Liczba pozycji rankingu na parametr (0 - wszystkie).
+        bool json = false;              ///< Czy wypisywać wyniki w formacie JSON zamiast TSV.
+    };
+
+    /**
+     * @brief Sprawdza, czy program został uruchomiony w trybie zestawień.
+     * @param argc Liczba argumentów.
+     * @param argv Tablica argumentów.
+     * @return true, jeśli wśród argumentów jest --analyze.
+     */
+    static bool isRequested(int argc, char *argv[]);
+
+    /**
+     * @brief Odczytuje parametry zestawienia z argumentów wywołania.
+     * @param arguments Argumenty wywołania.
+     * @param options Odczytane parametry.
+     * @param error Opis błędu, jeśli argumenty są nieprawidłowe.
+     * @return true, jeśli argumenty są prawidłowe.
+     */
+    static bool parseArguments(const QStringList &arguments, Options &options, QString &error);
+
+    /**
+     * @brief Konstruktor klasy AnalyticsRunner.
+     * @param options Parametry zestawienia.
+     */
+    explicit AnalyticsRunner(const Options &options);
+
+    /**
+     * @brief Oblicza zestawienie i wypisuje wyniki.
+     * @return Kod zakończenia: 0 - sukces, 1 - brak pomiarów w zakresie.
+     */
+    int run();
+
+private:
+    Options options;
+    QTextStream out;
+    QTextStream err;
+};
+
+#endif // ANALYTICSRUNNER_H
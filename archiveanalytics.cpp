@@ -0,0 +1,215 @@
+/**
+ * @file archiveanalytics.cpp
+ * @brief Implementacja zestawień z lokalnej bazy pomiarów wszystkich stacji.
+ */
+#include "archiveanalytics.h"
+#include "jsonstorage.h"
+#include "tracing.h"
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QJsonObject>
+#include <QPair>
+#include <QtConcurrent>
+#include <algorithm>
+
+/**
+ * @brief Wyszukuje zapisane sensory pasujące do zapytania.
+ *
+ * Stacje odczytywane są z nazw plików "<stacja>-listasensorow.json", a parametr
+ * pasuje, jeśli zgadza się jego nazwa lub kod (bez rozróżniania wielkości liter).
+ *
+ * @param query Parametry zestawienia.
+ * @return Sensory, dla których istnieje plik z pomiarami.
+ */
+QVector<ArchiveAnalytics::Source> ArchiveAnalytics::sources(const Query &query)
+{
+    QVector<Source> result;
+    const QStringList catalogs = QDir(getJsonDir()).entryList({ "*-listasensorow.json" }, QDir::Files, QDir::Name);
+    for (const QString &catalog : catalogs) {
+        bool ok = false;
+        const int stationId = catalog.section('-', 0, 0).toInt(&ok);
+        if (!ok || (!query.stationIds.isEmpty() && !query.stationIds.contains(stationId)))
+            continue;
+
+        const QJsonArray sensors = loadSensors(stationId);
+        for (const QJsonValue &value : sensors) {
+            const QJsonObject obj = value.toObject();
+            Source source;
+            source.stationId = stationId;
+            source.sensorId = obj["id"].toInt();
+            source.paramName = obj["paramName"].toString();
+            source.paramCode = obj["paramCode"].toString();
+            if (!query.params.isEmpty()
+                && !query.params.contains(source.paramCode, Qt::CaseInsensitive)
+                && !query.params.contains(source.paramName, Qt::CaseInsensitive))
+                continue;
+            if (!QFile::exists(getMeasurementFilePath(stationId, source.sensorId))
+                && !QFile::exists(getJsonFilePath(QString("%1-%2.json").arg(stationId).arg(source.sensorId))))
+                continue;
+            result.append(source);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Etap map - oblicza agregat pomiarów jednego sensora.
+ *
+ * Dla średniej, maksimum i liczby pomiarów pełne doby zakresu odczytywane są z agregatów
+ * dobowych, a pomiary godzinowe tylko dla niepełnych dób na krańcach zakresu. Liczba
+ * przekroczeń godzinowych wymaga pomiarów godzinowych z całego zakresu, a liczba dób
+ * z przekroczeniem - jedynie agregatów dobowych (dób nachodzących na zakres).
+ * Zestawienie działa bez interfejsu, więc nieaktualne agregaty odbudowywane są na miejscu
+ * (ensureRollups).
+ *
+ * @param source Sensor.
+ * @param query Parametry zestawienia.
+ * @return Agregat sensora.
+ */
+ArchiveAnalytics::Row ArchiveAnalytics::mapSource(const Source &source, const Query &query)
+{
+    TRACE_SPAN("analyticsMap");
+    Row row;
+    row.stationId = source.stationId;
+    row.paramName = source.paramName;
+    row.sensors = 1;
+    if (query.aggregate != Exceedances)
+        ensureRollups(source.stationId, source.sensorId);
+
+    if (query.aggregate == ExceedanceDays) {
+        const QVector<RollupBucket> days = loadRollups(source.stationId, source.sensorId, RollupStore::Daily,
+                                                       query.from.date().startOfDay(),
+                                                       query.to.date().addDays(1).startOfDay().addMSecs(-1));
+        for (const RollupBucket &day : days) {
+            row.totals.merge(day);
+            if (day.count > 0 && day.mean() > query.threshold)
+                ++row.exceedances;
+        }
+        return row;
+    }
+
+    auto addMeasurements = [&](qint64 from, qint64 to) {
+        if (from > to)
+            return;
+        const MeasurementSeries series = loadMeasurementsRange(source.stationId, source.sensorId,
+                                                               QDateTime::fromMSecsSinceEpoch(from),
+                                                               QDateTime::fromMSecsSinceEpoch(to));
+        const double *values = series.values().constData();
+        for (int i = 0; i < series.size(); ++i) {
+            row.totals.add(values[i]);
+            if (values[i] > query.threshold)
+                ++row.exceedances;
+        }
+    };
+
+    const qint64 from = query.from.toMSecsSinceEpoch();
+    const qint64 to = query.to.toMSecsSinceEpoch();
+    const QDateTime firstMidnight = query.from.date().startOfDay();
+    const qint64 wholeFrom = (firstMidnight == query.from) ? from
+                                                          : query.from.date().addDays(1).startOfDay().toMSecsSinceEpoch();
+    const qint64 wholeTo = QDateTime::fromMSecsSinceEpoch(to + 1).date().startOfDay().toMSecsSinceEpoch();
+    if (query.aggregate == Exceedances || wholeFrom >= wholeTo) {
+        addMeasurements(from, to);
+        return row;
+    }
+
+    addMeasurements(from, wholeFrom - 1);
+    const QVector<RollupBucket> days = loadRollups(source.stationId, source.sensorId, RollupStore::Daily,
+                                                   QDateTime::fromMSecsSinceEpoch(wholeFrom),
+                                                   QDateTime::fromMSecsSinceEpoch(wholeTo - 1));
+    for (const RollupBucket &day : days) {
+        if (day.start >= wholeFrom && day.start < wholeTo)
+            row.totals.merge(day);
+    }
+    addMeasurements(wholeTo, to);
+    return row;
+}
+
+/**
+ * @brief Oblicza zestawienie równolegle na wszystkich rdzeniach.
+ *
+ * Etap map wykonywany jest dla każdego sensora w globalnej puli wątków QtConcurrent,
+ * a etap reduce łączy wyniki sensorów tej samej stacji i parametru (np. po wymianie
+ * sensora). Stacje bez pomiarów w zakresie są pomijane.
+ *
+ * @param query Parametry zestawienia.
+ * @return Pozycje pogrupowane według parametru, w każdej grupie malejąco według wartości.
+ */
+QVector<ArchiveAnalytics::Row> ArchiveAnalytics::run(const Query &query)
+{
+    TRACE_SPAN("analytics");
+    using Groups = QHash<QPair<int, QString>, Row>;
+
+    const QVector<Source> list = sources(query);
+    const Groups groups = QtConcurrent::blockingMappedReduced<Groups>(
+        list,
+        [query](const Source &source) { return mapSource(source, query); },
+        [](Groups &groups, const Row &row) {
+            Row &group = groups[qMakePair(row.stationId, row.paramName)];
+            if (group.sensors == 0) {
+                group = row;
+                return;
+            }
+            group.sensors += row.sensors;
+            group.totals.merge(row.totals);
+            group.exceedances += row.exceedances;
+        },
+        QtConcurrent::UnorderedReduce);
+
+    QHash<int, QString> stationNames;
+    const QJsonArray stations = loadStationList();
+    for (const QJsonValue &value : stations) {
+        const QJsonObject obj = value.toObject();
+        stationNames.insert(obj["id"].toInt(), obj["stationName"].toString());
+    }
+
+    QVector<Row> rows;
+    rows.reserve(groups.size());
+    for (const Row &group : groups) {
+        if (group.totals.count == 0)
+            continue;
+        Row row = group;
+        row.stationName = stationNames.value(row.stationId);
+        switch (query.aggregate) {
+        case Mean: row.value = row.totals.mean(); break;
+        case Max: row.value = row.totals.max; break;
+        case Count: row.value = double(row.totals.count); break;
+        case Exceedances:
+        case ExceedanceDays: row.value = double(row.exceedances); break;
+        }
+        rows.append(row);
+    }
+
+    std::sort(rows.begin(), rows.end(), [](const Row &a, const Row &b) {
+        if (a.paramName != b.paramName)
+            return QString::localeAwareCompare(a.paramName, b.paramName) < 0;
+        if (a.value != b.value)
+            return a.value > b.value;
+        return a.stationId < b.stationId;
+    });
+    for (int i = 0; i < rows.size(); ++i)
+        rows[i].rank = (i > 0 && rows[i - 1].paramName == rows[i].paramName) ? rows[i - 1].rank + 1 : 1;
+    return rows;
+}
+
+/**
+ * @brief Odczytuje nazwę agregatu.
+ * @param name Nazwa: mean, max, count, exceedances lub exceedance-days.
+ * @param aggregate Odczytany agregat.
+ * @return false, jeśli nazwa jest nieznana.
+ */
+bool ArchiveAnalytics::parseAggregate(const QString &name, Aggregate &aggregate)
+{
+    static const QPair<const char *, Aggregate> names[] = {
+        { "mean", Mean }, { "max", Max }, { "count", Count },
+        { "exceedances", Exceedances }, { "exceedance-days", ExceedanceDays },
+    };
+    for (const auto &entry : names) {
+        if (name.compare(QLatin1String(entry.first), Qt::CaseInsensitive) == 0) {
+            aggregate = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file archiveanalytics.h
+ * @brief Definicja klasy ArchiveAnalytics - zestawień z lokalnej bazy pomiarów wszystkich stacji.
+ */
+
+#ifndef ARCHIVEANALYTICS_H
+#define ARCHIVEANALYTICS_H
+
+#include <QDateTime>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "rollupstore.h"
+
+/**
+ * @class ArchiveAnalytics
+ * @brief Oblicza agregaty pomiarów wszystkich zapisanych sensorów i zwraca ranking stacji.
+ *
+ * Sensory wyszukiwane są w katalogach "*-listasensorow.json" lokalnej bazy i grupowane
+ * według nazwy parametru. Obliczenia wykonywane są w schemacie map-reduce w puli wątków
+ * QtConcurrent: etap map wczytuje jeden sensor i zwraca jego agregat, a etap reduce
+ * łączy agregaty sensorów tej samej stacji i parametru. Pełne doby zakresu odczytywane są
+ * z agregatów dobowych (RollupStore), a pomiary godzinowe tylko dla niepełnych dób na jego
+ * krańcach, więc koszt zależy od liczby dni, a nie pomiarów.
+ */
+class ArchiveAnalytics
+{
+public:
+    /**
+     * @enum Aggregate
+     * @brief Wartość, według której tworzony jest ranking.
+     */
+    enum Aggregate {
+        Mean,           ///< Średnia pomiarów.
+        Max,            ///< Największy pomiar.
+        Count,          ///< Liczba pomiarów (kompletność danych).
+        Exceedances,    ///< Liczba pomiarów godzinowych powyżej progu.
+        ExceedanceDays  ///< Liczba dób ze średnią dobową powyżej progu.
+    };
+
+    /**
+     * @struct Query
+     * @brief Parametry zestawienia.
+     */
+    struct Query {
+        QStringList params;             ///< Nazwy lub kody parametrów (pusta lista - wszystkie).
+        QVector<int> stationIds;        ///< Wybrane stacje (pusta lista - wszystkie).
+        QDateTime from;                 ///< Początek zakresu.
+        QDateTime to;                   ///< Koniec zakresu.
+        Aggregate aggregate = Mean;     ///< Wartość rankingu.
+        double threshold = 50;          ///< Próg dla Exceedances i ExceedanceDays.
+    };
+
+    /**
+     * @struct Source
+     * @brief Sensor z lokalnej bazy.
+     */
+    struct Source {
+        int stationId = -1;     ///< ID stacji.
+        int sensorId = -1;      ///< ID sensora.
+        QString paramName;      ///< Nazwa parametru.
+        QString paramCode;      ///< Kod parametru.
+    };
+
+    /**
+     * @struct Row
+     * @brief Pozycja rankingu - agregat pomiarów jednego parametru na jednej stacji.
+     */
+    struct Row {
+        int stationId = -1;         ///< ID stacji.
+        QString stationName;        ///< Nazwa stacji.
+        QString paramName;          ///< Nazwa parametru.
+        int sensors = 0;            ///< Liczba połączonych sensorów.
+        RollupBucket totals;        ///< Liczba, suma, minimum i maksimum pomiarów.
+        qint64 exceedances = 0;     ///< Liczba pomiarów lub dób powyżej progu.
+        double value = 0;           ///< Wartość rankingu.
+        int rank = 0;               ///< Miejsce w rankingu parametru (od 1).
+    };
+
+    /**
+     * @brief Wyszukuje zapisane sensory pasujące do zapytania.
+     * @param query Parametry zestawienia.
+     * @return Sensory, dla których istnieje plik z pomiarami.
+     */
+    static QVector<Source> sources(const Query &query);
+
+    /**
+     * @brief Oblicza zestawienie równolegle na wszystkich rdzeniach.
+     * @param query Parametry zestawienia.
+     * @return Pozycje pogrupowane według parametru, w każdej grupie malejąco według wartości.
+     */
+    static QVector<Row> run(const Query &query);
+
+    /**
+     * @brief Odczytuje nazwę agregatu.
+     * @param name Nazwa: mean, max, count, exceedances lub exceedance-days.
+     * @param aggregate Odczytany agregat.
+     * @return false, jeśli nazwa jest nieznana.
+     */
+    static bool parseAggregate(const QString &name, Aggregate &aggregate);
+
+private:
+    static Row mapSource(const Source &source, const Query &query);
+};
+
+#endif // ARCHIVEANALYTICS_H
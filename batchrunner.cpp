@@ -0,0 +1,323 @@
+/**
+ * @file batchrunner.cpp
+ * @brief Implementacja trybu wsadowego (bez interfejsu graficznego).
+ */
+#include "batchrunner.h"
+#include "cachingnetworkmanager.h"
+#include "commandline.h"
+#include "fetchservice.h"
+#include "dataworker.h"
+#include "jsonstorage.h"
+#include "seriesstatistics.h"
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkReply>
+#include <cstring>
+
+namespace {
+
+/**
+ * @brief Odczytuje listę liczb rozdzielonych przecinkami.
+ */
+bool parseIds(const QString &text, QVector<int> &ids)
+{
+    const QStringList parts = text.split(',', Qt::SkipEmptyParts);
+    for (const QString &part : parts) {
+        bool ok = false;
+        ids.append(part.trimmed().toInt(&ok));
+        if (!ok)
+            return false;
+    }
+    return true;
+}
+
+}
+
+/**
+ * @brief Sprawdza, czy program został uruchomiony w trybie wsadowym.
+ * @param argc Liczba argumentów.
+ * @param argv Tablica argumentów.
+ * @return true, jeśli wśród argumentów jest --batch.
+ */
+bool BatchRunner::isRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--batch") == 0)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Odczytuje parametry trybu wsadowego z argumentów wywołania.
+ *
+ * Zakres dat podaje się przez --from i --to (domyślnie teraz) albo przez --days
+ * (ostatnie N dni), co jest wygodne przy uruchamianiu z crona.
+ *
+ * @param arguments Argumenty wywołania.
+ * @param options Odczytane parametry.
+ * @param error Opis błędu.
+ * @return true, jeśli argumenty są prawidłowe.
+ */
+bool BatchRunner::parseArguments(const QStringList &arguments, Options &options, QString &error)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Pobieranie danych archiwalnych GIOŚ w trybie wsadowym.");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "batch", "Tryb wsadowy (bez interfejsu graficznego)." },
+        { "stations", "Identyfikatory stacji rozdzielone przecinkami lub \"all\".", "ids", "all" },
+        { "sensors", "Identyfikatory sensorów rozdzielone przecinkami.", "ids" },
+        { "params", "Kody parametrów rozdzielone przecinkami, np. PM10,NO2.", "codes" },
+        { "from", "Początek zakresu (yyyy-MM-dd [HH[:mm]]).", "date" },
+        { "to", "Koniec zakresu (yyyy-MM-dd [HH[:mm]]), domyślnie teraz.", "date" },
+        { "days", "Zakres: ostatnie N dni.", "n" },
+        { "jobs", "Liczba sensorów pobieranych jednocześnie.", "n", QString::number(options.jobs) },
+        { "pages", "Liczba stron pobieranych jednocześnie dla sensora.", "n", QString::number(options.pages) },
+        { "stats", "Wypisz statystyki pobranych sensorów." },
+    });
+
+    if (!parser.parse(arguments)) {
+        error = parser.errorText();
+        return false;
+    }
+    if (parser.isSet("help")) {
+        error = parser.helpText();
+        return false;
+    }
+
+    const QString stations = parser.value("stations");
+    if (stations != "all" && !parseIds(stations, options.stationIds)) {
+        error = "Nieprawidłowa lista stacji: " + stations;
+        return false;
+    }
+    if (parser.isSet("sensors") && !parseIds(parser.value("sensors"), options.sensorIds)) {
+        error = "Nieprawidłowa lista sensorów: " + parser.value("sensors");
+        return false;
+    }
+    if (parser.isSet("params"))
+        options.params = parser.value("params").split(',', Qt::SkipEmptyParts);
+
+    options.to = parser.isSet("to") ? parseCommandLineDate(parser.value("to")) : QDateTime::currentDateTime();
+    if (parser.isSet("days"))
+        options.from = options.to.addDays(-parser.value("days").toInt());
+    else if (parser.isSet("from"))
+        options.from = parseCommandLineDate(parser.value("from"));
+    if (!options.from.isValid() || !options.to.isValid() || options.from > options.to) {
+        error = "Podaj prawidłowy zakres dat (--from/--to albo --days).";
+        return false;
+    }
+
+    options.jobs = qMax(1, parser.value("jobs").toInt());
+    options.pages = qMax(1, parser.value("pages").toInt());
+    options.printStats = parser.isSet("stats");
+    return true;
+}
+
+/**
+ * @brief Konstruktor klasy BatchRunner.
+ *
+ * Wszystkie zapytania o dane trafiają do jednego hosta, więc pula ma jeden wątek,
+ * a liczbę jednocześnie pobieranych sensorów określa parametr jobs.
+ *
+ * @param options Parametry trybu wsadowego.
+ * @param parent Obiekt nadrzędny.
+ */
+BatchRunner::BatchRunner(const Options &options, QObject *parent)
+    : QObject(parent), options(options),
+    networkManager(new CachingNetworkManager(getJsonFilePath("httpcache"), this)),
+    fetchService(new FetchService(1, options.jobs, this)),
+    out(stdout), err(stderr)
+{
+    fetchService->setJobsPerThread(options.jobs);
+}
+
+/**
+ * @brief Rozpoczyna pobieranie list stacji i sensorów, a następnie danych.
+ */
+void BatchRunner::start()
+{
+    if (options.printStats)
+        out << "stacja\tsensor\tparametr\tpomiary\tmin\tmax\tsrednia\tp95\n";
+
+    if (options.stationIds.isEmpty()) {
+        requestStations();
+        return;
+    }
+    for (int stationId : std::as_const(options.stationIds))
+        requestSensors(stationId);
+}
+
+/**
+ * @brief Pobiera listę wszystkich stacji (lub wczytuje ją z lokalnego katalogu).
+ */
+void BatchRunner::requestStations()
+{
+    ++pendingMetadata;
+    QNetworkReply *reply = networkManager->get(QNetworkRequest(QUrl("https://api.gios.gov.pl/pjp-api/rest/station/findAll")));
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        reply->deleteLater();
+        --pendingMetadata;
+
+        QJsonArray stations;
+        if (reply->error() == QNetworkReply::NoError) {
+            stations = QJsonDocument::fromJson(reply->readAll()).array();
+            saveStation(stations);
+        } else {
+            err << "Nie udało się pobrać listy stacji (" << reply->errorString() << "), używam lokalnej.\n";
+            stations = loadStationList();
+        }
+        err.flush();
+
+        if (stations.isEmpty()) {
+            err << "Brak listy stacji.\n";
+            err.flush();
+            done = true;
+            emit finished(2);
+            return;
+        }
+        for (const QJsonValue &value : std::as_const(stations))
+            requestSensors(value.toObject()["id"].toInt());
+    });
+}
+
+/**
+ * @brief Pobiera listę sensorów stacji (lub wczytuje ją z lokalnego katalogu).
+ * @param stationId ID stacji.
+ */
+void BatchRunner::requestSensors(int stationId)
+{
+    ++pendingMetadata;
+    QUrl url(QString("https://api.gios.gov.pl/pjp-api/rest/station/sensors/%1").arg(stationId));
+    QNetworkReply *reply = networkManager->get(QNetworkRequest(url));
+    connect(reply, &QNetworkReply::finished, this, [this, reply, stationId]() {
+        reply->deleteLater();
+        --pendingMetadata;
+
+        if (reply->error() == QNetworkReply::NoError) {
+            QJsonArray sensors = QJsonDocument::fromJson(reply->readAll()).array();
+            saveSensors(stationId, sensors);
+            addJobs(stationId, sensors, true);
+        } else {
+            addJobs(stationId, loadSensors(stationId), false);
+        }
+        submitJobs();
+        finishIfDone();
+    });
+}
+
+/**
+ * @brief Dodaje do kolejki sensory stacji spełniające kryteria wyboru.
+ * @param stationId ID stacji.
+ * @param sensors Lista sensorów.
+ * @param fromApi true dla odpowiedzi API (dane parametru w obiekcie "param").
+ */
+void BatchRunner::addJobs(int stationId, const QJsonArray &sensors, bool fromApi)
+{
+    for (const QJsonValue &value : sensors) {
+        const QJsonObject sensor = value.toObject();
+        const QJsonObject param = fromApi ? sensor["param"].toObject() : sensor;
+        const int sensorId = sensor["id"].toInt();
+        const QString paramName = param["paramName"].toString();
+        const QString paramCode = param["paramCode"].toString();
+
+        if (!options.sensorIds.isEmpty() && !options.sensorIds.contains(sensorId))
+            continue;
+        if (!options.params.isEmpty()
+            && !options.params.contains(paramCode, Qt::CaseInsensitive)
+            && !options.params.contains(paramName, Qt::CaseInsensitive))
+            continue;
+
+        pendingJobs.enqueue({ stationId, sensorId, paramName });
+    }
+}
+
+/**
+ * @brief Przekazuje oczekujące sensory do puli wątków, dopóki ma ona wolne miejsca.
+ *
+ * Sensory, dla których cały zakres jest już zapisany lokalnie, nie wymagają żadnego zapytania.
+ */
+void BatchRunner::submitJobs()
+{
+    while (!pendingJobs.isEmpty()) {
+        const Job job = pendingJobs.head();
+        const QVector<QPair<QDateTime, QDateTime>> ranges = missingRanges(job.stationId, job.sensorId, options.from, options.to);
+        if (ranges.isEmpty()) {
+            pendingJobs.dequeue();
+            ++upToDateJobs;
+            printStats(job);
+            continue;
+        }
+
+        DataWorker *worker = new DataWorker(job.sensorId, ranges);
+        worker->setMaxConcurrentPages(options.pages);
+        connect(worker, &DataWorker::dataReady, this, [this, job, ranges](MeasurementSeries series, bool complete) {
+            onJobFinished(job, ranges, series, complete);
+        });
+        if (!fetchService->submit(worker)) {
+            delete worker;
+            return;
+        }
+        pendingJobs.dequeue();
+        ++activeJobs;
+    }
+}
+
+/**
+ * @brief Zapisuje pobrane dane sensora i uruchamia kolejne zadania.
+ * @param job Zakończone zadanie.
+ * @param ranges Pobrane przedziały.
+ * @param series Pobrane pomiary.
+ * @param complete true, jeśli pobrano wszystkie przedziały.
+ */
+void BatchRunner::onJobFinished(const Job &job, const QVector<QPair<QDateTime, QDateTime>> &ranges,
+                                const MeasurementSeries &series, bool complete)
+{
+    --activeJobs;
+    if (complete) {
+        saveFetchedRanges(job.stationId, job.sensorId, ranges, series);
+        ++succeededJobs;
+        fetchedPoints += series.size();
+        printStats(job);
+    } else {
+        ++failedJobs;
+        err << "Nie udało się pobrać danych sensora " << job.sensorId << " (stacja " << job.stationId << ").\n";
+        err.flush();
+    }
+    submitJobs();
+    finishIfDone();
+}
+
+/**
+ * @brief Wypisuje statystyki sensora w zadanym zakresie dat (jeśli włączono --stats).
+ * @param job Zadanie.
+ */
+void BatchRunner::printStats(const Job &job)
+{
+    if (!options.printStats)
+        return;
+
+    const SeriesStatistics stats = SeriesStatistics::compute(
+        loadMeasurementsRange(job.stationId, job.sensorId, options.from, options.to));
+    out << job.stationId << '\t' << job.sensorId << '\t' << job.paramName << '\t' << stats.count;
+    if (stats.isValid())
+        out << '\t' << stats.min << '\t' << stats.max << '\t' << stats.mean << '\t' << stats.p95;
+    out << '\n';
+    out.flush();
+}
+
+/**
+ * @brief Kończy pracę, jeśli nie ma już oczekujących ani trwających zadań.
+ */
+void BatchRunner::finishIfDone()
+{
+    if (done || pendingMetadata > 0 || activeJobs > 0 || !pendingJobs.isEmpty())
+        return;
+
+    done = true;
+    err << "Pobrano sensory: " << succeededJobs << ", aktualne: " << upToDateJobs
+        << ", błędy: " << failedJobs << ", nowe pomiary: " << fetchedPoints << "\n";
+    err.flush();
+    emit finished(failedJobs > 0 ? 1 : 0);
+}
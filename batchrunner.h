@@ -0,0 +1,122 @@
+/**
+ * @file batchrunner.h
+ * @brief Definicja klasy BatchRunner - trybu wsadowego (bez interfejsu graficznego).
+ */
+
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QQueue>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include <QPair>
+#include "measurementseries.h"
+
+class CachingNetworkManager;
+class FetchService;
+
+/**
+ * @class BatchRunner
+ * @brief Pobiera dane archiwalne wielu stacji i sensorów bez interfejsu graficznego.
+ *
+ * Tryb uruchamiany jest argumentem --batch (np. z crona). Listy stacji i sensorów pobierane
+ * są z API (z lokalnym katalogiem jako zapasem), a dla każdego wybranego sensora pobierane
+ * są tylko brakujące w lokalnej bazie fragmenty zakresu dat, przez tę samą pulę wątków
+ * (FetchService) i logikę stron (DataWorker), co w trybie graficznym.
+ */
+class BatchRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @struct Options
+     * @brief Parametry trybu wsadowego.
+     */
+    struct Options {
+        QVector<int> stationIds;        ///< Wybrane stacje (pusta lista - wszystkie).
+        QVector<int> sensorIds;         ///< Wybrane sensory (pusta lista - wszystkie).
+        QStringList params;             ///< Wybrane parametry, np. PM10 (pusta lista - wszystkie).
+        QDateTime from;                 ///< Początek zakresu dat.
+        QDateTime to;                   ///< Koniec zakresu dat.
+        int jobs = 8;                   ///< Liczba sensorów pobieranych jednocześnie.
+        int pages = 4;                  ///< Liczba stron pobieranych jednocześnie dla jednego sensora.
+        bool printStats = false;        ///< Czy wypisywać statystyki pobranych sensorów.
+    };
+
+    /**
+     * @brief Sprawdza, czy program został uruchomiony w trybie wsadowym.
+     * @param argc Liczba argumentów.
+     * @param argv Tablica argumentów.
+     * @return true, jeśli wśród argumentów jest --batch.
+     */
+    static bool isRequested(int argc, char *argv[]);
+
+    /**
+     * @brief Odczytuje parametry trybu wsadowego z argumentów wywołania.
+     * @param arguments Argumenty wywołania.
+     * @param options Odczytane parametry.
+     * @param error Opis błędu, jeśli argumenty są nieprawidłowe.
+     * @return true, jeśli argumenty są prawidłowe.
+     */
+    static bool parseArguments(const QStringList &arguments, Options &options, QString &error);
+
+    /**
+     * @brief Konstruktor klasy BatchRunner.
+     * @param options Parametry trybu wsadowego.
+     * @param parent Obiekt nadrzędny.
+     */
+    explicit BatchRunner(const Options &options, QObject *parent = nullptr);
+
+    /**
+     * @brief Rozpoczyna pobieranie list stacji i sensorów, a następnie danych.
+     */
+    void start();
+
+signals:
+    /**
+     * @brief Emitowany po zakończeniu wszystkich zadań.
+     * @param exitCode Kod zakończenia: 0 - sukces, 1 - część sensorów nie została pobrana, 2 - brak listy stacji.
+     */
+    void finished(int exitCode);
+
+private:
+    /**
+     * @struct Job
+     * @brief Sensor do pobrania.
+     */
+    struct Job {
+        int stationId;
+        int sensorId;
+        QString paramName;
+    };
+
+    void requestStations();
+    void requestSensors(int stationId);
+    void addJobs(int stationId, const QJsonArray &sensors, bool fromApi);
+    void submitJobs();
+    void onJobFinished(const Job &job, const QVector<QPair<QDateTime, QDateTime>> &ranges,
+                       const MeasurementSeries &series, bool complete);
+    void printStats(const Job &job);
+    void finishIfDone();
+
+    Options options;
+    CachingNetworkManager *networkManager;
+    FetchService *fetchService;
+    QQueue<Job> pendingJobs;
+    int pendingMetadata = 0;
+    int activeJobs = 0;
+    int succeededJobs = 0;
+    int failedJobs = 0;
+    int upToDateJobs = 0;
+    qint64 fetchedPoints = 0;
+    bool done = false;
+    QTextStream out;
+    QTextStream err;
+};
+
+#endif // BATCHRUNNER_H
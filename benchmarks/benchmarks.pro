@@ -0,0 +1,12 @@
+# Pomiary wydajności (QtTest, QBENCHMARK); nie są częścią aplikacji.
+
+QT += testlib
+
+CONFIG += testcase
+
+TARGET = benchmarks
+
+include(../sources.pri)
+
+SOURCES += \
+    tst_benchmarks.cpp
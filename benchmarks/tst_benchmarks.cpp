@@ -0,0 +1,585 @@
+/**
+ * @file tst_benchmarks.cpp
+ * @brief Pomiary wydajności przetwarzania danych (QtTest, QBENCHMARK).
+ *
+ * Program jest osobnym celem projektu (podkatalog benchmarks), niezależnym od aplikacji.
+ * Wyniki wypisuje mechanizm QtTest, więc format i powtórzenia ustawiane są jego
+ * argumentami, np. "-o wyniki.csv,csv", "-minimumvalue 1000", "-iterations 10",
+ * a wybrany pomiar - nazwą funkcji i wiersza, np. "statistics:100000".
+ *
+ * Zmienne środowiskowe:
+ * - JP_BENCHMARK_SIZES - rozmiary serii rozdzielone przecinkami (domyślnie 1000,100000,10000000),
+ * - JP_BENCHMARK_RESPONSES - katalog z zapisanymi odpowiedziami API dla parseCanned.
+ *
+ * Pomiary okien wykresu wymagają platformy graficznej; na serwerze bez ekranu można
+ * użyć QT_QPA_PLATFORM=offscreen.
+ */
+#include "chartwindow.h"
+#include "dataworker.h"
+#include "decimation.h"
+#include "giosstreamparser.h"
+#include "jsonstorage.h"
+#include "minmaxpyramid.h"
+#include "seriesjoin.h"
+#include "seriesstatistics.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QtCharts>
+#include <QtMath>
+#include <QtTest>
+#include <cmath>
+#include <random>
+
+namespace {
+
+/** @brief Identyfikatory stacji i sensora używane w tymczasowej bazie. */
+const int BenchmarkStationId = 1;
+const int BenchmarkSensorId = 1;
+
+/** @brief Rozmiar fragmentu odpowiedzi przekazywanego parserowi (jak przy readyRead). */
+const int ChunkSize = 16 * 1024;
+
+/** @brief Liczba różnych stron syntetycznej odpowiedzi używanych cyklicznie. */
+const int SyntheticPageCount = 32;
+
+/** @brief Liczba przedziałów czasu wykresu (odpowiada szerokości obszaru wykresu w pikselach). */
+const int ChartBuckets = 1000;
+
+/**
+ * @brief Odczytuje rozmiary serii ze zmiennej JP_BENCHMARK_SIZES.
+ */
+QVector<int> benchmarkSizes()
+{
+    QVector<int> sizes;
+    const QStringList parts = qEnvironmentVariable("JP_BENCHMARK_SIZES").split(',', Qt::SkipEmptyParts);
+    for (const QString &part : parts) {
+        bool ok = false;
+        const int size = part.trimmed().toInt(&ok);
+        if (ok && size > 0)
+            sizes.append(size);
+    }
+    if (sizes.isEmpty())
+        sizes = { 1000, 100000, 10000000 };
+    return sizes;
+}
+
+/**
+ * @brief Usuwa pliki pomiarów tymczasowej bazy.
+ */
+void removeStoredMeasurements()
+{
+    QDir dir(getJsonDir());
+    const QStringList files = dir.entryList({ QString("%1-%2*").arg(BenchmarkStationId).arg(BenchmarkSensorId) }, QDir::Files);
+    for (const QString &file : files)
+        dir.remove(file);
+}
+
+/**
+ * @brief Tworzy syntetyczną serię godzinowych pomiarów.
+ *
+ * Wartości mają dobowy cykl z szumem. Ziarno generatora jest stałe, więc seria
+ * jest powtarzalna.
+ */
+MeasurementSeries syntheticSeries(int size)
+{
+    MeasurementSeries series;
+    series.reserve(size);
+    std::mt19937 random(12345);
+    std::normal_distribution<double> noise(0.0, 4.0);
+    const qint64 start = QDateTime(QDate(2000, 1, 1), QTime(0, 0)).toMSecsSinceEpoch();
+    for (int i = 0; i < size; ++i)
+        series.append(start + qint64(i) * 3600000, 25.0 + 10.0 * std::sin(i * (2.0 * M_PI / 24.0)) + noise(random));
+    return series;
+}
+
+/**
+ * @brief Tworzy odpowiedzi API archivalData/getDataBySensor dla kolejnych stron serii.
+ *
+ * Każda strona obejmuje DataWorker::DefaultPageHours pomiarów, w kolejności malejącej
+ * jak w odpowiedziach API.
+ */
+QVector<QByteArray> syntheticPages(const MeasurementSeries &series, int pageCount)
+{
+    QVector<QByteArray> pages;
+    for (int begin = 0; begin < series.size() && pages.size() < pageCount; begin += DataWorker::DefaultPageHours) {
+        const int end = qMin(series.size(), begin + DataWorker::DefaultPageHours);
+        QByteArray page = "{\"Lista archiwalnych wyników pomiarów\":[";
+        for (int i = end - 1; i >= begin; --i) {
+            if (i != end - 1)
+                page += ',';
+            page += "{\"Kod stanowiska\":\"DsWrocWybCon-PM10-1g\",\"Data\":\"";
+            page += series.dateTime(i).toString("yyyy-MM-dd HH:mm:ss").toLatin1();
+            page += "\",\"Wartość\":";
+            page += QByteArray::number(series.value(i), 'f', 5);
+            page += '}';
+        }
+        page += QByteArray("],\"totalElements\":") + QByteArray::number(end - begin) + ",\"totalPages\":1}";
+        pages.append(page);
+    }
+    return pages;
+}
+
+/**
+ * @brief Parsuje strony odpowiedzi tak jak DataWorker::onReply.
+ *
+ * Strony przekazywane są parserowi we fragmentach po ChunkSize bajtów, a wynik każdej
+ * strony jest sortowany i dołączany do serii wynikowej.
+ *
+ * @param pages Treści odpowiedzi (używane cyklicznie).
+ * @param count Liczba pomiarów do odczytania lub -1, aby sparsować każdą stronę raz.
+ */
+MeasurementSeries parsePages(const QVector<QByteArray> &pages, int count)
+{
+    MeasurementSeries merged;
+    GiosStreamParser parser;
+    int parsed = 0;
+    for (int page = 0; count < 0 ? page < pages.size() : parsed < count; ++page) {
+        const QByteArray &body = pages[page % pages.size()];
+        for (int offset = 0; offset < body.size(); offset += ChunkSize)
+            parser.feed(QByteArray::fromRawData(body.constData() + offset, qMin(ChunkSize, int(body.size()) - offset)));
+        if (!parser.finish())
+            break;
+        MeasurementSeries series = parser.takeSeries();
+        series.sortByTime();
+        parser.reset();
+        if (series.isEmpty())
+            break;
+        parsed += series.size();
+        merged.append(series);
+    }
+    return merged;
+}
+
+/**
+ * @struct DataPoint
+ * @brief Pomiar w dawnej postaci (przed MeasurementSeries), używany przez parsePagesDom.
+ */
+struct DataPoint {
+    QDateTime timestamp;
+    double value;
+};
+
+/**
+ * @brief Parsuje strony odpowiedzi tak jak dawne DataWorker::onReply.
+ *
+ * Każda strona budowana jest w całości jako QJsonDocument, a daty odczytywane przez
+ * QDateTime::fromString. Punkt odniesienia dla parsePages.
+ *
+ * @param pages Treści odpowiedzi (używane cyklicznie).
+ * @param count Liczba pomiarów do odczytania lub -1, aby sparsować każdą stronę raz.
+ */
+QVector<DataPoint> parsePagesDom(const QVector<QByteArray> &pages, int count)
+{
+    QVector<DataPoint> points;
+    for (int page = 0; count < 0 ? page < pages.size() : points.size() < count; ++page) {
+        const QJsonDocument doc = QJsonDocument::fromJson(pages[page % pages.size()]);
+        const QJsonArray results = doc.object().value("Lista archiwalnych wyników pomiarów").toArray();
+        if (results.isEmpty())
+            break;
+        for (const QJsonValue &val : results) {
+            const QJsonObject obj = val.toObject();
+            const QString dateStr = obj["Data"].toString();
+            const double value = obj["Wartość"].toDouble();
+            const QDateTime timestamp = QDateTime::fromString(dateStr, "yyyy-MM-dd HH:mm:ss");
+            points.append({ timestamp, value });
+        }
+    }
+    return points;
+}
+
+}
+
+/**
+ * @class Benchmarks
+ * @brief Mierzy czas kluczowych etapów przetwarzania na syntetycznych seriach danych.
+ *
+ * Każdy pomiar wykonywany jest dla każdego rozmiaru serii: parsowanie odpowiedzi API
+ * (wraz z dawnym parsowaniem przez QJsonDocument jako punktem odniesienia),
+ * zapis i odczyt lokalnej bazy, filtrowanie po czasie, statystyki (wraz z dawną pętlą
+ * jako punktem odniesienia), wyrównanie serii, piramida obwiedni oraz budowa okna wykresu
+ * (ChartWindow) i serii QLineSeries. Baza tworzona jest w katalogu tymczasowym, więc
+ * pomiary nie zmieniają danych użytkownika.
+ */
+class Benchmarks : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void parse_data() { addSizes(); }
+    void parse();
+    void parseDom_data() { addSizes(); }
+    void parseDom();
+    void save_data() { addSizes(); }
+    void save();
+    void load_data() { addSizes(); }
+    void load();
+    void loadRange_data() { addSizes(); }
+    void loadRange();
+    void range_data() { addSizes(); }
+    void range();
+    void statistics_data() { addSizes(); }
+    void statistics();
+    void statisticsLoop_data() { addSizes(); }
+    void statisticsLoop();
+    void join_data() { addSizes(); }
+    void join();
+    void pyramid_data() { addSizes(); }
+    void pyramid();
+    void envelope_data() { addSizes(); }
+    void envelope();
+    void lineSeries_data() { addSizes(); }
+    void lineSeries();
+    void chartWindow_data() { addSizes(); }
+    void chartWindow();
+    void handoff_data() { addSizes(); }
+    void handoff();
+    void parseCanned_data();
+    void parseCanned();
+
+private:
+    void addSizes();
+    const MeasurementSeries &series(int size);
+
+    QTemporaryDir workDir;
+    QString previousDir;
+    QHash<int, MeasurementSeries> seriesCache;
+};
+
+/**
+ * @brief Ustawia katalog tymczasowy jako bieżący, aby baza "bazajson" powstała w nim.
+ */
+void Benchmarks::initTestCase()
+{
+    QVERIFY(workDir.isValid());
+    previousDir = QDir::currentPath();
+    QDir::setCurrent(workDir.path());
+}
+
+/**
+ * @brief Przywraca poprzedni katalog bieżący.
+ */
+void Benchmarks::cleanupTestCase()
+{
+    QDir::setCurrent(previousDir);
+}
+
+/**
+ * @brief Dodaje wiersz danych dla każdego rozmiaru serii.
+ */
+void Benchmarks::addSizes()
+{
+    QTest::addColumn<int>("size");
+    const QVector<int> sizes = benchmarkSizes();
+    for (int size : sizes)
+        QTest::addRow("%d", size) << size;
+}
+
+/**
+ * @brief Zwraca syntetyczną serię o podanym rozmiarze, tworząc ją przy pierwszym użyciu.
+ */
+const MeasurementSeries &Benchmarks::series(int size)
+{
+    auto it = seriesCache.find(size);
+    if (it == seriesCache.end())
+        it = seriesCache.insert(size, syntheticSeries(size));
+    return it.value();
+}
+
+/**
+ * @brief Parsowanie syntetycznych odpowiedzi API (jak w DataWorker::onReply).
+ */
+void Benchmarks::parse()
+{
+    QFETCH(int, size);
+    const QVector<QByteArray> pages = syntheticPages(series(size), SyntheticPageCount);
+    QBENCHMARK {
+        parsePages(pages, size);
+    }
+}
+
+/**
+ * @brief Punkt odniesienia dla parse: dawne parsowanie przez QJsonDocument i QDateTime::fromString.
+ */
+void Benchmarks::parseDom()
+{
+    QFETCH(int, size);
+    const QVector<QByteArray> pages = syntheticPages(series(size), SyntheticPageCount);
+    QBENCHMARK {
+        parsePagesDom(pages, size);
+    }
+}
+
+/**
+ * @brief Zapis serii do pustej lokalnej bazy.
+ *
+ * Każdy zapis wymaga pustej bazy, a QBENCHMARK nie pozwala wyłączyć przygotowania
+ * z pomiaru, więc zapis mierzony jest jednokrotnie.
+ */
+void Benchmarks::save()
+{
+    QFETCH(int, size);
+    const MeasurementSeries &data = series(size);
+    removeStoredMeasurements();
+    QBENCHMARK_ONCE {
+        saveMeasurements(BenchmarkStationId, BenchmarkSensorId, data);
+    }
+    removeStoredMeasurements();
+}
+
+/**
+ * @brief Odczyt całej serii z lokalnej bazy.
+ */
+void Benchmarks::load()
+{
+    QFETCH(int, size);
+    removeStoredMeasurements();
+    saveMeasurements(BenchmarkStationId, BenchmarkSensorId, series(size));
+    QBENCHMARK {
+        loadMeasurements(BenchmarkStationId, BenchmarkSensorId);
+    }
+    removeStoredMeasurements();
+}
+
+/**
+ * @brief Odczyt z lokalnej bazy 10% serii ze środka zakresu.
+ */
+void Benchmarks::loadRange()
+{
+    QFETCH(int, size);
+    const MeasurementSeries &data = series(size);
+    const qint64 first = data.timestamp(0);
+    const qint64 last = data.timestamp(size - 1);
+    const QDateTime from = QDateTime::fromMSecsSinceEpoch(first + (last - first) * 45 / 100);
+    const QDateTime to = QDateTime::fromMSecsSinceEpoch(first + (last - first) * 55 / 100);
+    removeStoredMeasurements();
+    saveMeasurements(BenchmarkStationId, BenchmarkSensorId, data);
+    QBENCHMARK {
+        loadMeasurementsRange(BenchmarkStationId, BenchmarkSensorId, from, to);
+    }
+    removeStoredMeasurements();
+}
+
+/**
+ * @brief Wybór 10% serii ze środka zakresu w pamięci.
+ */
+void Benchmarks::range()
+{
+    QFETCH(int, size);
+    const MeasurementSeries &data = series(size);
+    const qint64 first = data.timestamp(0);
+    const qint64 last = data.timestamp(size - 1);
+    const qint64 from = first + (last - first) * 45 / 100;
+    const qint64 to = first + (last - first) * 55 / 100;
+    QBENCHMARK {
+        data.range(from, to);
+    }
+}
+
+/**
+ * @brief Statystyki opisowe serii wraz z percentylami.
+ */
+void Benchmarks::statistics()
+{
+    QFETCH(int, size);
+    const MeasurementSeries &data = series(size);
+    QBENCHMARK {
+        SeriesStatistics::compute(data);
+    }
+}
+
+/**
+ * @brief Punkt odniesienia dla statistics: dawna pętla z MainWindow::onGenerateClicked.
+ *
+ * Jedna skalarna pętla wyznacza minimum, maksimum i sumę, budując po drodze wektory
+ * QPointF i QDateTime dla wykresu; trend to porównanie pierwszej i ostatniej wartości.
+ */
+void Benchmarks::statisticsLoop()
+{
+    QFETCH(int, size);
+    const MeasurementSeries &data = series(size);
+    QBENCHMARK {
+        QVector<QPointF> points;
+        QVector<QDateTime> timestamps;
+        double sum = 0, min = data.value(0), max = data.value(0);
+        QDateTime minTime = data.dateTime(0), maxTime = data.dateTime(0);
+        for (int i = 0; i < data.size(); ++i) {
+            const double val = data.value(i);
+            points.append(QPointF(i, val));
+            timestamps.append(data.dateTime(i));
+            sum += val;
+            if (val < min) {
+                min = val;
+                minTime = data.dateTime(i);
+            }
+            if (val > max) {
+                max = val;
+                maxTime = data.dateTime(i);
+            }
+        }
+        const double avg = sum / data.size();
+        const int trend = points.last().y() > points.first().y() ? 1 : points.last().y() < points.first().y() ? -1 : 0;
+        Q_UNUSED(avg);
+        Q_UNUSED(trend);
+    }
+}
+
+/**
+ * @brief Wyrównanie serii z serią o co drugim pomiarze.
+ */
+void Benchmarks::join()
+{
+    QFETCH(int, size);
+    const MeasurementSeries &data = series(size);
+    MeasurementSeries sparse;
+    sparse.reserve(size / 2 + 1);
+    for (int i = 0; i < size; i += 2)
+        sparse.append(data.timestamp(i), data.value(i) * 0.5);
+    const QVector<MeasurementSeries> joined { data, sparse };
+    QBENCHMARK {
+        alignSeries(joined);
+    }
+}
+
+/**
+ * @brief Budowa piramidy obwiedni.
+ */
+void Benchmarks::pyramid()
+{
+    QFETCH(int, size);
+    const MeasurementSeries &data = series(size);
+    QBENCHMARK {
+        MinMaxPyramid pyramid(data);
+    }
+}
+
+/**
+ * @brief Obwiednia całej serii na szerokość wykresu.
+ */
+void Benchmarks::envelope()
+{
+    QFETCH(int, size);
+    const MeasurementSeries &data = series(size);
+    const MinMaxPyramid pyramid(data);
+    QBENCHMARK {
+        pyramid.envelope(data.timestamp(0), data.timestamp(size - 1), ChartBuckets);
+    }
+}
+
+/**
+ * @brief Wypełnienie serii QLineSeries wykresu tak jak w ChartWindow::updateSeries.
+ *
+ * Mierzona jest redukcja całej serii do minimum i maksimum na piksel oraz przekazanie
+ * punktów do QLineSeries dołączonej do wykresu z osiami.
+ */
+void Benchmarks::lineSeries()
+{
+    QFETCH(int, size);
+    const MeasurementSeries &data = series(size);
+    QChart chart;
+    QLineSeries *line = new QLineSeries;
+    chart.addSeries(line);
+    chart.createDefaultAxes();
+    QBENCHMARK {
+        line->replace(decimateMinMax(data, 0, data.size(), ChartBuckets));
+    }
+}
+
+/**
+ * @brief Utworzenie okna wykresu z serią i statystykami (bez wyświetlenia).
+ *
+ * Obejmuje budowę QChart, osi i QLineSeries oraz ich wypełnienie; dla serii dłuższych
+ * niż ChartWindow::FastViewPoints okno otwiera się w widoku PlotWidget.
+ */
+void Benchmarks::chartWindow()
+{
+    QFETCH(int, size);
+    const MeasurementSeries &data = series(size);
+    const SeriesStatistics stats = SeriesStatistics::compute(data);
+    QBENCHMARK {
+        ChartWindow window(data, stats, "PM10", "Benchmark");
+    }
+}
+
+/**
+ * @brief Droga pobranej serii do odbiorców.
+ *
+ * Kolejka zapisu, porządkowanie przed zapisem (saveMeasurements i MeasurementStore::append)
+ * oraz pełny zakres w oknie wykresu.
+ */
+void Benchmarks::handoff()
+{
+    QFETCH(int, size);
+    const MeasurementSeries &data = series(size);
+    const qint64 first = data.timestamp(0);
+    const qint64 last = data.timestamp(size - 1);
+    QBENCHMARK {
+        MeasurementSeries pending;
+        pending.append(data);
+        MeasurementSeries fresh = pending;
+        fresh.sortUnique();
+        MeasurementSeries sorted = fresh;
+        sorted.sortUnique();
+        const QVector<MeasurementSeries> chart { data.range(first, last) };
+        Q_UNUSED(chart);
+    }
+}
+
+/**
+ * @brief Dodaje wiersze parsera strumieniowego i dawnego parsowania przez QJsonDocument.
+ */
+void Benchmarks::parseCanned_data()
+{
+    QTest::addColumn<bool>("dom");
+    QTest::newRow("stream") << false;
+    QTest::newRow("dom") << true;
+}
+
+/**
+ * @brief Parsowanie zapisanych odpowiedzi API z katalogu JP_BENCHMARK_RESPONSES.
+ *
+ * Jeśli katalog zawiera nagrania NetworkTransport, używane są tylko pliki treści (.body).
+ * Wiersz "dom" mierzy dawne parsowanie (parsePagesDom) tych samych odpowiedzi.
+ */
+void Benchmarks::parseCanned()
+{
+    QFETCH(bool, dom);
+    const QString responsesDir = qEnvironmentVariable("JP_BENCHMARK_RESPONSES");
+    if (responsesDir.isEmpty())
+        QSKIP("Nie ustawiono JP_BENCHMARK_RESPONSES.");
+
+    QVector<QByteArray> pages;
+    QDir dir(QDir(previousDir).absoluteFilePath(responsesDir));
+    QStringList files = dir.entryList({ "*.body" }, QDir::Files, QDir::Name);
+    if (files.isEmpty())
+        files = dir.entryList(QDir::Files, QDir::Name);
+    for (const QString &name : std::as_const(files)) {
+        QFile file(dir.filePath(name));
+        if (file.open(QIODevice::ReadOnly))
+            pages.append(file.readAll());
+    }
+    if (pages.isEmpty())
+        QSKIP("Brak odpowiedzi w katalogu JP_BENCHMARK_RESPONSES.");
+
+    if (dom) {
+        QBENCHMARK {
+            parsePagesDom(pages, -1);
+        }
+    } else {
+        QBENCHMARK {
+            parsePages(pages, -1);
+        }
+    }
+}
+
+QTEST_MAIN(Benchmarks)
+
+#include "tst_benchmarks.moc"
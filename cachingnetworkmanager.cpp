@@ -0,0 +1,62 @@
+/**
+ * @file cachingnetworkmanager.cpp
+ * @brief Implementacja menedżera sieci korzystającego z HttpCache.
+ */
+#include "cachingnetworkmanager.h"
+#include <QNetworkReply>
+/**
+ * @brief Konstruktor klasy CachingNetworkManager.
+ *
+ * Ustawia czasy ważności dla endpointów metadanych GIOŚ: listy stacji i sensorów
+ * zmieniają się rzadko (24 h), a indeks jakości powietrza co godzinę (10 min).
+ *
+ * @param cacheDirectory Katalog pamięci podręcznej.
+ * @param parent Obiekt nadrzędny.
+ */
+CachingNetworkManager::CachingNetworkManager(const QString &cacheDirectory, QObject *parent)
+    : NetworkTransport(parent), responseCache(new HttpCache(cacheDirectory))
+{
+    setCache(responseCache);
+    responseCache->setTimeToLive("/pjp-api/rest/station/findAll", 24 * 3600);
+    responseCache->setTimeToLive("/pjp-api/rest/station/sensors/", 24 * 3600);
+    responseCache->setTimeToLive("/pjp-api/rest/aqindex/getIndex/", 10 * 60);
+}
+
+/**
+ * @brief Tworzy odpowiedź na zapytanie.
+ *
+ * Dla aktualnego wpisu zapytanie otrzymuje tryb PreferCache, więc Qt zwraca zapisaną
+ * odpowiedź bez połączenia z serwerem. W przeciwnym razie używany jest tryb PreferNetwork,
+ * w którym Qt sam dołącza nagłówki If-None-Match / If-Modified-Since zapisanego wpisu
+ * i obsługuje odpowiedź 304. Po zakończeniu odpowiedź jest zliczana jako trafienie,
+ * potwierdzenie warunkowe lub chybienie.
+ *
+ * @param op Rodzaj operacji HTTP.
+ * @param request Zapytanie.
+ * @param outgoingData Dane wysyłane w treści zapytania.
+ * @return Odpowiedź na zapytanie.
+ */
+QNetworkReply *CachingNetworkManager::createRequest(Operation op, const QNetworkRequest &request,
+                                                    QIODevice *outgoingData)
+{
+    if (op != GetOperation || responseCache->timeToLive(request.url()) < 0)
+        return NetworkTransport::createRequest(op, request, outgoingData);
+
+    const bool fresh = responseCache->isFresh(request.url());
+    QNetworkRequest cachedRequest(request);
+    cachedRequest.setAttribute(QNetworkRequest::CacheLoadControlAttribute,
+                               fresh ? QNetworkRequest::PreferCache : QNetworkRequest::PreferNetwork);
+    if (fresh)
+        responseCache->touch(request.url());
+
+    QNetworkReply *reply = NetworkTransport::createRequest(op, cachedRequest, outgoingData);
+    connect(reply, &QNetworkReply::finished, this, [this, reply, fresh]() {
+        if (!reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool())
+            responseCache->recordMiss();
+        else if (fresh)
+            responseCache->recordHit();
+        else
+            responseCache->recordRevalidation();
+    });
+    return reply;
+}
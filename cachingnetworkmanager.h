@@ -0,0 +1,51 @@
+/**
+ * @file cachingnetworkmanager.h
+ * @brief Definicja klasy CachingNetworkManager - menedżera sieci korzystającego z HttpCache.
+ */
+
+#ifndef CACHINGNETWORKMANAGER_H
+#define CACHINGNETWORKMANAGER_H
+
+#include "networktransport.h"
+#include "httpcache.h"
+
+/**
+ * @class CachingNetworkManager
+ * @brief Menedżer sieci obsługujący zapytania GET z pamięci podręcznej HttpCache.
+ *
+ * Zapytanie o endpoint z ustawionym czasem ważności, dla którego istnieje aktualny wpis,
+ * jest obsługiwane bez kontaktu z serwerem. Nieaktualny wpis jest weryfikowany zapytaniem
+ * warunkowym. Pozostałe zapytania wykonywane są bez zmian. W trybie odtwarzania
+ * (NetworkTransport::Replay) odpowiedzi pochodzą z nagrań, z pominięciem pamięci podręcznej.
+ */
+class CachingNetworkManager : public NetworkTransport
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Konstruktor klasy CachingNetworkManager.
+     * @param cacheDirectory Katalog pamięci podręcznej.
+     * @param parent Obiekt nadrzędny.
+     */
+    explicit CachingNetworkManager(const QString &cacheDirectory, QObject *parent = nullptr);
+
+    /** @brief Zwraca pamięć podręczną menedżera. */
+    HttpCache *httpCache() const { return responseCache; }
+
+protected:
+    /**
+     * @brief Tworzy odpowiedź na zapytanie, wybierając źródło danych (pamięć podręczna lub sieć).
+     * @param op Rodzaj operacji HTTP.
+     * @param request Zapytanie.
+     * @param outgoingData Dane wysyłane w treści zapytania.
+     * @return Odpowiedź na zapytanie.
+     */
+    QNetworkReply *createRequest(Operation op, const QNetworkRequest &request,
+                                 QIODevice *outgoingData = nullptr) override;
+
+private:
+    HttpCache *responseCache;
+};
+
+#endif // CACHINGNETWORKMANAGER_H
@@ -0,0 +1,29 @@
+/**
+ * @file cancellationtoken.cpp
+ * @brief Implementacja znacznika anulowania zadania.
+ */
+#include "cancellationtoken.h"
+/**
+ * @brief Tworzy nowy, nieanulowany znacznik.
+ */
+CancellationToken::CancellationToken()
+    : state(new QAtomicInt(0))
+{
+}
+
+/**
+ * @brief Oznacza zadanie jako anulowane.
+ */
+void CancellationToken::cancel()
+{
+    state->storeRelease(1);
+}
+
+/**
+ * @brief Sprawdza, czy zadanie zostało anulowane.
+ * @return true, jeśli wywołano cancel() na dowolnej kopii znacznika.
+ */
+bool CancellationToken::isCancelled() const
+{
+    return state->loadAcquire() != 0;
+}
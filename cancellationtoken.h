@@ -0,0 +1,36 @@
+/**
+ * @file cancellationtoken.h
+ * @brief Definicja klasy CancellationToken - znacznika anulowania zadania.
+ */
+
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#include <QSharedPointer>
+#include <QAtomicInt>
+
+/**
+ * @class CancellationToken
+ * @brief Współdzielony znacznik anulowania zadania wykonywanego w innym wątku.
+ *
+ * Kopie obiektu wskazują ten sam znacznik. Wątek zlecający zadanie może go ustawić
+ * w dowolnej chwili, a zadanie sprawdza go między kolejnymi etapami pracy (zapytanie,
+ * fragment odpowiedzi, parsowanie), bez oczekiwania na obsługę zdarzeń w swoim wątku.
+ */
+class CancellationToken
+{
+public:
+    /** @brief Tworzy nowy, nieanulowany znacznik. */
+    CancellationToken();
+
+    /** @brief Oznacza zadanie jako anulowane. */
+    void cancel();
+
+    /** @brief Sprawdza, czy zadanie zostało anulowane. */
+    bool isCancelled() const;
+
+private:
+    QSharedPointer<QAtomicInt> state;
+};
+
+#endif // CANCELLATIONTOKEN_H
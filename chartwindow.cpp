@@ -3,64 +3,389 @@
  * @brief Implementacja klasy ChartWindow do wizualizacji danych pomiarowych na wykresie.
  */
 #include "chartwindow.h"
+#include "decimation.h"
+#include "tracing.h"
 /**
  * @brief Konstruktor klasy ChartWindow.
  *
  * Tworzy wykres danych pomiarowych i wyświetla statystyki w osobnym oknie.
+ * Zakresy osi ustawiane są na podstawie pełnej serii, a zaznaczenie fragmentu wykresu
+ * myszą przybliża oś czasu.
  *
- * @param dataPoints Punkty do wykreślenia na wykresie.
- * @param timestamps Znaczniki czasu dla każdego punktu.
- * @param minVal Minimalna wartość pomiaru.
- * @param minTime Czas minimalnej wartości.
- * @param maxVal Maksymalna wartość pomiaru.
- * @param maxTime Czas maksymalnej wartości.
- * @param avg Średnia wartość pomiarów.
- * @param trend Określenie trendu zmian.
+ * @param series Seria pomiarów do wykreślenia na wykresie.
+ * @param stats Statystyki serii.
  * @param paramName Nazwa parametru.
  * @param selectedStationName Nazwa stacji pomiarowej.
+ * @param resolution Opis rozdzielczości danych; pusty dla pomiarów godzinowych.
  * @param parent Rodzic okna.
  */
-ChartWindow::ChartWindow(const QVector<QPointF> &dataPoints, const QVector<QDateTime> &timestamps,
-                         double minVal, QDateTime minTime, double maxVal, QDateTime maxTime,
-                         double avg, QString trend, QString paramName, QString selectedStationName,QWidget *parent)
-    : QDialog(parent)
+ChartWindow::ChartWindow(const MeasurementSeries &series, const SeriesStatistics &stats,
+                         QString paramName, QString selectedStationName, QString resolution, QWidget *parent)
+    : QDialog(parent), fullSeries({ series })
 {
-    QLineSeries *series = new QLineSeries();
-    for (int i = 0; i < dataPoints.size(); ++i) {
-        qint64 timestamp = timestamps[i].toMSecsSinceEpoch();
-        series->append(timestamp, dataPoints[i].y());
+    TRACE_SPAN("chartWindow");
+    QString title = QString("Wykres danych pomiarowych %1 dla stacji %2").arg(paramName).arg(selectedStationName);
+    if (!resolution.isEmpty())
+        title += QString(" (%1)").arg(resolution);
+    createChart(title, paramName, QStringList(), stats.min, stats.max);
+
+    statsLabel = new QLabel;
+    showStatistics(stats, stats.isValid() ? series.dateTime(stats.minIndex) : QDateTime(),
+                   stats.isValid() ? series.dateTime(stats.maxIndex) : QDateTime());
+    createLayout();
+}
+
+/**
+ * @brief Konstruktor okna porównującego kilka serii.
+ *
+ * Każda seria ma własną linię i pozycję w legendzie. Pod wykresem wyświetlane są
+ * podstawowe statystyki serii, liczba wspólnych znaczników czasu oraz korelacja
+ * każdej serii z pierwszą, liczona na wierszach wyrównanej tabeli.
+ *
+ * @param comparison Serie, ich statystyki i wyrównanie na wspólnej osi czasu.
+ * @param parent Rodzic okna.
+ */
+ChartWindow::ChartWindow(const ComparisonResult &comparison, QWidget *parent)
+    : QDialog(parent), fullSeries(comparison.series)
+{
+    TRACE_SPAN("chartWindow");
+    QString title = "Porównanie danych pomiarowych";
+    if (!comparison.resolution.isEmpty())
+        title += QString(" (%1)").arg(comparison.resolution);
+
+    QStringList paramNames = comparison.paramNames;
+    paramNames.removeDuplicates();
+    double minValue = 0, maxValue = 0;
+    bool hasRange = false;
+    for (int i = 0; i < comparison.stats.size(); ++i) {
+        const SeriesStatistics &stats = comparison.stats[i];
+        if (!stats.isValid())
+            continue;
+        minValue = hasRange ? qMin(minValue, stats.min) : stats.min;
+        maxValue = hasRange ? qMax(maxValue, stats.max) : stats.max;
+        hasRange = true;
     }
+    createChart(title, paramNames.size() == 1 ? paramNames.first() : QString("Wartość"), comparison.labels,
+                minValue, maxValue);
 
-    QChart *chart = new QChart();
-    chart->addSeries(series);
-    chart->setTitle(QString("Wykres danych pomiarowych %1 dla stacji %2").arg(paramName).arg(selectedStationName));
-    chart->legend()->hide();
+    QStringList lines;
+    for (int i = 0; i < comparison.stats.size(); ++i) {
+        const SeriesStatistics &stats = comparison.stats[i];
+        if (!stats.isValid()) {
+            lines.append(QString("%1: brak pomiarów").arg(comparison.labels[i]));
+            continue;
+        }
+        lines.append(QString("%1: min %2, max %3, średnia %4 (%5 pomiarów)")
+                         .arg(comparison.labels[i]).arg(stats.min).arg(stats.max).arg(stats.mean).arg(stats.count));
+    }
+    lines.append(QString("Wspólne znaczniki czasu: %1 z %2")
+                     .arg(comparison.aligned.completeRows()).arg(comparison.aligned.size()));
+    for (int i = 1; i < comparison.labels.size(); ++i) {
+        int pairs = 0;
+        const double r = correlation(comparison.aligned, 0, i, &pairs);
+        lines.append(QString("Korelacja %1 z %2: %3 (%4 par)")
+                         .arg(comparison.labels[i], comparison.labels[0])
+                         .arg(qIsNaN(r) ? QString("-") : QString::number(r, 'f', 2)).arg(pairs));
+    }
+    if (!comparison.failed.isEmpty())
+        lines.append("Nie udało się pobrać (dane lokalne): " + comparison.failed.join(", "));
+    statsLabel = new QLabel(lines.join('\n'));
 
-    QDateTimeAxis *axisX = new QDateTimeAxis;
+    createLayout();
+}
+
+/**
+ * @brief Tworzy wykres z jedną linią dla każdej serii oraz osie.
+ *
+ * Zakres osi czasu obejmuje wszystkie serie. Zmiana zakresu osi czasu (przybliżenie)
+ * i rozmiaru obszaru wykresu powoduje ponowne przeliczenie punktów.
+ *
+ * @param title Tytuł wykresu.
+ * @param axisTitle Opis osi wartości.
+ * @param names Nazwy serii w legendzie; pusta lista ukrywa legendę.
+ * @param minValue Początek osi wartości.
+ * @param maxValue Koniec osi wartości.
+ */
+void ChartWindow::createChart(const QString &title, const QString &axisTitle, const QStringList &names,
+                              double minValue, double maxValue)
+{
+    chart = new QChart();
+    chart->setTitle(title);
+    for (int i = 0; i < fullSeries.size(); ++i) {
+        QLineSeries *line = new QLineSeries();
+        if (i < names.size())
+            line->setName(names[i]);
+        chart->addSeries(line);
+        lineSeries.append(line);
+    }
+    if (names.isEmpty())
+        chart->legend()->hide();
+    shownFirst.fill(-1, fullSeries.size());
+    shownLast.fill(-1, fullSeries.size());
+
+    axisX = new QDateTimeAxis;
     axisX->setFormat("yyyy-MM-dd HH:00");
     axisX->setTitleText("Data pomiaru");
     axisX->setTickCount(4);
     chart->addAxis(axisX, Qt::AlignBottom);
-    series->attachAxis(axisX);
 
-    QValueAxis *axisY = new QValueAxis;
-    axisY->setTitleText(QString("%1").arg(paramName));
+    axisY = new QValueAxis;
+    axisY->setTitleText(axisTitle);
     chart->addAxis(axisY, Qt::AlignLeft);
-    series->attachAxis(axisY);
+    for (QLineSeries *line : std::as_const(lineSeries)) {
+        line->attachAxis(axisX);
+        line->attachAxis(axisY);
+    }
+
+    qint64 start = 0, end = 0;
+    bool hasRange = false;
+    for (const MeasurementSeries &series : std::as_const(fullSeries)) {
+        if (series.isEmpty())
+            continue;
+        start = hasRange ? qMin(start, series.timestamp(0)) : series.timestamp(0);
+        end = hasRange ? qMax(end, series.timestamp(series.size() - 1)) : series.timestamp(series.size() - 1);
+        hasRange = true;
+    }
+    if (hasRange) {
+        axisX->setRange(QDateTime::fromMSecsSinceEpoch(start), QDateTime::fromMSecsSinceEpoch(end));
+        axisY->setRange(minValue, maxValue);
+    }
+    connect(axisX, &QDateTimeAxis::rangeChanged, this, &ChartWindow::updateSeries);
+    connect(chart, &QChart::plotAreaChanged, this, &ChartWindow::updateSeries);
 
     chartView = new QChartView(chart);
     chartView->setRenderHint(QPainter::Antialiasing);
+    chartView->setRubberBand(QChartView::HorizontalRubberBand);
+
+    plotWidget = new PlotWidget;
+    plotWidget->setTitles(title, axisTitle);
+    plotWidget->setSeries(fullSeries, names);
+    if (hasRange) {
+        plotWidget->setTimeRange(start, end);
+        plotWidget->setValueRange(minValue, maxValue);
+    }
+}
+
+/**
+ * @brief Umieszcza wykres, widok PlotWidget i statystyki w oknie oraz wykreśla serie.
+ *
+ * Dla serii dłuższych łącznie niż FastViewPoints okno otwiera się w widoku PlotWidget,
+ * a wykres QtCharts nie jest wtedy w ogóle wypełniany.
+ */
+void ChartWindow::createLayout()
+{
+    qint64 points = 0;
+    for (const MeasurementSeries &series : std::as_const(fullSeries))
+        points += series.size();
+
+    views = new QStackedWidget;
+    views->addWidget(chartView);
+    views->addWidget(plotWidget);
+    viewButton = new QPushButton("Szybki widok");
+    viewButton->setCheckable(true);
+    viewButton->setToolTip("Rysowanie bez QtCharts; kółko myszy przybliża, przeciąganie przesuwa, "
+                           "podwójne kliknięcie przywraca pełny zakres.");
+    connect(viewButton, &QPushButton::toggled, this, &ChartWindow::setFastView);
 
-    statsLabel = new QLabel(
-        QString("Min: %1 (%2)\nMax: %3 (%4)\nŚrednia: %5\nTrend: %6")
-            .arg(minVal).arg(minTime.toString("yyyy-MM-dd HH:mm"))
-            .arg(maxVal).arg(maxTime.toString("yyyy-MM-dd HH:mm"))
-            .arg(avg).arg(trend)
-        );
+    QHBoxLayout *bottom = new QHBoxLayout;
+    bottom->addWidget(statsLabel, 1);
+    bottom->addWidget(viewButton, 0, Qt::AlignTop);
 
     QVBoxLayout *layout = new QVBoxLayout;
-    layout->addWidget(chartView);
-    layout->addWidget(statsLabel);
+    layout->addWidget(views, 1);
+    layout->addLayout(bottom);
     setLayout(layout);
     resize(700, 450);
+    viewButton->setChecked(points > FastViewPoints);
+    updateSeries();
+}
+
+/**
+ * @brief Przełącza między wykresem QtCharts a widokiem PlotWidget, zachowując zakres osi czasu.
+ *
+ * Zakres przenoszony jest tylko przy przełączeniu, więc przesuwanie w widoku PlotWidget
+ * nie wymaga przeliczania punktów QtCharts.
+ *
+ * @param fast true - widok PlotWidget.
+ */
+void ChartWindow::setFastView(bool fast)
+{
+    if (fast) {
+        if (axisX->max() > axisX->min())
+            plotWidget->setTimeRange(axisX->min().toMSecsSinceEpoch(), axisX->max().toMSecsSinceEpoch());
+        views->setCurrentWidget(plotWidget);
+        return;
+    }
+    views->setCurrentWidget(chartView);
+    axisX->setRange(QDateTime::fromMSecsSinceEpoch(plotWidget->timeFrom()),
+                    QDateTime::fromMSecsSinceEpoch(plotWidget->timeTo()));
+    updateSeries();
+}
+
+/**
+ * @brief Sprawdza, czy wyświetlany jest widok PlotWidget.
+ */
+bool ChartWindow::isFastView() const
+{
+    return views && views->currentWidget() == plotWidget;
+}
+
+/**
+ * @brief Przelicza punkty wykresu dla widocznego zakresu osi czasu i szerokości wykresu.
+ *
+ * Widoczny fragment wyznaczany jest wyszukiwaniem binarnym w pełnej serii (wraz z jednym
+ * punktem poza każdą krawędzią, aby linia dochodziła do brzegów), a następnie redukowany
+ * do minimum i maksimum na piksel. Punkty przekazywane są jednym wywołaniem replace().
+ * Seria, której fragment i szerokość się nie zmieniły, nie jest przeliczana. W widoku
+ * PlotWidget punkty nie są przeliczane wcale.
+ */
+void ChartWindow::updateSeries()
+{
+    if (isFastView())
+        return;
+    TRACE_SPAN("decimation");
+    const int buckets = qMax(1, int(chart->plotArea().width() > 0 ? chart->plotArea().width() : width()));
+    const qint64 from = axisX->min().toMSecsSinceEpoch();
+    const qint64 to = axisX->max().toMSecsSinceEpoch();
+
+    for (int i = 0; i < fullSeries.size(); ++i) {
+        const MeasurementSeries &series = fullSeries[i];
+        if (series.isEmpty())
+            continue;
+
+        const int first = qMax(0, series.lowerBound(from) - 1);
+        const int last = qMin(series.size(), series.lowerBound(to + 1) + 1);
+        if (first == shownFirst[i] && last == shownLast[i] && buckets == shownBuckets)
+            continue;
+
+        shownFirst[i] = first;
+        shownLast[i] = last;
+        lineSeries[i]->replace(decimateMinMax(series, first, last, buckets));
+    }
+    shownBuckets = buckets;
+}
+
+/**
+ * @brief Wyświetla statystyki jednej serii wraz z bieżącym stanem pobierania.
+ * @param stats Statystyki serii.
+ * @param minTime Czas pomiaru o najmniejszej wartości.
+ * @param maxTime Czas pomiaru o największej wartości.
+ */
+void ChartWindow::showStatistics(const SeriesStatistics &stats, const QDateTime &minTime, const QDateTime &maxTime)
+{
+    auto percentileText = [](double value) { return qIsNaN(value) ? QString("-") : QString::number(value); };
+    const double slopePerDay = stats.slopePerHour * 24;
+    const QString trend = (slopePerDay > 0) ? "rośnie" : (slopePerDay < 0) ? "maleje" : "brak";
+    QString text =
+        QString("Min: %1 (%2)\nMax: %3 (%4)\nŚrednia: %5\nOdchylenie standardowe: %6\n"
+                "Mediana: %7, P95: %8, P98: %9\nTrend: %10 (%11 na dobę)")
+            .arg(stats.min).arg(minTime.toString("yyyy-MM-dd HH:mm"))
+            .arg(stats.max).arg(maxTime.toString("yyyy-MM-dd HH:mm"))
+            .arg(stats.mean).arg(stats.standardDeviation)
+            .arg(percentileText(stats.p50)).arg(percentileText(stats.p95)).arg(percentileText(stats.p98))
+            .arg(trend).arg(slopePerDay, 0, 'g', 3);
+    if (!streamingStatus.isEmpty())
+        text += "\n" + streamingStatus;
+    statsLabel->setText(text);
+}
+
+/**
+ * @brief Oznacza, że dane są jeszcze pobierane i będą dopisywane przez appendBatch.
+ *
+ * Statystyki od tej chwili aktualizowane są przyrostowo (RunningStatistics), a percentyle
+ * wyznaczane dopiero po zakończeniu pobierania.
+ */
+void ChartWindow::startStreaming()
+{
+    running = RunningStatistics();
+    running.add(fullSeries.first());
+    streamingStatus = QString("Pobieranie danych... (pomiarów: %1)").arg(fullSeries.first().size());
+    const SeriesStatistics stats = running.statistics();
+    showStatistics(stats, stats.isValid() ? QDateTime::fromMSecsSinceEpoch(running.minTimestamp()) : QDateTime(),
+                   stats.isValid() ? QDateTime::fromMSecsSinceEpoch(running.maxTimestamp()) : QDateTime());
+}
+
+/**
+ * @brief Dopisuje porcję pobranych pomiarów do wykresu i statystyk.
+ *
+ * Pomiary o znacznikach czasu już obecnych w serii są pomijane. Jeśli wykres pokazywał
+ * całą serię, oś czasu rozszerzana jest o nowe pomiary; przybliżony fragment pozostaje
+ * bez zmian. Przed scaleniem PlotWidget zwalnia swoje odwołania do serii, więc kolumny
+ * zmieniane są w miejscu, bez kopiowania, a piramida obwiedni przeliczana jest tylko od
+ * pierwszego nowego pomiaru. Koszt zależy od rozmiaru porcji i liczby punktów wykresu,
+ * a nie od liczby wcześniej pobranych pomiarów (poza scaleniem porcji spoza końca serii).
+ *
+ * @param batch Pomiary posortowane według czasu.
+ */
+void ChartWindow::appendBatch(const MeasurementSeries &batch)
+{
+    TRACE_SPAN("appendBatch");
+    MeasurementSeries &series = fullSeries.first();
+    MeasurementSeries fresh;
+    fresh.reserve(batch.size());
+    for (int i = 0; i < batch.size(); ++i) {
+        const int position = series.lowerBound(batch.timestamp(i));
+        if (position < series.size() && series.timestamp(position) == batch.timestamp(i))
+            continue;
+        fresh.append(batch.timestamp(i), batch.value(i));
+    }
+    if (fresh.isEmpty())
+        return;
+
+    const qint64 shownFrom = isFastView() ? plotWidget->timeFrom() : axisX->min().toMSecsSinceEpoch();
+    const qint64 shownTo = isFastView() ? plotWidget->timeTo() : axisX->max().toMSecsSinceEpoch();
+    const bool showingAll = series.isEmpty()
+                            || (shownFrom <= series.timestamp(0) && shownTo >= series.timestamp(series.size() - 1));
+    const int firstChanged = series.lowerBound(fresh.timestamp(0));
+    running.add(fresh);
+    plotWidget->releaseSeries(0);
+    series.mergeSorted(fresh);
+    plotWidget->updateSeries(0, series, firstChanged);
+    shownFirst.fill(-1);
+    shownLast.fill(-1);
+
+    const SeriesStatistics stats = running.statistics();
+    axisY->setRange(stats.min, stats.max);
+    plotWidget->setValueRange(stats.min, stats.max);
+    if (showingAll) {
+        axisX->setRange(series.dateTime(0), series.dateTime(series.size() - 1));
+        plotWidget->setTimeRange(series.timestamp(0), series.timestamp(series.size() - 1));
+    }
+    updateSeries();
+
+    streamingStatus = QString("Pobieranie danych... (pomiarów: %1)").arg(series.size());
+    showStatistics(stats, QDateTime::fromMSecsSinceEpoch(running.minTimestamp()),
+                   QDateTime::fromMSecsSinceEpoch(running.maxTimestamp()));
+}
+
+/**
+ * @brief Zastępuje wyświetlane statystyki serii, np. po obliczeniu percentyli w tle.
+ * @param stats Statystyki serii.
+ * @param status Opis stanu wyświetlany pod statystykami.
+ */
+void ChartWindow::setStatistics(const SeriesStatistics &stats, const QString &status)
+{
+    const MeasurementSeries &series = fullSeries.first();
+    streamingStatus = status;
+    showStatistics(stats, stats.isValid() ? series.dateTime(stats.minIndex) : QDateTime(),
+                   stats.isValid() ? series.dateTime(stats.maxIndex) : QDateTime());
+}
+
+/**
+ * @brief Kończy dopisywanie i oblicza pełne statystyki serii (wraz z percentylami).
+ * @param complete true, jeśli pobrano wszystkie dane.
+ */
+void ChartWindow::finishStreaming(bool complete)
+{
+    const MeasurementSeries &series = fullSeries.first();
+    if (!complete)
+        streamingStatus = "Nie udało się pobrać wszystkich danych - wykres jest niepełny.";
+    else if (series.isEmpty())
+        streamingStatus = "Brak pomiarów w podanym zakresie.";
+    else
+        streamingStatus.clear();
+
+    const SeriesStatistics stats = SeriesStatistics::compute(series);
+    showStatistics(stats, stats.isValid() ? series.dateTime(stats.minIndex) : QDateTime(),
+                   stats.isValid() ? series.dateTime(stats.maxIndex) : QDateTime());
 }
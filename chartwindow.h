@@ -8,37 +8,134 @@
 
 #include <QDialog>
 #include <QtCharts>
+#include <QPushButton>
+#include <QStackedWidget>
+#include "measurementseries.h"
+#include "seriesstatistics.h"
+#include "comparisonquery.h"
+#include "plotwidget.h"
 
 /**
  * @class ChartWindow
  * @brief Okno dialogowe z wykresem danych pomiarowych oraz statystykami.
+ *
+ * Wykres nie otrzymuje wszystkich pomiarów, lecz ich redukcję do rozdzielczości obszaru
+ * wykresu (decimateMinMax). Pełna seria przechowywana jest w oknie, a redukcja liczona
+ * jest od nowa przy zmianie rozmiaru okna i przy przybliżaniu fragmentu osi czasu.
+ * Okno porównawcze wyświetla kilka serii (po jednej QLineSeries na sensor) na wspólnej osi czasu.
+ * Okno z jedną serią może być otwarte przed końcem pobierania i uzupełniane kolejnymi
+ * porcjami danych (appendBatch).
+ *
+ * Alternatywny widok PlotWidget rysuje serie bezpośrednio przez QPainter z obwiedni
+ * minimum i maksimum na piksel. Okno przełącza się na niego samo dla serii dłuższych
+ * niż FastViewPoints; przycisk pod wykresem pozwala zmienić widok w dowolnej chwili.
  */
 class ChartWindow : public QDialog
 {
     Q_OBJECT
 
 public:
+    /** @brief Łączna liczba pomiarów, od której okno otwiera się w widoku PlotWidget. */
+    static const int FastViewPoints = 200000;
+
     /**
      * @brief Konstruktor klasy ChartWindow.
-     * @param dataPoints Punkty do wykreślenia na wykresie.
-     * @param timestamps Znaczniki czasu dla każdego punktu.
-     * @param minVal Minimalna wartość pomiaru.
-     * @param minTime Czas minimalnej wartości.
-     * @param maxVal Maksymalna wartość pomiaru.
-     * @param maxTime Czas maksymalnej wartości.
-     * @param avg Średnia wartość pomiarów.
-     * @param trend Określenie trendu zmian.
+     * @param series Seria pomiarów do wykreślenia na wykresie.
+     * @param stats Statystyki serii.
      * @param paramName Nazwa parametru.
      * @param selectedStationName Nazwa stacji pomiarowej.
+     * @param resolution Opis rozdzielczości danych (np. "średnie dobowe"); pusty dla pomiarów godzinowych.
+     * @param parent Rodzic okna.
+     */
+    explicit ChartWindow(const MeasurementSeries &series, const SeriesStatistics &stats,
+                         QString paramName, QString selectedStationName, QString resolution = QString(),
+                         QWidget *parent = nullptr);
+
+    /**
+     * @brief Konstruktor okna porównującego kilka serii.
+     * @param comparison Serie, ich statystyki i wyrównanie na wspólnej osi czasu.
      * @param parent Rodzic okna.
      */
-    explicit ChartWindow(const QVector<QPointF> &dataPoints, const QVector<QDateTime> &timestamps,
-                         double minVal, QDateTime minTime, double maxVal, QDateTime maxTime,
-                         double avg, QString trend, QString paramName, QString selectedStationName, QWidget *parent = nullptr);
+    explicit ChartWindow(const ComparisonResult &comparison, QWidget *parent = nullptr);
+
+    /**
+     * @brief Oznacza, że dane są jeszcze pobierane i będą dopisywane przez appendBatch.
+     */
+    void startStreaming();
+
+    /**
+     * @brief Dopisuje porcję pobranych pomiarów do wykresu i statystyk.
+     * @param batch Pomiary posortowane według czasu.
+     */
+    void appendBatch(const MeasurementSeries &batch);
+
+    /**
+     * @brief Kończy dopisywanie i oblicza pełne statystyki serii.
+     * @param complete true, jeśli pobrano wszystkie dane.
+     */
+    void finishStreaming(bool complete);
+
+    /**
+     * @brief Zastępuje wyświetlane statystyki serii, np. po obliczeniu percentyli w tle.
+     * @param stats Statystyki serii; indeksy minimum i maksimum odnoszą się do serii okna.
+     * @param status Opis stanu wyświetlany pod statystykami; pusty ukrywa opis.
+     */
+    void setStatistics(const SeriesStatistics &stats, const QString &status = QString());
 
 private:
+    /**
+     * @brief Wyświetla statystyki jednej serii wraz z bieżącym stanem pobierania.
+     * @param stats Statystyki serii.
+     * @param minTime Czas pomiaru o najmniejszej wartości.
+     * @param maxTime Czas pomiaru o największej wartości.
+     */
+    void showStatistics(const SeriesStatistics &stats, const QDateTime &minTime, const QDateTime &maxTime);
+
+    /**
+     * @brief Tworzy wykres z jedną linią dla każdej serii oraz osie.
+     * @param title Tytuł wykresu.
+     * @param axisTitle Opis osi wartości.
+     * @param names Nazwy serii w legendzie; pusta lista ukrywa legendę.
+     * @param minValue Początek osi wartości.
+     * @param maxValue Koniec osi wartości.
+     */
+    void createChart(const QString &title, const QString &axisTitle, const QStringList &names,
+                     double minValue, double maxValue);
+
+    /**
+     * @brief Umieszcza wykres i statystyki w oknie oraz wykreśla serie.
+     */
+    void createLayout();
+
+    /**
+     * @brief Przelicza punkty wykresu dla widocznego zakresu osi czasu i szerokości wykresu.
+     */
+    void updateSeries();
+
+    /**
+     * @brief Przełącza między wykresem QtCharts a widokiem PlotWidget, zachowując zakres osi czasu.
+     * @param fast true - widok PlotWidget.
+     */
+    void setFastView(bool fast);
+
+    /** @brief Sprawdza, czy wyświetlany jest widok PlotWidget. */
+    bool isFastView() const;
+
+    QVector<MeasurementSeries> fullSeries;
+    QChart *chart;
+    QVector<QLineSeries *> lineSeries;
+    QDateTimeAxis *axisX;
+    QValueAxis *axisY;
     QChartView *chartView;
+    PlotWidget *plotWidget;
+    QStackedWidget *views = nullptr;
+    QPushButton *viewButton;
     QLabel *statsLabel;
+    QVector<int> shownFirst;
+    QVector<int> shownLast;
+    int shownBuckets = -1;
+    RunningStatistics running;
+    QString streamingStatus;
 };
 
 #endif // CHARTWINDOW_H
@@ -0,0 +1,22 @@
+/**
+ * @file commandline.cpp
+ * @brief Implementacja funkcji pomocniczych trybów wiersza poleceń.
+ */
+#include "commandline.h"
+/**
+ * @brief Odczytuje datę podaną w argumencie wiersza poleceń.
+ *
+ * Formaty sprawdzane są od najdokładniejszego.
+ *
+ * @param text Tekst daty.
+ * @return Odczytana data lub nieprawidłowa data, jeśli żaden format nie pasuje.
+ */
+QDateTime parseCommandLineDate(const QString &text)
+{
+    for (const char *format : { "yyyy-MM-dd HH:mm", "yyyy-MM-dd HH", "yyyy-MM-dd" }) {
+        QDateTime date = QDateTime::fromString(text, format);
+        if (date.isValid())
+            return date;
+    }
+    return QDateTime();
+}
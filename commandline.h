@@ -0,0 +1,19 @@
+/**
+ * @file commandline.h
+ * @brief Funkcje pomocnicze trybów wiersza poleceń (wsadowego i zestawień).
+ */
+
+#ifndef COMMANDLINE_H
+#define COMMANDLINE_H
+
+#include <QDateTime>
+#include <QString>
+
+/**
+ * @brief Odczytuje datę podaną w argumencie wiersza poleceń.
+ * @param text Data w jednym z formatów: "yyyy-MM-dd HH:mm", "yyyy-MM-dd HH", "yyyy-MM-dd".
+ * @return Odczytana data; nieprawidłowa (isValid() == false), jeśli żaden format nie pasuje.
+ */
+QDateTime parseCommandLineDate(const QString &text);
+
+#endif // COMMANDLINE_H
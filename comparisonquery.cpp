@@ -0,0 +1,189 @@
+/**
+ * @file comparisonquery.cpp
+ * @brief Implementacja równoległego zapytania o pomiary kilku sensorów.
+ */
+#include "comparisonquery.h"
+#include "dataworker.h"
+#include "fetchservice.h"
+#include "jsonstorage.h"
+#include "measurementwriter.h"
+#include "rollupstore.h"
+#include "tracing.h"
+#include <QtConcurrent>
+
+static_assert(ComparisonQuery::MaxTargets <= FetchService::ComparisonJobs,
+              "Wszystkie sensory porównania muszą mieścić się w puli zadań porównania");
+
+/**
+ * @brief Konstruktor klasy ComparisonQuery.
+ * @param fetchService Usługa pobierania danych.
+ * @param writer Wątek zapisu pobranych pomiarów.
+ * @param targets Porównywane sensory.
+ * @param from Początek zakresu.
+ * @param to Koniec zakresu.
+ * @param parent Obiekt nadrzędny.
+ */
+ComparisonQuery::ComparisonQuery(FetchService *fetchService, MeasurementWriter *writer, const QVector<Target> &targets,
+                                 const QDateTime &from, const QDateTime &to, QObject *parent)
+    : QObject(parent), fetchService(fetchService), writer(writer), targets(targets), from(from), to(to),
+    pendingSaves(targets.size(), 0), ready(targets.size(), false)
+{
+    connect(&watcher, &QFutureWatcherBase::finished, this, &ComparisonQuery::onLoaded);
+}
+
+/**
+ * @brief Rozpoczyna pobieranie brakujących danych wszystkich sensorów.
+ *
+ * Zadania wszystkich sensorów trafiają do FetchService od razu, z priorytetem
+ * FetchService::Comparison. Mają one własną pulę miejsc równą MaxTargets, więc wszystkie
+ * sensory pobierane są jednocześnie, niezależnie od limitu miejsc wątku i od innych zadań.
+ * Sensory, których zakres jest już w lokalnej bazie, nie czekają na sieć.
+ * Jeśli kolejka usługi jest pełna, dla danego sensora pokazywane są dane lokalne.
+ * Sensory wczytywane z lokalnej bazy bez zapisu mogą mieć nieaktualne agregaty;
+ * ich odbudowę wykonuje wątek zapisu (localReady).
+ */
+void ComparisonQuery::start()
+{
+    traceStart = Tracer::isEnabled() ? Tracer::now() : 0;
+    connect(writer, &MeasurementWriter::saved, this, &ComparisonQuery::onSaved);
+
+    remaining = targets.size();
+    for (int i = 0; i < targets.size(); ++i) {
+        const Target &target = targets[i];
+        const QVector<QPair<QDateTime, QDateTime>> ranges = missingRanges(target.stationId, target.sensorId, from, to);
+        if (ranges.isEmpty()) {
+            localReady(i);
+            continue;
+        }
+
+        DataWorker *worker = new DataWorker(target.sensorId, ranges);
+        connect(worker, &DataWorker::dataReady, this, [this, i, ranges](MeasurementSeries series, bool complete) {
+            onFetched(i, ranges, series, complete);
+        });
+        if (!fetchService->submit(worker, FetchService::Comparison)) {
+            delete worker;
+            failed.append(target.label());
+            localReady(i);
+        }
+    }
+}
+
+/**
+ * @brief Zleca zapis pobranych pomiarów sensora.
+ * @param index Numer sensora.
+ * @param ranges Pobrane przedziały.
+ * @param series Pobrane pomiary.
+ * @param complete true, jeśli pobrano wszystkie przedziały.
+ */
+void ComparisonQuery::onFetched(int index, const QVector<QPair<QDateTime, QDateTime>> &ranges,
+                                const MeasurementSeries &series, bool complete)
+{
+    if (!complete) {
+        failed.append(targets[index].label());
+        localReady(index);
+        return;
+    }
+    pendingSaves[index] = writer->enqueue(targets[index].stationId, targets[index].sensorId, ranges, series);
+}
+
+/**
+ * @brief Oznacza sensory, których pobrane pomiary zostały zapisane.
+ * @param stationId ID stacji.
+ * @param sensorId ID sensora.
+ * @param sequence Numer ostatniego zapisanego zlecenia.
+ */
+void ComparisonQuery::onSaved(int stationId, int sensorId, quint64 sequence)
+{
+    for (int i = 0; i < targets.size(); ++i) {
+        if (!ready[i] && pendingSaves[i] != 0 && sequence >= pendingSaves[i]
+            && targets[i].stationId == stationId && targets[i].sensorId == sensorId)
+            targetReady(i);
+    }
+}
+
+/**
+ * @brief Oznacza jako gotowy sensor, którego dane wczytywane są z lokalnej bazy bez zapisu.
+ *
+ * Jeśli zakres rysowany jest z agregatów, a agregaty sensora są nieaktualne, najpierw
+ * zlecana jest ich odbudowa w wątku zapisu (MeasurementWriter::updateRollups); sensor
+ * staje się gotowy po jej zakończeniu (onSaved).
+ *
+ * @param index Numer sensora.
+ */
+void ComparisonQuery::localReady(int index)
+{
+    const Target &target = targets[index];
+    if (RollupStore::tierForRange(from.toMSecsSinceEpoch(), to.toMSecsSinceEpoch()) == RollupStore::Hourly
+        || rollupsUpToDate(target.stationId, target.sensorId)) {
+        targetReady(index);
+        return;
+    }
+    pendingSaves[index] = writer->updateRollups(target.stationId, target.sensorId);
+}
+
+/**
+ * @brief Oznacza sensor jako gotowy do wczytania; po ostatnim rozpoczyna wczytywanie.
+ * @param index Numer sensora.
+ */
+void ComparisonQuery::targetReady(int index)
+{
+    ready[index] = true;
+    if (--remaining == 0)
+        load();
+}
+
+/**
+ * @brief Wczytuje serie wszystkich sensorów z lokalnej bazy w puli wątków QtConcurrent.
+ *
+ * Dla długich zakresów używany jest ten sam poziom agregatów co dla pojedynczego
+ * wykresu (RollupStore::tierForRange), więc przedziały wszystkich serii mają wspólne początki.
+ * Percentyle liczone są wtedy z pomiarów godzinowych, jak w MainWindow::showChart.
+ */
+void ComparisonQuery::load()
+{
+    const RollupStore::Tier tier = RollupStore::tierForRange(from.toMSecsSinceEpoch(), to.toMSecsSinceEpoch());
+    const QDateTime rangeFrom = from, rangeTo = to;
+    watcher.setFuture(QtConcurrent::mapped(targets, [tier, rangeFrom, rangeTo](const Target &target) {
+        TRACE_SPAN("comparisonLoad");
+        LoadedSeries loaded;
+        if (tier == RollupStore::Hourly) {
+            loaded.series = loadMeasurementsRange(target.stationId, target.sensorId, rangeFrom, rangeTo);
+            loaded.stats = SeriesStatistics::compute(loaded.series);
+        } else {
+            const QVector<RollupBucket> buckets = loadRollups(target.stationId, target.sensorId, tier, rangeFrom, rangeTo);
+            loaded.series.reserve(buckets.size());
+            for (const RollupBucket &bucket : buckets)
+                loaded.series.append(bucket.start, bucket.mean());
+            loaded.stats = SeriesStatistics::fromRollups(buckets);
+            if (loaded.stats.isValid())
+                loaded.stats.computePercentiles(loadMeasurementsRange(target.stationId, target.sensorId, rangeFrom, rangeTo));
+        }
+        return loaded;
+    }));
+}
+
+/**
+ * @brief Wyrównuje wczytane serie na wspólnej osi czasu i emituje wynik.
+ */
+void ComparisonQuery::onLoaded()
+{
+    const QList<LoadedSeries> loaded = watcher.future().results();
+    const RollupStore::Tier tier = RollupStore::tierForRange(from.toMSecsSinceEpoch(), to.toMSecsSinceEpoch());
+
+    ComparisonResult result;
+    for (int i = 0; i < loaded.size(); ++i) {
+        result.labels.append(targets[i].label());
+        result.paramNames.append(targets[i].paramName);
+        result.series.append(loaded[i].series);
+        result.stats.append(loaded[i].stats);
+    }
+    result.aligned = alignSeries(result.series);
+    if (tier != RollupStore::Hourly)
+        result.resolution = (tier == RollupStore::Daily) ? "średnie dobowe" : "średnie miesięczne";
+    result.failed = failed;
+
+    if (traceStart != 0)
+        Tracer::record("comparisonRequest", traceStart, Tracer::now());
+    emit finished(result);
+    deleteLater();
+}
@@ -0,0 +1,140 @@
+/**
+ * @file comparisonquery.h
+ * @brief Definicja klasy ComparisonQuery - równoległego zapytania o kilka sensorów.
+ */
+
+#ifndef COMPARISONQUERY_H
+#define COMPARISONQUERY_H
+
+#include <QObject>
+#include <QVector>
+#include <QStringList>
+#include <QDateTime>
+#include <QFutureWatcher>
+#include "measurementseries.h"
+#include "seriesstatistics.h"
+#include "seriesjoin.h"
+
+class FetchService;
+class MeasurementWriter;
+
+/**
+ * @struct ComparisonResult
+ * @brief Wynik zapytania porównawczego - serie kilku sensorów na wspólnej osi czasu.
+ */
+struct ComparisonResult
+{
+    /** @brief Opisy serii (parametr i stacja). */
+    QStringList labels;
+
+    /** @brief Nazwy parametrów serii. */
+    QStringList paramNames;
+
+    /** @brief Serie pomiarów w kolejności opisów. */
+    QVector<MeasurementSeries> series;
+
+    /** @brief Statystyki serii. */
+    QVector<SeriesStatistics> stats;
+
+    /** @brief Serie wyrównane na wspólnej osi czasu. */
+    AlignedSeries aligned;
+
+    /** @brief Opis rozdzielczości danych; pusty dla pomiarów godzinowych. */
+    QString resolution;
+
+    /** @brief Opisy serii, których nie udało się pobrać (pokazane są dane lokalne). */
+    QStringList failed;
+};
+
+/**
+ * @class ComparisonQuery
+ * @brief Pobiera i wczytuje pomiary kilku sensorów jednocześnie.
+ *
+ * Brakujące przedziały wszystkich sensorów przekazywane są do FetchService naraz, z własną
+ * pulą miejsc dla zapytań porównawczych (FetchService::Comparison), a po zapisaniu
+ * pobranych danych serie wczytywane są z lokalnej bazy równolegle (QtConcurrent).
+ * Obiekt usuwa się sam po emisji sygnału finished.
+ */
+class ComparisonQuery : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** @brief Maksymalna liczba porównywanych sensorów (FetchService::ComparisonJobs). */
+    static const int MaxTargets = 8;
+
+    /**
+     * @struct Target
+     * @brief Sensor uwzględniany w porównaniu.
+     */
+    struct Target {
+        int stationId = -1;     ///< ID stacji.
+        int sensorId = -1;      ///< ID sensora.
+        QString paramName;      ///< Nazwa parametru.
+        QString stationName;    ///< Nazwa stacji.
+
+        /** @brief Zwraca opis serii na wykresie. */
+        QString label() const { return QString("%1 - %2").arg(paramName, stationName); }
+
+        bool operator==(const Target &other) const
+        {
+            return stationId == other.stationId && sensorId == other.sensorId;
+        }
+    };
+
+    /**
+     * @brief Konstruktor klasy ComparisonQuery.
+     * @param fetchService Usługa pobierania danych.
+     * @param writer Wątek zapisu pobranych pomiarów.
+     * @param targets Porównywane sensory.
+     * @param from Początek zakresu.
+     * @param to Koniec zakresu.
+     * @param parent Obiekt nadrzędny.
+     */
+    ComparisonQuery(FetchService *fetchService, MeasurementWriter *writer, const QVector<Target> &targets,
+                    const QDateTime &from, const QDateTime &to, QObject *parent = nullptr);
+
+    /**
+     * @brief Rozpoczyna pobieranie brakujących danych wszystkich sensorów.
+     */
+    void start();
+
+signals:
+    /**
+     * @brief Emitowany po wczytaniu wszystkich serii.
+     * @param result Serie, statystyki i ich wyrównanie.
+     */
+    void finished(const ComparisonResult &result);
+
+private:
+    /**
+     * @struct LoadedSeries
+     * @brief Seria jednego sensora wczytana z lokalnej bazy wraz ze statystykami.
+     */
+    struct LoadedSeries {
+        MeasurementSeries series;
+        SeriesStatistics stats;
+    };
+
+    void onFetched(int index, const QVector<QPair<QDateTime, QDateTime>> &ranges,
+                   const MeasurementSeries &series, bool complete);
+    void onSaved(int stationId, int sensorId, quint64 sequence);
+    void localReady(int index);
+    void targetReady(int index);
+    void load();
+    void onLoaded();
+
+    FetchService *fetchService;
+    MeasurementWriter *writer;
+    QVector<Target> targets;
+    QDateTime from;
+    QDateTime to;
+    QVector<quint64> pendingSaves;
+    QVector<bool> ready;
+    int remaining = 0;
+    QStringList failed;
+    QFutureWatcher<LoadedSeries> watcher;
+    qint64 traceStart = 0;
+};
+
+#endif // COMPARISONQUERY_H
@@ -0,0 +1,103 @@
+/**
+ * @file coveragemap.cpp
+ * @brief Implementacja mapy przedziałów czasu zapisanych lokalnie.
+ */
+#include "coveragemap.h"
+#include <QJsonObject>
+#include <QJsonValue>
+#include <algorithm>
+
+/**
+ * @brief Oznacza przedział jako pobrany.
+ *
+ * Przedziały nachodzące na nowy lub stykające się z nim są z nim scalane,
+ * więc mapa pozostaje posortowana i rozłączna.
+ *
+ * @param from Początek przedziału.
+ * @param to Koniec przedziału (wyłącznie).
+ */
+void CoverageMap::add(qint64 from, qint64 to)
+{
+    if (from >= to)
+        return;
+
+    auto first = std::lower_bound(intervals.begin(), intervals.end(), from,
+                                  [](const Interval &interval, qint64 value) { return interval.second < value; });
+    auto last = first;
+    while (last != intervals.end() && last->first <= to) {
+        from = qMin(from, last->first);
+        to = qMax(to, last->second);
+        ++last;
+    }
+
+    const int index = int(first - intervals.begin());
+    intervals.erase(first, last);
+    intervals.insert(index, Interval(from, to));
+}
+
+/**
+ * @brief Sprawdza, czy cały przedział jest pobrany.
+ * @param from Początek przedziału.
+ * @param to Koniec przedziału (wyłącznie).
+ * @return true, jeśli przedział zawiera się w jednym z zapisanych przedziałów.
+ */
+bool CoverageMap::covers(qint64 from, qint64 to) const
+{
+    return missing(from, to).isEmpty();
+}
+
+/**
+ * @brief Zwraca fragmenty przedziału, które nie zostały jeszcze pobrane.
+ * @param from Początek przedziału.
+ * @param to Koniec przedziału (wyłącznie).
+ * @return Posortowane, rozłączne przedziały brakujących danych.
+ */
+QVector<CoverageMap::Interval> CoverageMap::missing(qint64 from, qint64 to) const
+{
+    QVector<Interval> gaps;
+    if (from >= to)
+        return gaps;
+
+    auto it = std::upper_bound(intervals.begin(), intervals.end(), from,
+                               [](qint64 value, const Interval &interval) { return value < interval.second; });
+    qint64 position = from;
+    for (; it != intervals.end() && it->first < to; ++it) {
+        if (it->first > position)
+            gaps.append(Interval(position, it->first));
+        position = qMax(position, it->second);
+    }
+    if (position < to)
+        gaps.append(Interval(position, to));
+    return gaps;
+}
+
+/**
+ * @brief Zapisuje mapę jako tablicę JSON.
+ * @return Tablica obiektów {"from", "to"} z czasami w milisekundach od epoki.
+ */
+QJsonArray CoverageMap::toJson() const
+{
+    QJsonArray array;
+    for (const Interval &interval : intervals) {
+        QJsonObject obj;
+        obj.insert("from", double(interval.first));
+        obj.insert("to", double(interval.second));
+        array.append(obj);
+    }
+    return array;
+}
+
+/**
+ * @brief Odczytuje mapę z tablicy JSON.
+ * @param array Tablica obiektów {"from", "to"}.
+ * @return Odczytana mapa (nieprawidłowe wpisy są pomijane).
+ */
+CoverageMap CoverageMap::fromJson(const QJsonArray &array)
+{
+    CoverageMap map;
+    for (const QJsonValue &value : array) {
+        QJsonObject obj = value.toObject();
+        map.add(qint64(obj["from"].toDouble()), qint64(obj["to"].toDouble()));
+    }
+    return map;
+}
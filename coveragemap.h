@@ -0,0 +1,68 @@
+/**
+ * @file coveragemap.h
+ * @brief Definicja klasy CoverageMap - mapy przedziałów czasu zapisanych lokalnie.
+ */
+
+#ifndef COVERAGEMAP_H
+#define COVERAGEMAP_H
+
+#include <QVector>
+#include <QPair>
+#include <QJsonArray>
+
+/**
+ * @class CoverageMap
+ * @brief Zbiór rozłącznych przedziałów czasu, dla których dane sensora zostały już pobrane.
+ *
+ * Przedziały są półotwarte [od, do) w milisekundach od epoki, posortowane i scalone.
+ * Pokrycie jest zapisywane niezależnie od samych pomiarów, bo brak pomiaru w pliku
+ * nie oznacza, że dany okres nie został pobrany (API może nie mieć danych).
+ */
+class CoverageMap
+{
+public:
+    /** @brief Przedział czasu [first, second) w milisekundach od epoki. */
+    using Interval = QPair<qint64, qint64>;
+
+    /** @brief Tworzy pustą mapę. */
+    CoverageMap() = default;
+
+    /** @brief Sprawdza, czy mapa jest pusta. */
+    bool isEmpty() const { return intervals.isEmpty(); }
+
+    /** @brief Zwraca posortowane, rozłączne przedziały. */
+    const QVector<Interval> &coveredIntervals() const { return intervals; }
+
+    /**
+     * @brief Oznacza przedział jako pobrany, scalając go z sąsiednimi.
+     * @param from Początek przedziału.
+     * @param to Koniec przedziału (wyłącznie).
+     */
+    void add(qint64 from, qint64 to);
+
+    /**
+     * @brief Sprawdza, czy cały przedział jest pobrany.
+     * @param from Początek przedziału.
+     * @param to Koniec przedziału (wyłącznie).
+     */
+    bool covers(qint64 from, qint64 to) const;
+
+    /**
+     * @brief Zwraca fragmenty przedziału, które nie zostały jeszcze pobrane.
+     * @param from Początek przedziału.
+     * @param to Koniec przedziału (wyłącznie).
+     * @return Posortowane, rozłączne przedziały brakujących danych.
+     */
+    QVector<Interval> missing(qint64 from, qint64 to) const;
+
+    /** @brief Zapisuje mapę jako tablicę JSON obiektów {"from", "to"}. */
+    QJsonArray toJson() const;
+
+    /** @brief Odczytuje mapę z tablicy JSON. */
+    static CoverageMap fromJson(const QJsonArray &array);
+
+private:
+    QVector<Interval> intervals;
+};
+
+#endif // COVERAGEMAP_H
@@ -3,9 +3,9 @@
  * @brief Implementacja klasy DataWorker odpowiedzialnej za pobieranie danych do wykresu z sieci.
  */
 #include "dataworker.h"
-#include <QJsonDocument>
-#include <QJsonArray>
-#include <QJsonObject>
+#include "networktransport.h"
+#include "tracing.h"
+#include <QTimer>
 /**
  * @brief Konstruktor klasy DataWorker.
  * @param sensorId ID sensora.
@@ -13,49 +13,268 @@
  * @param to Data końcowa.
  */
 DataWorker::DataWorker(int sensorId, const QDateTime &from, const QDateTime &to)
-    : sensorId(sensorId), dateFrom(from), dateTo(to)
+    : sensorId(sensorId), ranges{ { from, to } }
 {
-    manager = new QNetworkAccessManager(this);
-    connect(manager, &QNetworkAccessManager::finished, this, &DataWorker::onReply);
+}
+/**
+ * @brief Konstruktor pobierający kilka rozłącznych przedziałów dat.
+ * @param sensorId ID sensora.
+ * @param ranges Przedziały dat (od, do) posortowane chronologicznie.
+ */
+DataWorker::DataWorker(int sensorId, const QVector<QPair<QDateTime, QDateTime>> &ranges)
+    : sensorId(sensorId), ranges(ranges)
+{
+}
+/**
+ * @brief Ustawia menedżera sieci używanego do zapytań.
+ * @param networkManager Współdzielony menedżer sieci.
+ */
+void DataWorker::setNetworkManager(QNetworkAccessManager *networkManager)
+{
+    manager = networkManager;
+}
+/**
+ * @brief Ustawia długość pojedynczej strony.
+ * @param hours Liczba godzin obejmowanych przez jedną stronę.
+ */
+void DataWorker::setPageHours(int hours)
+{
+    pageHours = qMax(1, hours);
+}
+/**
+ * @brief Ustawia maksymalną liczbę jednocześnie pobieranych stron.
+ * @param count Liczba zapytań wykonywanych równolegle.
+ */
+void DataWorker::setMaxConcurrentPages(int count)
+{
+    maxConcurrentPages = qMax(1, count);
+}
+/**
+ * @brief Zwraca znacznik anulowania zadania.
+ * @return Kopia znacznika współdzielona z zadaniem.
+ */
+CancellationToken DataWorker::cancellationToken() const
+{
+    return token;
 }
 /**
  * @brief Rozpoczyna operację pobierania danych do wykresu z API.
+ *
+ * Dzieli przedziały dat na strony i uruchamia pobieranie pierwszych z nich.
  */
 void DataWorker::start()
 {
-    int hours = int(dateFrom.secsTo(dateTo)) / 3600;
+    if (!manager)
+        manager = new NetworkTransport(this);
+
+    pages.clear();
+    pendingPages.clear();
+    merged.clear();
+    nextPageToMerge = 0;
+    finished = false;
+    if (stopIfCancelled())
+        return;
+
+    for (const QPair<QDateTime, QDateTime> &range : std::as_const(ranges)) {
+        QDateTime pageFrom = range.first;
+        do {
+            Page page;
+            page.from = pageFrom;
+            page.to = qMin(pageFrom.addSecs(qint64(pageHours - 1) * 3600), range.second);
+            pages.append(page);
+            pageFrom = pageFrom.addSecs(qint64(pageHours) * 3600);
+        } while (pageFrom <= range.second);
+    }
+
+    if (pages.isEmpty()) {
+        finish(MeasurementSeries(), true);
+        return;
+    }
+    for (int i = 0; i < pages.size(); ++i)
+        pendingPages.enqueue(i);
+    startPendingPages();
+}
+
+/**
+ * @brief Tworzy adres zapytania o dane archiwalne dla jednej strony.
+ * @param page Strona zakresu dat.
+ * @return Adres URL zapytania.
+ */
+QUrl DataWorker::pageUrl(const Page &page) const
+{
+    int hours = int(page.from.secsTo(page.to)) / 3600 + 1;
     QString url = QString("https://api.gios.gov.pl/pjp-api/rest/archivalData/getDataBySensor/%1?size=%2&dateFrom=%3piotr%4pyka00&dateTo=%5piotr%6pyka00")
-                      .arg(sensorId).arg(hours).arg(dateFrom.toString("yyyy-MM-dd")).arg(dateFrom.toString("HH"))
-                      .arg(dateTo.toString("yyyy-MM-dd")).arg(dateTo.toString("HH"));
+                      .arg(sensorId).arg(hours).arg(page.from.toString("yyyy-MM-dd")).arg(page.from.toString("HH"))
+                      .arg(page.to.toString("yyyy-MM-dd")).arg(page.to.toString("HH"));
 
     url.replace("piotr", "%20");
     url.replace("pyka", "%3A");
-    QUrl qurl(url);
-    QNetworkRequest request(qurl);
-    manager->get(request);
+    return QUrl(url);
 }
 
 /**
- * @brief Obsługuje odpowiedź z zapytania sieciowego.
+ * @brief Wysyła zapytanie o jedną stronę danych.
+ *
+ * Odpowiedź przetwarzana jest na bieżąco przez parser strony. Zakończenie zapytania
+ * obsługiwane jest przez sygnał samej odpowiedzi, bo menedżer sieci może być
+ * współdzielony z innymi zadaniami.
+ *
+ * @param index Numer strony.
+ */
+void DataWorker::requestPage(int index)
+{
+    Page &page = pages[index];
+    page.parser.reset();
+    ++page.attempts;
+    page.requestStart = Tracer::isEnabled() ? Tracer::now() : 0;
+
+    QNetworkRequest request(pageUrl(page));
+    QNetworkReply *reply = manager->get(request);
+    activeReplies.insert(reply, index);
+    connect(reply, &QNetworkReply::readyRead, this, [this, reply, index]() {
+        if (stopIfCancelled())
+            return;
+        TRACE_SPAN("parse");
+        pages[index].parser.feed(reply->readAll());
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        onReply(reply);
+    });
+}
+
+/**
+ * @brief Uruchamia oczekujące strony, dopóki nie zostanie osiągnięty limit jednoczesnych zapytań.
+ */
+void DataWorker::startPendingPages()
+{
+    if (stopIfCancelled())
+        return;
+    while (!finished && !pendingPages.isEmpty() && activeReplies.size() < maxConcurrentPages)
+        requestPage(pendingPages.dequeue());
+}
+
+/**
+ * @brief Dołącza do wyniku kolejne ukończone strony, zachowując porządek chronologiczny.
+ */
+void DataWorker::mergeCompletedPages()
+{
+    while (nextPageToMerge < pages.size() && pages[nextPageToMerge].done) {
+        merged.append(pages[nextPageToMerge].series);
+        pages[nextPageToMerge].series.clear();
+        ++nextPageToMerge;
+    }
+
+    if (nextPageToMerge == pages.size())
+        finish(merged, true);
+}
+
+/**
+ * @brief Kończy pobieranie, przerywa pozostałe zapytania i emituje wynik.
+ * @param series Wynik pobierania (pusty w przypadku błędu).
+ * @param complete true, jeśli pobrano wszystkie strony.
+ */
+void DataWorker::finish(const MeasurementSeries &series, bool complete)
+{
+    if (finished)
+        return;
+    stop();
+    emit dataReady(series, complete);
+}
+
+/**
+ * @brief Oznacza zadanie jako zakończone, usuwa oczekujące strony i przerywa trwające zapytania.
+ */
+void DataWorker::stop()
+{
+    finished = true;
+    pendingPages.clear();
+
+    const QList<QNetworkReply *> replies = activeReplies.keys();
+    for (QNetworkReply *reply : replies)
+        reply->abort();
+}
+
+/**
+ * @brief Anuluje pobieranie i przerywa trwające zapytania.
+ *
+ * Pobrane dotąd strony są odrzucane. Sygnał cancelled emitowany jest tylko wtedy, gdy
+ * zadanie nie wyemitowało jeszcze dataReady.
+ */
+void DataWorker::cancel()
+{
+    token.cancel();
+    if (finished)
+        return;
+    stop();
+    merged.clear();
+    emit cancelled();
+}
+
+/**
+ * @brief Kończy zadanie, jeśli zostało anulowane przez znacznik.
+ * @return true, jeśli zadanie zostało anulowane.
+ */
+bool DataWorker::stopIfCancelled()
+{
+    if (!token.isCancelled())
+        return false;
+    cancel();
+    return true;
+}
+
+/**
+ * @brief Obsługuje zakończenie zapytania o jedną stronę.
+ *
+ * Dane odpowiedzi są przetwarzane na bieżąco w miarę nadchodzenia (sygnał readyRead),
+ * tutaj parser otrzymuje jedynie ostatni fragment. Nieudana strona jest ponawiana
+ * z rosnącym opóźnieniem; po wyczerpaniu prób całe pobieranie kończy się pustym wynikiem.
+ *
  * @param reply Odpowiedź HTTP zawierająca dane.
  */
 void DataWorker::onReply(QNetworkReply *reply)
 {
-    QVector<DataPoint> points;
+    reply->deleteLater();
+    if (!activeReplies.contains(reply))
+        return;
+    const int index = activeReplies.take(reply);
+    if (finished || stopIfCancelled())
+        return;
 
-    if (reply->error() == QNetworkReply::NoError) {
-        QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
-        QJsonArray results = doc.object().value("Lista archiwalnych wyników pomiarów").toArray();
+    Page &page = pages[index];
+    if (page.requestStart != 0)
+        Tracer::record("network", page.requestStart, Tracer::now());
+    bool ok = reply->error() == QNetworkReply::NoError;
+    if (ok) {
+        TRACE_SPAN("parse");
+        page.parser.feed(reply->readAll());
+        ok = page.parser.finish();
+    }
+    if (stopIfCancelled())
+        return;
 
-        for (const QJsonValue &val : std::as_const(results)) {
-            QJsonObject obj = val.toObject();
-            QString dateStr = obj["Data"].toString();
-            double value = obj["Wartość"].toDouble();
-            QDateTime timestamp = QDateTime::fromString(dateStr, "yyyy-MM-dd HH:mm:ss");
-            points.append({ timestamp, value });
+    if (!ok) {
+        page.parser.reset();
+        if (page.attempts >= MaxPageAttempts) {
+            finish(MeasurementSeries(), false);
+            return;
         }
+        QTimer::singleShot(500 * page.attempts, this, [this, index]() {
+            pendingPages.prepend(index);
+            startPendingPages();
+        });
+        startPendingPages();
+        return;
     }
 
-    reply->deleteLater();
-    emit dataReady(points);
+    page.series = page.parser.takeSeries();
+    {
+        TRACE_SPAN("sort");
+        page.series.sortByTime();
+    }
+    page.parser.reset();
+    page.done = true;
+    emit batchReady(page.series);
+
+    mergeCompletedPages();
+    startPendingPages();
 }
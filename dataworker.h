@@ -8,29 +8,44 @@
 
 #include <QObject>
 #include <QVector>
+#include <QPair>
+#include <QHash>
+#include <QQueue>
 #include <QDateTime>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
-
-/**
- * @struct DataPoint
- * @brief Reprezentuje pojedynczy pomiar wartości wraz z czasem.
- */
-struct DataPoint {
-    QDateTime timestamp;
-    double value;
-};
+#include "measurementseries.h"
+#include "giosstreamparser.h"
+#include "cancellationtoken.h"
 
 /**
  * @class DataWorker
  * @brief Klasa odpowiedzialna za asynchroniczne pobieranie danych z sieci.
+ *
+ * Zakres dat dzielony jest na strony obejmujące stały przedział czasu. Strony pobierane są
+ * równolegle (z ograniczeniem liczby jednoczesnych zapytań), a nieudane zapytania o pojedynczą
+ * stronę są ponawiane bez przerywania pozostałych. Każda pobrana strona jest od razu
+ * przekazywana sygnałem batchReady, więc odbiorca może wyświetlać dane przed końcem pobierania.
+ *
+ * Zadanie można anulować znacznikiem CancellationToken: jest on sprawdzany przed każdym
+ * zapytaniem i każdym fragmentem odpowiedzi, a po anulowaniu trwające zapytania są
+ * przerywane i zamiast dataReady emitowany jest sygnał cancelled.
  */
 class DataWorker : public QObject
 {
     Q_OBJECT
 
 public:
+    /** @brief Domyślna długość strony w godzinach. */
+    static const int DefaultPageHours = 24 * 7;
+
+    /** @brief Domyślna liczba jednocześnie pobieranych stron. */
+    static const int DefaultMaxConcurrentPages = 4;
+
+    /** @brief Liczba prób pobrania jednej strony. */
+    static const int MaxPageAttempts = 3;
+
     /**
      * @brief Konstruktor klasy DataWorker.
      * @param sensorId Identyfikator sensora.
@@ -39,17 +54,77 @@ public:
      */
     explicit DataWorker(int sensorId, const QDateTime &from, const QDateTime &to);
 
+    /**
+     * @brief Konstruktor pobierający kilka rozłącznych przedziałów dat.
+     * @param sensorId Identyfikator sensora.
+     * @param ranges Przedziały dat (od, do) posortowane chronologicznie.
+     */
+    DataWorker(int sensorId, const QVector<QPair<QDateTime, QDateTime>> &ranges);
+
+    /**
+     * @brief Ustawia menedżera sieci używanego do zapytań.
+     *
+     * Menedżer musi należeć do wątku, w którym działa obiekt. Jeśli nie zostanie ustawiony,
+     * obiekt tworzy własnego menedżera przy starcie.
+     *
+     * @param networkManager Współdzielony menedżer sieci.
+     */
+    void setNetworkManager(QNetworkAccessManager *networkManager);
+
+    /**
+     * @brief Ustawia długość pojedynczej strony.
+     * @param hours Liczba godzin obejmowanych przez jedną stronę.
+     */
+    void setPageHours(int hours);
+
+    /**
+     * @brief Ustawia maksymalną liczbę jednocześnie pobieranych stron.
+     * @param count Liczba zapytań wykonywanych równolegle.
+     */
+    void setMaxConcurrentPages(int count);
+
+    /**
+     * @brief Zwraca znacznik anulowania zadania.
+     *
+     * Znacznik można ustawić z dowolnego wątku; zadanie zatrzymuje się przy najbliższym
+     * fragmencie odpowiedzi. Aby natychmiast przerwać zapytania, należy dodatkowo wywołać
+     * cancel() w wątku zadania.
+     *
+     * @return Kopia znacznika współdzielona z zadaniem.
+     */
+    CancellationToken cancellationToken() const;
+
     /**
      * @brief Rozpoczyna pobieranie danych.
      */
     void start();
 
+    /**
+     * @brief Anuluje pobieranie i przerywa trwające zapytania.
+     *
+     * Metoda musi być wywołana w wątku, w którym działa obiekt. Jeśli zadanie nie zostało
+     * jeszcze zakończone, emitowany jest sygnał cancelled.
+     */
+    void cancel();
+
 signals:
+    /**
+     * @brief Emitowany po pobraniu każdej strony, w kolejności ukończenia (nie chronologicznie).
+     * @param batch Pomiary strony posortowane według czasu.
+     */
+    void batchReady(MeasurementSeries batch);
+
     /**
      * @brief Emitowany po zakończeniu pobierania danych.
-     * @param dataPoints Wektor pobranych danych.
+     * @param series Pobrane pomiary posortowane według czasu.
+     * @param complete true, jeśli pobrano wszystkie przedziały; false w przypadku błędu.
      */
-    void dataReady(QVector<DataPoint> dataPoints);
+    void dataReady(MeasurementSeries series, bool complete);
+
+    /**
+     * @brief Emitowany zamiast dataReady, gdy zadanie zostało anulowane.
+     */
+    void cancelled();
 
 private slots:
     /**
@@ -59,9 +134,41 @@ private slots:
     void onReply(QNetworkReply *reply);
 
 private:
+    /**
+     * @struct Page
+     * @brief Fragment zakresu dat pobierany jednym zapytaniem.
+     */
+    struct Page {
+        QDateTime from;
+        QDateTime to;
+        MeasurementSeries series;
+        GiosStreamParser parser;
+        int attempts = 0;
+        bool done = false;
+        qint64 requestStart = 0;
+    };
+
+    QUrl pageUrl(const Page &page) const;
+    void requestPage(int index);
+    void startPendingPages();
+    void mergeCompletedPages();
+    void stop();
+    void finish(const MeasurementSeries &series, bool complete);
+    bool stopIfCancelled();
+
     int sensorId;
-    QDateTime dateFrom, dateTo;
-    QNetworkAccessManager *manager;
+    QVector<QPair<QDateTime, QDateTime>> ranges;
+    QNetworkAccessManager *manager = nullptr;
+
+    int pageHours = DefaultPageHours;
+    int maxConcurrentPages = DefaultMaxConcurrentPages;
+    QVector<Page> pages;
+    QQueue<int> pendingPages;
+    QHash<QNetworkReply *, int> activeReplies;
+    int nextPageToMerge = 0;
+    MeasurementSeries merged;
+    bool finished = false;
+    CancellationToken token;
 };
 
 #endif // DATAWORKER_H
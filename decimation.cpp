@@ -0,0 +1,68 @@
+/**
+ * @file decimation.cpp
+ * @brief Implementacja redukcji liczby punktów serii pomiarów.
+ */
+#include "decimation.h"
+
+/**
+ * @brief Redukuje fragment serii do minimum i maksimum w każdym przedziale czasu.
+ * @param series Seria posortowana według czasu.
+ * @param first Indeks pierwszego punktu fragmentu.
+ * @param last Indeks za ostatnim punktem fragmentu.
+ * @param buckets Liczba przedziałów.
+ * @return Punkty fragmentu po redukcji.
+ */
+QList<QPointF> decimateMinMax(const MeasurementSeries &series, int first, int last, int buckets)
+{
+    QList<QPointF> points;
+    first = qMax(0, first);
+    last = qMin(series.size(), last);
+    if (first >= last)
+        return points;
+
+    const qint64 *timestamps = series.timestamps().constData();
+    const double *values = series.values().constData();
+    const int count = last - first;
+
+    if (buckets < 1 || count <= 2 * buckets) {
+        points.reserve(count);
+        for (int i = first; i < last; ++i)
+            points.append(QPointF(timestamps[i], values[i]));
+        return points;
+    }
+
+    points.reserve(2 * buckets + 2);
+    const qint64 start = timestamps[first];
+    const qint64 span = timestamps[last - 1] - start + 1;
+    int lastEmitted = first;
+    points.append(QPointF(timestamps[first], values[first]));
+
+    auto emitIndex = [&](int index) {
+        if (index > lastEmitted) {
+            points.append(QPointF(timestamps[index], values[index]));
+            lastEmitted = index;
+        }
+    };
+    auto flush = [&](int minIndex, int maxIndex) {
+        emitIndex(qMin(minIndex, maxIndex));
+        emitIndex(qMax(minIndex, maxIndex));
+    };
+
+    int bucket = 0;
+    int minIndex = first, maxIndex = first;
+    for (int i = first + 1; i < last; ++i) {
+        const int current = int((timestamps[i] - start) * buckets / span);
+        if (current != bucket) {
+            flush(minIndex, maxIndex);
+            bucket = current;
+            minIndex = maxIndex = i;
+        } else if (values[i] < values[minIndex]) {
+            minIndex = i;
+        } else if (values[i] > values[maxIndex]) {
+            maxIndex = i;
+        }
+    }
+    flush(minIndex, maxIndex);
+    emitIndex(last - 1);
+    return points;
+}
@@ -0,0 +1,30 @@
+/**
+ * @file decimation.h
+ * @brief Redukcja liczby punktów serii pomiarów do rozdzielczości wykresu.
+ */
+
+#ifndef DECIMATION_H
+#define DECIMATION_H
+
+#include <QList>
+#include <QPointF>
+#include "measurementseries.h"
+
+/**
+ * @brief Redukuje fragment serii do co najwyżej dwóch punktów (minimum i maksimum) na przedział.
+ *
+ * Zakres czasu fragmentu dzielony jest na @p buckets równych przedziałów (zwykle jeden na
+ * piksel szerokości wykresu). Z każdego przedziału zachowywane są punkty o najmniejszej
+ * i największej wartości, w kolejności czasu, a także pierwszy i ostatni punkt fragmentu.
+ * Dzięki temu wykres zachowuje wszystkie skoki wartości, a liczba punktów nie zależy
+ * od długości zakresu. Fragmenty nie dłuższe niż 2 * buckets zwracane są bez zmian.
+ *
+ * @param series Seria posortowana według czasu.
+ * @param first Indeks pierwszego punktu fragmentu.
+ * @param last Indeks za ostatnim punktem fragmentu.
+ * @param buckets Liczba przedziałów.
+ * @return Punkty (czas w milisekundach od epoki, wartość) gotowe dla QLineSeries::replace().
+ */
+QList<QPointF> decimateMinMax(const MeasurementSeries &series, int first, int last, int buckets);
+
+#endif // DECIMATION_H
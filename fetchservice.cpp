@@ -0,0 +1,269 @@
+/**
+ * @file fetchservice.cpp
+ * @brief Implementacja stałej puli wątków pobierających dane.
+ */
+#include "fetchservice.h"
+#include "networktransport.h"
+/**
+ * @brief Konstruktor klasy FetchService.
+ *
+ * Tworzy wątki robocze i dla każdego z nich menedżera sieci przeniesionego do tego wątku.
+ *
+ * @param threadCount Liczba wątków roboczych.
+ * @param queueCapacity Maksymalna liczba zadań oczekujących.
+ * @param parent Obiekt nadrzędny.
+ */
+FetchService::FetchService(int threadCount, int queueCapacity, QObject *parent)
+    : QObject(parent), queueCapacity(qMax(0, queueCapacity))
+{
+    lanes.resize(qMax(1, threadCount));
+    for (Lane &lane : lanes) {
+        lane.thread = new QThread(this);
+        lane.manager = new NetworkTransport;
+        lane.manager->moveToThread(lane.thread);
+        connect(lane.thread, &QThread::finished, lane.manager, &QObject::deleteLater);
+        lane.thread->start();
+    }
+}
+
+/**
+ * @brief Destruktor - usuwa zadania w ich wątkach, zatrzymuje wątki i usuwa niewykonane zadania.
+ *
+ * Trwające zadania należą do wątków roboczych, więc nie są usuwane z wątku usługi:
+ * po odłączeniu od usługi i anulowaniu dostają deleteLater, a wątek wykonuje to
+ * usunięcie przy zakończeniu (przed usunięciem menedżera sieci). Zadania oczekujące
+ * nie zostały jeszcze przeniesione do wątków, więc usuwane są bezpośrednio.
+ */
+FetchService::~FetchService()
+{
+    for (DataWorker *worker : std::as_const(runningWorkers)) {
+        disconnect(worker, nullptr, this, nullptr);
+        worker->cancellationToken().cancel();
+        worker->deleteLater();
+    }
+    runningWorkers.clear();
+    for (Lane &lane : lanes) {
+        lane.thread->quit();
+        lane.thread->wait();
+    }
+    qDeleteAll(queue);
+    qDeleteAll(backgroundQueue);
+    qDeleteAll(comparisonQueue);
+}
+
+/**
+ * @brief Dodaje zadanie do kolejki.
+ *
+ * Zadania zastępowane przez nowe zadanie tego samego widoku anulowane są przed
+ * sprawdzeniem pojemności kolejki, więc zwolnione przez nie miejsca są od razu dostępne.
+ * Zadania porównania oczekują we własnej kolejce o tej samej pojemności, więc pełna
+ * kolejka pozostałych zadań ich nie odrzuca.
+ *
+ * @param worker Zadanie do wykonania.
+ * @param priority Priorytet zadania.
+ * @param view Nazwa widoku, którego dotyczy zadanie; pusta - zadanie niezależne.
+ * @return false, jeśli kolejka jest pełna.
+ */
+bool FetchService::submit(DataWorker *worker, Priority priority, const QString &view)
+{
+    if (!view.isEmpty())
+        cancel(view);
+
+    const int queued = (priority == Comparison) ? comparisonQueue.size() : queue.size() + backgroundQueue.size();
+    if (freeLane(priority) < 0 && queued >= queueCapacity)
+        return false;
+
+    if (priority == Comparison)
+        comparisonQueue.enqueue(worker);
+    else if (priority == Background)
+        backgroundQueue.enqueue(worker);
+    else
+        queue.enqueue(worker);
+    if (!view.isEmpty())
+        views.insert(worker, view);
+    dispatch();
+    return true;
+}
+
+/**
+ * @brief Anuluje wszystkie zadania przypisane do widoku.
+ *
+ * Zadania oczekujące są usuwane z kolejki i anulowane od razu (działają jeszcze w wątku
+ * usługi). Zadaniom trwającym ustawiany jest znacznik anulowania, który zatrzymuje
+ * parsowanie przy najbliższym fragmencie odpowiedzi, a przerwanie zapytań zlecane jest
+ * w wątku zadania. Miejsce w wątku zwalniane jest po emisji DataWorker::cancelled.
+ *
+ * @param view Nazwa widoku.
+ * @return Liczba anulowanych zadań.
+ */
+int FetchService::cancel(const QString &view)
+{
+    int count = cancelQueued(queue, views, view) + cancelQueued(backgroundQueue, views, view)
+                + cancelQueued(comparisonQueue, views, view);
+    for (auto it = views.begin(); it != views.end();) {
+        if (it.value() != view) {
+            ++it;
+            continue;
+        }
+        DataWorker *worker = it.key();
+        if (runningWorkers.contains(worker)) {
+            worker->cancellationToken().cancel();
+            QMetaObject::invokeMethod(worker, [worker]() { worker->cancel(); }, Qt::QueuedConnection);
+            ++count;
+        }
+        it = views.erase(it);
+    }
+    return count;
+}
+
+/**
+ * @brief Usuwa z kolejki i anuluje oczekujące zadania widoku.
+ * @param queue Kolejka zadań.
+ * @param views Widoki przypisane zadaniom.
+ * @param view Nazwa widoku.
+ * @return Liczba anulowanych zadań.
+ */
+int FetchService::cancelQueued(QQueue<DataWorker *> &queue, const QHash<DataWorker *, QString> &views,
+                               const QString &view)
+{
+    int count = 0;
+    for (auto it = queue.begin(); it != queue.end();) {
+        DataWorker *worker = *it;
+        if (views.value(worker) != view) {
+            ++it;
+            continue;
+        }
+        it = queue.erase(it);
+        worker->cancel();
+        worker->deleteLater();
+        ++count;
+    }
+    return count;
+}
+
+/**
+ * @brief Ustawia liczbę zadań wykonywanych jednocześnie w jednym wątku.
+ *
+ * Zwiększenie limitu od razu uruchamia oczekujące zadania.
+ *
+ * @param count Liczba zadań.
+ */
+void FetchService::setJobsPerThread(int count)
+{
+    jobsPerThread = qMax(1, count);
+    dispatch();
+}
+
+/**
+ * @brief Zwraca liczbę zadań oczekujących w kolejce.
+ */
+int FetchService::queuedJobs() const
+{
+    return queue.size() + backgroundQueue.size() + comparisonQueue.size();
+}
+
+/**
+ * @brief Zwraca liczbę zadań w trakcie wykonywania.
+ */
+int FetchService::runningJobs() const
+{
+    return runningWorkers.size();
+}
+
+/**
+ * @brief Wybiera najmniej obciążony wątek, który może uruchomić kolejne zadanie.
+ *
+ * Zadania w tle mogą zająć w wątku co najwyżej jobsPerThread - 1 miejsc (lub jedno,
+ * jeśli limit wynosi 1). Zadania porównania nie zajmują miejsc wątku, ograniczone są
+ * tylko wspólną pulą ComparisonJobs. Obciążenie wątku to liczba wszystkich jego zadań.
+ *
+ * @param priority Priorytet zadania.
+ * @return Indeks wątku lub -1, jeśli żaden nie ma wolnego miejsca.
+ */
+int FetchService::freeLane(Priority priority) const
+{
+    if (priority == Comparison && runningComparison >= ComparisonJobs)
+        return -1;
+
+    const int backgroundLimit = qMax(1, jobsPerThread - 1);
+    int best = -1;
+    for (int i = 0; i < lanes.size(); ++i) {
+        const Lane &lane = lanes[i];
+        if (priority != Comparison
+            && (lane.running >= jobsPerThread || (priority == Background && lane.runningBackground >= backgroundLimit)))
+            continue;
+        if (best < 0 || lane.running + lane.runningComparison < lanes[best].running + lanes[best].runningComparison)
+            best = i;
+    }
+    return best;
+}
+
+/**
+ * @brief Uruchamia zadania z kolejek, dopóki któryś wątek ma wolne miejsce.
+ *
+ * Najpierw uruchamiane są zadania interaktywne, każde w najmniej obciążonym wątku.
+ */
+void FetchService::dispatch()
+{
+    int lane;
+    while (!queue.isEmpty() && (lane = freeLane(Interactive)) >= 0)
+        start(queue.dequeue(), lane, Interactive);
+    while (!comparisonQueue.isEmpty() && (lane = freeLane(Comparison)) >= 0)
+        start(comparisonQueue.dequeue(), lane, Comparison);
+    while (!backgroundQueue.isEmpty() && (lane = freeLane(Background)) >= 0)
+        start(backgroundQueue.dequeue(), lane, Background);
+}
+
+/**
+ * @brief Uruchamia zadanie w wątku roboczym.
+ * @param worker Zadanie.
+ * @param lane Indeks wątku.
+ * @param priority Priorytet zadania.
+ */
+void FetchService::start(DataWorker *worker, int lane, Priority priority)
+{
+    Lane &target = lanes[lane];
+    if (priority == Comparison) {
+        ++target.runningComparison;
+        ++runningComparison;
+    } else {
+        ++target.running;
+        if (priority == Background)
+            ++target.runningBackground;
+    }
+    runningWorkers.insert(worker);
+
+    connect(worker, &DataWorker::dataReady, this, [this, worker, lane, priority]() {
+        onJobFinished(worker, lane, priority);
+    });
+    connect(worker, &DataWorker::cancelled, this, [this, worker, lane, priority]() {
+        onJobFinished(worker, lane, priority);
+    });
+    worker->setNetworkManager(target.manager);
+    worker->moveToThread(target.thread);
+    QMetaObject::invokeMethod(worker, [worker]() { worker->start(); }, Qt::QueuedConnection);
+}
+
+/**
+ * @brief Usuwa zakończone zadanie i uruchamia kolejne z kolejki.
+ * @param worker Zakończone zadanie.
+ * @param lane Indeks wątku, w którym działało zadanie.
+ * @param priority Priorytet zadania.
+ */
+void FetchService::onJobFinished(DataWorker *worker, int lane, Priority priority)
+{
+    if (!runningWorkers.remove(worker))
+        return;
+    views.remove(worker);
+    Lane &target = lanes[lane];
+    if (priority == Comparison) {
+        --target.runningComparison;
+        --runningComparison;
+    } else {
+        --target.running;
+        if (priority == Background)
+            --target.runningBackground;
+    }
+    worker->deleteLater();
+    dispatch();
+}
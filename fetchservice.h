@@ -0,0 +1,147 @@
+/**
+ * @file fetchservice.h
+ * @brief Definicja klasy FetchService - stałej puli wątków pobierających dane.
+ */
+
+#ifndef FETCHSERVICE_H
+#define FETCHSERVICE_H
+
+#include <QObject>
+#include <QVector>
+#include <QQueue>
+#include <QSet>
+#include <QHash>
+#include <QThread>
+#include <QNetworkAccessManager>
+#include "dataworker.h"
+
+/**
+ * @class FetchService
+ * @brief Długo żyjąca usługa wykonująca zadania DataWorker na stałej liczbie wątków.
+ *
+ * Każdy wątek ma jednego menedżera sieci, używanego przez wszystkie zadania tego wątku,
+ * dzięki czemu połączenia HTTP, sesje TLS i wyniki DNS są wykorzystywane ponownie.
+ * Zadania czekają we wspólnej kolejce i uruchamiane są w najmniej obciążonym wątku
+ * z wolnym miejscem, więc wszystkie wątki pracują jednocześnie (wszystkie zadania
+ * pobierają dane z tego samego hosta API). Liczba zadań oczekujących w kolejce
+ * jest ograniczona.
+ *
+ * Zadania interaktywne (wykres zamówiony przez użytkownika) uruchamiane są przed zadaniami
+ * w tle, a zadania w tle nigdy nie zajmują wszystkich miejsc wątku, więc zadanie
+ * interaktywne nie czeka na zakończenie synchronizacji. Zadania zapytania porównawczego
+ * mają własną pulę ComparisonJobs miejsc, niezależną od limitu miejsc wątku, dzięki czemu
+ * wszystkie sensory porównania pobierane są jednocześnie i nie blokują innych zadań.
+ *
+ * Zadanie może być przypisane do widoku (np. wykresu w oknie głównym). Nowe zadanie
+ * tego samego widoku zastępuje poprzednie: oczekujące jest usuwane z kolejki, a trwające
+ * anulowane, dzięki czemu zwalnia miejsce w wątku bez pobierania pozostałych stron.
+ */
+class FetchService : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** @brief Domyślna liczba wątków. */
+    static const int DefaultThreadCount = 2;
+
+    /** @brief Domyślna liczba zadań wykonywanych jednocześnie w jednym wątku. */
+    static const int DefaultJobsPerThread = 2;
+
+    /** @brief Domyślna pojemność kolejki zadań oczekujących. */
+    static const int DefaultQueueCapacity = 8;
+
+    /** @brief Liczba zadań porównania wykonywanych jednocześnie (ComparisonQuery::MaxTargets). */
+    static const int ComparisonJobs = 8;
+
+    /**
+     * @enum Priority
+     * @brief Priorytet zadania.
+     */
+    enum Priority {
+        Interactive,    ///< Zadanie zamówione przez użytkownika.
+        Background,     ///< Zadanie synchronizacji w tle.
+        Comparison      ///< Zadanie zapytania porównawczego, z własną pulą ComparisonJobs miejsc.
+    };
+
+    /**
+     * @brief Konstruktor klasy FetchService.
+     * @param threadCount Liczba wątków roboczych.
+     * @param queueCapacity Maksymalna liczba zadań oczekujących.
+     * @param parent Obiekt nadrzędny.
+     */
+    explicit FetchService(int threadCount = DefaultThreadCount, int queueCapacity = DefaultQueueCapacity,
+                          QObject *parent = nullptr);
+
+    /**
+     * @brief Destruktor - usuwa zadania w ich wątkach, zatrzymuje wątki i usuwa niewykonane zadania.
+     */
+    ~FetchService();
+
+    /**
+     * @brief Dodaje zadanie do kolejki.
+     *
+     * Usługa przejmuje obiekt i usuwa go po emisji sygnału DataWorker::dataReady lub
+     * DataWorker::cancelled. Jeśli podano widok, wcześniejsze zadania tego widoku są anulowane.
+     *
+     * @param worker Zadanie do wykonania.
+     * @param priority Priorytet zadania.
+     * @param view Nazwa widoku, którego dotyczy zadanie; pusta - zadanie niezależne.
+     * @return false, jeśli kolejka jest pełna (obiekt pozostaje wtedy własnością wywołującego).
+     */
+    bool submit(DataWorker *worker, Priority priority = Interactive, const QString &view = QString());
+
+    /**
+     * @brief Anuluje wszystkie zadania przypisane do widoku.
+     *
+     * Zadania oczekujące emitują DataWorker::cancelled od razu, trwające - po przerwaniu
+     * zapytań w swoim wątku.
+     *
+     * @param view Nazwa widoku.
+     * @return Liczba anulowanych zadań.
+     */
+    int cancel(const QString &view);
+
+    /**
+     * @brief Ustawia liczbę zadań wykonywanych jednocześnie w jednym wątku.
+     * @param count Liczba zadań.
+     */
+    void setJobsPerThread(int count);
+
+    /** @brief Zwraca liczbę zadań oczekujących w kolejce. */
+    int queuedJobs() const;
+
+    /** @brief Zwraca liczbę zadań w trakcie wykonywania. */
+    int runningJobs() const;
+
+private:
+    /**
+     * @struct Lane
+     * @brief Wątek roboczy wraz z jego menedżerem sieci.
+     */
+    struct Lane {
+        QThread *thread = nullptr;
+        QNetworkAccessManager *manager = nullptr;
+        int running = 0;
+        int runningBackground = 0;
+        int runningComparison = 0;
+    };
+
+    int freeLane(Priority priority) const;
+    void dispatch();
+    void start(DataWorker *worker, int lane, Priority priority);
+    void onJobFinished(DataWorker *worker, int lane, Priority priority);
+    static int cancelQueued(QQueue<DataWorker *> &queue, const QHash<DataWorker *, QString> &views,
+                            const QString &view);
+
+    QVector<Lane> lanes;
+    QQueue<DataWorker *> queue;
+    QQueue<DataWorker *> backgroundQueue;
+    QQueue<DataWorker *> comparisonQueue;
+    QSet<DataWorker *> runningWorkers;
+    QHash<DataWorker *, QString> views;
+    int runningComparison = 0;
+    int queueCapacity;
+    int jobsPerThread = DefaultJobsPerThread;
+};
+
+#endif // FETCHSERVICE_H
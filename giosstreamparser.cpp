@@ -0,0 +1,384 @@
+/**
+ * @file giosstreamparser.cpp
+ * @brief Implementacja strumieniowego parsera odpowiedzi z danymi archiwalnymi.
+ */
+#include "giosstreamparser.h"
+#include <QDateTime>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace {
+
+const char ResultsKeyName[] = "Lista archiwalnych wyników pomiarów";
+const char DateKeyName[] = "Data";
+const char ValueKeyName[] = "Wartość";
+const qint64 UnixEpochJulianDay = 2440588;
+
+/**
+ * @brief Porównuje fragment bufora z napisem zakończonym zerem.
+ */
+bool equals(const char *data, int size, const char *text)
+{
+    const int length = int(std::strlen(text));
+    return size == length && std::memcmp(data, text, size_t(length)) == 0;
+}
+
+/**
+ * @brief Odczytuje cztery cyfry szesnastkowe sekwencji \\uXXXX.
+ * @return Kod znaku lub -1, jeśli cyfry są niepoprawne.
+ */
+int parseHex4(const char *data)
+{
+    int code = 0;
+    for (int i = 0; i < 4; ++i) {
+        const char c = data[i];
+        code <<= 4;
+        if (c >= '0' && c <= '9')
+            code |= c - '0';
+        else if (c >= 'a' && c <= 'f')
+            code |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            code |= c - 'A' + 10;
+        else
+            return -1;
+    }
+    return code;
+}
+
+/**
+ * @brief Dopisuje znak Unicode do bufora w kodowaniu UTF-8.
+ */
+void appendUtf8(QByteArray &out, uint code)
+{
+    if (code < 0x80) {
+        out.append(char(code));
+    } else if (code < 0x800) {
+        out.append(char(0xC0 | (code >> 6)));
+        out.append(char(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+        out.append(char(0xE0 | (code >> 12)));
+        out.append(char(0x80 | ((code >> 6) & 0x3F)));
+        out.append(char(0x80 | (code & 0x3F)));
+    } else {
+        out.append(char(0xF0 | (code >> 18)));
+        out.append(char(0x80 | ((code >> 12) & 0x3F)));
+        out.append(char(0x80 | ((code >> 6) & 0x3F)));
+        out.append(char(0x80 | (code & 0x3F)));
+    }
+}
+
+/**
+ * @brief Zamienia sekwencje ucieczki napisu JSON na bajty UTF-8.
+ * @param data Zawartość napisu bez cudzysłowów.
+ * @param size Długość napisu.
+ */
+QByteArray decodeString(const char *data, int size)
+{
+    QByteArray out;
+    out.reserve(size);
+    for (int i = 0; i < size; ++i) {
+        if (data[i] != '\\' || i + 1 >= size) {
+            out.append(data[i]);
+            continue;
+        }
+        const char escape = data[++i];
+        switch (escape) {
+        case 'b': out.append('\b'); break;
+        case 'f': out.append('\f'); break;
+        case 'n': out.append('\n'); break;
+        case 'r': out.append('\r'); break;
+        case 't': out.append('\t'); break;
+        case 'u': {
+            if (i + 4 >= size)
+                return out;
+            int code = parseHex4(data + i + 1);
+            i += 4;
+            if (code < 0)
+                continue;
+            if (code >= 0xD800 && code < 0xDC00 && i + 6 < size && data[i + 1] == '\\' && data[i + 2] == 'u') {
+                const int low = parseHex4(data + i + 3);
+                if (low >= 0xDC00 && low < 0xE000) {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    i += 6;
+                }
+            }
+            appendUtf8(out, uint(code));
+            break;
+        }
+        default:
+            out.append(escape);
+            break;
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Sprawdza, czy znak jest białym znakiem JSON.
+ */
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+} // namespace
+
+/**
+ * @brief Dekoduje czas lokalny w stałym formacie "yyyy-MM-dd HH:mm:ss".
+ *
+ * Zastępuje QDateTime::fromString z napisem formatu - pola odczytywane są bezpośrednio
+ * ze stałych pozycji. Przesunięcie strefy czasowej wyznaczane jest raz na dobę; tylko
+ * w dniach zmiany czasu każdy pomiar przeliczany jest przez QDateTime.
+ *
+ * @param data Wskaźnik na pierwszy znak napisu.
+ * @param size Długość napisu.
+ * @param msecs Wynik w milisekundach od epoki UTC.
+ * @return true, jeśli napis pasuje do formatu.
+ */
+bool parseGiosTimestamp(const char *data, int size, qint64 &msecs)
+{
+    if (size != 19 || data[4] != '-' || data[7] != '-' || data[10] != ' ' || data[13] != ':' || data[16] != ':')
+        return false;
+
+    static const int positions[6] = { 0, 5, 8, 11, 14, 17 };
+    static const int lengths[6] = { 4, 2, 2, 2, 2, 2 };
+    int fields[6];
+
+    for (int f = 0; f < 6; ++f) {
+        int value = 0;
+        for (int k = 0; k < lengths[f]; ++k) {
+            const char c = data[positions[f] + k];
+            if (c < '0' || c > '9')
+                return false;
+            value = value * 10 + (c - '0');
+        }
+        fields[f] = value;
+    }
+
+    const QDate date(fields[0], fields[1], fields[2]);
+    const QTime time(fields[3], fields[4], fields[5]);
+    if (!date.isValid() || !time.isValid())
+        return false;
+
+    static thread_local qint64 cachedDay = std::numeric_limits<qint64>::min();
+    static thread_local int cachedOffset = 0;
+    static thread_local bool cachedUniform = false;
+
+    const qint64 day = date.toJulianDay();
+    if (day != cachedDay) {
+        const int startOffset = QDateTime(date, QTime(0, 0)).offsetFromUtc();
+        const int endOffset = QDateTime(date, QTime(23, 59, 59)).offsetFromUtc();
+        cachedDay = day;
+        cachedOffset = startOffset;
+        cachedUniform = startOffset == endOffset;
+    }
+
+    if (!cachedUniform) {
+        msecs = QDateTime(date, time).toMSecsSinceEpoch();
+        return true;
+    }
+
+    const qint64 seconds = (day - UnixEpochJulianDay) * 86400 + fields[3] * 3600 + fields[4] * 60 + fields[5];
+    msecs = (seconds - cachedOffset) * 1000;
+    return true;
+}
+
+/**
+ * @brief Przetwarza kolejny fragment odpowiedzi.
+ *
+ * Przetwarzane są wszystkie kompletne elementy fragmentu. Niedokończony napis lub liczba
+ * na końcu fragmentu zostają w buforze do czasu nadejścia kolejnych danych.
+ *
+ * @param chunk Fragment danych odebranych z sieci.
+ */
+void GiosStreamParser::feed(const QByteArray &chunk)
+{
+    if (failed)
+        return;
+
+    buffer.append(chunk);
+    const char *data = buffer.constData();
+    const int size = buffer.size();
+    int index = 0;
+
+    while (index < size && !failed) {
+        const char c = data[index];
+        if (isSpace(c)) {
+            ++index;
+        } else if (done) {
+            failed = true;
+        } else if (c == '{') {
+            const bool record = !stack.isEmpty() && stack.last().results;
+            stack.append({ true, false, record });
+            expectKey = true;
+            if (record) {
+                hasRecordTime = false;
+                recordValue = 0;
+            }
+            ++index;
+        } else if (c == '[') {
+            const bool results = stack.size() == 1 && stack.last().object && currentKey == ResultsKey;
+            stack.append({ false, results, false });
+            ++index;
+        } else if (c == '}' || c == ']') {
+            if (stack.isEmpty() || stack.last().object != (c == '}')) {
+                failed = true;
+                break;
+            }
+            if (stack.last().record && hasRecordTime)
+                series.append(recordTime, recordValue);
+            stack.removeLast();
+            expectKey = false;
+            done = stack.isEmpty();
+            ++index;
+        } else if (c == ',') {
+            expectKey = !stack.isEmpty() && stack.last().object;
+            ++index;
+        } else if (c == ':') {
+            expectKey = false;
+            ++index;
+        } else if (c == '"') {
+            int begin, length;
+            bool escaped;
+            if (!scanString(data, size, index, begin, length, escaped))
+                break;
+            onString(data + begin, length, escaped);
+        } else {
+            int begin, length;
+            if (!scanLiteral(data, size, index, begin, length))
+                break;
+            onLiteral(data + begin, length);
+        }
+    }
+
+    buffer.remove(0, index);
+}
+
+/**
+ * @brief Kończy przetwarzanie odpowiedzi.
+ * @return true, jeśli odpowiedź była kompletnym i poprawnym dokumentem JSON.
+ */
+bool GiosStreamParser::finish()
+{
+    for (char c : std::as_const(buffer)) {
+        if (!isSpace(c))
+            failed = true;
+    }
+    return done && !failed;
+}
+
+/**
+ * @brief Zwraca odczytane dotąd pomiary i czyści wewnętrzną serię.
+ * @return Seria pomiarów w kolejności z odpowiedzi.
+ */
+MeasurementSeries GiosStreamParser::takeSeries()
+{
+    MeasurementSeries result = std::move(series);
+    series.clear();
+    return result;
+}
+
+/**
+ * @brief Przywraca parser do stanu początkowego.
+ */
+void GiosStreamParser::reset()
+{
+    buffer.clear();
+    stack.clear();
+    series.clear();
+    currentKey = OtherKey;
+    expectKey = false;
+    done = false;
+    failed = false;
+    recordTime = 0;
+    hasRecordTime = false;
+    recordValue = 0;
+}
+
+/**
+ * @brief Wyszukuje koniec napisu zaczynającego się na pozycji index.
+ * @return false, jeśli napis nie mieści się jeszcze w buforze.
+ */
+bool GiosStreamParser::scanString(const char *data, int size, int &index, int &begin, int &length, bool &escaped) const
+{
+    escaped = false;
+    for (int i = index + 1; i < size; ++i) {
+        if (data[i] == '\\') {
+            escaped = true;
+            ++i;
+        } else if (data[i] == '"') {
+            begin = index + 1;
+            length = i - begin;
+            index = i + 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Wyszukuje koniec liczby lub literału (true, false, null) zaczynającego się na pozycji index.
+ * @return false, jeśli literał nie jest jeszcze zakończony w buforze.
+ */
+bool GiosStreamParser::scanLiteral(const char *data, int size, int &index, int &begin, int &length) const
+{
+    for (int i = index; i < size; ++i) {
+        const char c = data[i];
+        if (c == ',' || c == '}' || c == ']' || isSpace(c)) {
+            begin = index;
+            length = i - index;
+            index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Obsługuje napis będący kluczem lub wartością.
+ */
+void GiosStreamParser::onString(const char *data, int length, bool escaped)
+{
+    QByteArray decoded;
+    if (escaped) {
+        decoded = decodeString(data, length);
+        data = decoded.constData();
+        length = decoded.size();
+    }
+
+    if (expectKey) {
+        expectKey = false;
+        if (equals(data, length, ResultsKeyName))
+            currentKey = ResultsKey;
+        else if (equals(data, length, DateKeyName))
+            currentKey = DateKey;
+        else if (equals(data, length, ValueKeyName))
+            currentKey = ValueKey;
+        else
+            currentKey = OtherKey;
+    } else if (!stack.isEmpty() && stack.last().record && currentKey == DateKey) {
+        hasRecordTime = parseGiosTimestamp(data, length, recordTime);
+    }
+}
+
+/**
+ * @brief Obsługuje liczbę lub literał. Wartość null traktowana jest jak 0, tak jak w QJsonValue::toDouble().
+ */
+void GiosStreamParser::onLiteral(const char *data, int length)
+{
+    if (equals(data, length, "null") || equals(data, length, "true") || equals(data, length, "false")) {
+        if (!stack.isEmpty() && stack.last().record && currentKey == ValueKey)
+            recordValue = 0;
+        return;
+    }
+
+    bool ok = false;
+    const double value = QByteArray::fromRawData(data, length).toDouble(&ok);
+    if (!ok) {
+        failed = true;
+        return;
+    }
+    if (!stack.isEmpty() && stack.last().record && currentKey == ValueKey)
+        recordValue = value;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file giosstreamparser.h
+ * @brief Definicja klasy GiosStreamParser - strumieniowego parsera odpowiedzi z danymi archiwalnymi.
+ */
+
+#ifndef GIOSSTREAMPARSER_H
+#define GIOSSTREAMPARSER_H
+
+#include <QByteArray>
+#include <QVector>
+#include "measurementseries.h"
+
+/**
+ * @brief Dekoduje czas lokalny w stałym formacie "yyyy-MM-dd HH:mm:ss".
+ * @param data Wskaźnik na pierwszy znak napisu.
+ * @param size Długość napisu.
+ * @param msecs Wynik w milisekundach od epoki UTC.
+ * @return true, jeśli napis pasuje do formatu.
+ */
+bool parseGiosTimestamp(const char *data, int size, qint64 &msecs);
+
+/**
+ * @class GiosStreamParser
+ * @brief Przyrostowy parser odpowiedzi archivalData/getDataBySensor.
+ *
+ * Przetwarza kolejne fragmenty odpowiedzi w miarę ich nadejścia, bez budowania drzewa
+ * QJsonDocument. Z tablicy "Lista archiwalnych wyników pomiarów" odczytywane są jedynie
+ * pola "Data" i "Wartość" każdego rekordu, które trafiają od razu do serii MeasurementSeries.
+ */
+class GiosStreamParser
+{
+public:
+    /**
+     * @brief Przetwarza kolejny fragment odpowiedzi.
+     * @param chunk Fragment danych odebranych z sieci.
+     */
+    void feed(const QByteArray &chunk);
+
+    /**
+     * @brief Kończy przetwarzanie odpowiedzi.
+     * @return true, jeśli odpowiedź była kompletnym i poprawnym dokumentem JSON.
+     */
+    bool finish();
+
+    /**
+     * @brief Zwraca odczytane dotąd pomiary i czyści wewnętrzną serię.
+     * @return Seria pomiarów w kolejności z odpowiedzi.
+     */
+    MeasurementSeries takeSeries();
+
+    /** @brief Przywraca parser do stanu początkowego. */
+    void reset();
+
+private:
+    /**
+     * @struct Frame
+     * @brief Otwarty obiekt lub tablica JSON.
+     */
+    struct Frame {
+        bool object;
+        bool results;
+        bool record;
+    };
+
+    /** @brief Klucze istotne dla parsera. */
+    enum Key { OtherKey, ResultsKey, DateKey, ValueKey };
+
+    bool scanString(const char *data, int size, int &index, int &begin, int &length, bool &escaped) const;
+    bool scanLiteral(const char *data, int size, int &index, int &begin, int &length) const;
+    void onString(const char *data, int length, bool escaped);
+    void onLiteral(const char *data, int length);
+
+    QByteArray buffer;
+    QVector<Frame> stack;
+    MeasurementSeries series;
+    Key currentKey = OtherKey;
+    bool expectKey = false;
+    bool done = false;
+    bool failed = false;
+
+    qint64 recordTime = 0;
+    bool hasRecordTime = false;
+    double recordValue = 0;
+};
+
+#endif // GIOSSTREAMPARSER_H
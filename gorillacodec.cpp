@@ -0,0 +1,278 @@
+/**
+ * @file gorillacodec.cpp
+ * @brief Implementacja kompresji bloków pomiarów metodą Gorilla.
+ */
+#include "gorillacodec.h"
+#include <cstring>
+
+namespace {
+
+/**
+ * @class BitWriter
+ * @brief Zapisuje ciąg bitów (od najstarszego) do tablicy bajtów.
+ */
+class BitWriter
+{
+public:
+    explicit BitWriter(QByteArray &out) : out(out) {}
+
+    /** @brief Zapisuje @p count najmłodszych bitów wartości (1-64). */
+    void write(quint64 bits, int count)
+    {
+        while (count > 0) {
+            const int n = qMin(count, 64 - used);
+            const quint64 chunk = (bits >> (count - n)) & mask(n);
+            word = n == 64 ? chunk : (word << n) | chunk;
+            used += n;
+            count -= n;
+            if (used == 64) {
+                flushBytes(8);
+                word = 0;
+                used = 0;
+            }
+        }
+    }
+
+    /** @brief Zapisuje pozostałe bity, dopełniając ostatni bajt zerami. */
+    void finish()
+    {
+        if (used == 0)
+            return;
+        word <<= 64 - used;
+        flushBytes((used + 7) / 8);
+        word = 0;
+        used = 0;
+    }
+
+private:
+    static quint64 mask(int n) { return n == 64 ? ~quint64(0) : (quint64(1) << n) - 1; }
+
+    void flushBytes(int bytes)
+    {
+        for (int i = 0; i < bytes; ++i)
+            out.append(char(word >> (56 - 8 * i)));
+    }
+
+    QByteArray &out;
+    quint64 word = 0;
+    int used = 0;
+};
+
+/**
+ * @class BitReader
+ * @brief Odczytuje ciąg bitów zapisany przez BitWriter.
+ */
+class BitReader
+{
+public:
+    BitReader(const char *data, qint64 size)
+        : data(reinterpret_cast<const uchar *>(data)), bitCount(size * 8) {}
+
+    /** @brief Odczytuje @p count bitów (1-64); po przekroczeniu danych ustawia flagę błędu. */
+    quint64 read(int count)
+    {
+        if (position + count > bitCount) {
+            failed = true;
+            return 0;
+        }
+        quint64 result = 0;
+        while (count > 0) {
+            const int offset = int(position & 7);
+            const int n = qMin(count, 8 - offset);
+            const quint64 bits = (data[position >> 3] >> (8 - offset - n)) & ((1u << n) - 1);
+            result = (result << n) | bits;
+            position += n;
+            count -= n;
+        }
+        return result;
+    }
+
+    bool readBit() { return read(1) != 0; }
+
+    bool failed = false;
+
+private:
+    const uchar *data;
+    qint64 bitCount;
+    qint64 position = 0;
+};
+
+/** @brief Przedziały różnic drugiego rzędu: liczba bitów wartości dla prefiksów 10, 110 i 1110. */
+const int DeltaBits[] = { 7, 9, 12 };
+
+/** @brief Rozszerza znak liczby zapisanej na @p bits bitach. */
+qint64 signExtend(quint64 value, int bits)
+{
+    const quint64 sign = quint64(1) << (bits - 1);
+    return qint64((value ^ sign) - sign);
+}
+
+int leadingZeros(quint64 value)
+{
+    int n = 0;
+    for (quint64 bit = quint64(1) << 63; bit && !(value & bit); bit >>= 1)
+        ++n;
+    return n;
+}
+
+int trailingZeros(quint64 value)
+{
+    int n = 0;
+    for (quint64 bit = 1; bit && !(value & bit); bit <<= 1)
+        ++n;
+    return n;
+}
+
+quint64 toBits(double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double fromBits(quint64 bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+}
+
+/**
+ * @brief Kompresuje posortowany fragment serii.
+ *
+ * Pierwszy pomiar zapisywany jest w całości. Dla kolejnych różnica drugiego rzędu czasu D
+ * kodowana jest jako: 0 (D = 0), 10 + 7 bitów, 110 + 9 bitów, 1110 + 12 bitów albo
+ * 1111 + 64 bity. Wartość: 0 (bez zmiany), 10 + bity znaczące w poprzednim oknie
+ * albo 11 + 5 bitów liczby wiodących zer + 6 bitów długości + bity znaczące.
+ *
+ * @param timestamps Znaczniki czasu.
+ * @param values Wartości.
+ * @param count Liczba pomiarów.
+ * @return Skompresowane dane.
+ */
+QByteArray gorillaEncode(const qint64 *timestamps, const double *values, int count)
+{
+    QByteArray out;
+    if (count <= 0)
+        return out;
+    out.reserve(16 + count * 2);
+    BitWriter writer(out);
+
+    writer.write(quint64(timestamps[0]), 64);
+    writer.write(toBits(values[0]), 64);
+
+    qint64 previousTimestamp = timestamps[0];
+    qint64 previousDelta = 0;
+    quint64 previousValue = toBits(values[0]);
+    int previousLeading = -1;
+    int previousTrailing = 0;
+
+    for (int i = 1; i < count; ++i) {
+        const qint64 delta = timestamps[i] - previousTimestamp;
+        const qint64 deltaOfDelta = delta - previousDelta;
+        previousTimestamp = timestamps[i];
+        previousDelta = delta;
+
+        if (deltaOfDelta == 0) {
+            writer.write(0, 1);
+        } else {
+            int prefix = 0;
+            while (prefix < 3) {
+                const qint64 limit = qint64(1) << (DeltaBits[prefix] - 1);
+                if (deltaOfDelta >= -limit && deltaOfDelta < limit)
+                    break;
+                ++prefix;
+            }
+            if (prefix < 3) {
+                writer.write((quint64(1) << (prefix + 2)) - 2, prefix + 2);
+                writer.write(quint64(deltaOfDelta), DeltaBits[prefix]);
+            } else {
+                writer.write(0xF, 4);
+                writer.write(quint64(deltaOfDelta), 64);
+            }
+        }
+
+        const quint64 value = toBits(values[i]);
+        const quint64 xored = value ^ previousValue;
+        previousValue = value;
+        if (xored == 0) {
+            writer.write(0, 1);
+            continue;
+        }
+
+        const int leading = qMin(leadingZeros(xored), 31);
+        const int trailing = trailingZeros(xored);
+        if (previousLeading >= 0 && leading >= previousLeading && trailing >= previousTrailing) {
+            writer.write(0x2, 2);
+            writer.write(xored >> previousTrailing, 64 - previousLeading - previousTrailing);
+        } else {
+            const int length = 64 - leading - trailing;
+            writer.write(0x3, 2);
+            writer.write(quint64(leading), 5);
+            writer.write(quint64(length & 63), 6);
+            writer.write(xored >> trailing, length);
+            previousLeading = leading;
+            previousTrailing = trailing;
+        }
+    }
+    writer.finish();
+    return out;
+}
+
+/**
+ * @brief Dekompresuje blok, dopisując do serii pomiary z przedziału [from, to].
+ * @param data Skompresowane dane.
+ * @param size Rozmiar danych w bajtach.
+ * @param count Liczba pomiarów zapisanych w bloku.
+ * @param from Początek przedziału.
+ * @param to Koniec przedziału.
+ * @param series Seria, do której trafią pomiary.
+ * @return false, jeśli dane są uszkodzone.
+ */
+bool gorillaDecode(const char *data, qint64 size, int count, qint64 from, qint64 to, MeasurementSeries &series)
+{
+    if (count <= 0)
+        return true;
+    BitReader reader(data, size);
+
+    qint64 timestamp = qint64(reader.read(64));
+    quint64 value = reader.read(64);
+    if (reader.failed)
+        return false;
+    if (timestamp >= from && timestamp <= to)
+        series.append(timestamp, fromBits(value));
+
+    qint64 delta = 0;
+    int leading = 0;
+    int trailing = 0;
+    for (int i = 1; i < count && timestamp <= to; ++i) {
+        int prefix = 0;
+        while (prefix < 4 && reader.readBit())
+            ++prefix;
+        if (prefix == 4)
+            delta += qint64(reader.read(64));
+        else if (prefix > 0)
+            delta += signExtend(reader.read(DeltaBits[prefix - 1]), DeltaBits[prefix - 1]);
+        timestamp += delta;
+
+        if (reader.readBit()) {
+            if (reader.readBit()) {
+                leading = int(reader.read(5));
+                int length = int(reader.read(6));
+                if (length == 0)
+                    length = 64;
+                trailing = 64 - leading - length;
+                if (trailing < 0)
+                    return false;
+            }
+            value ^= reader.read(64 - leading - trailing) << trailing;
+        }
+        if (reader.failed)
+            return false;
+        if (timestamp >= from && timestamp <= to)
+            series.append(timestamp, fromBits(value));
+    }
+    return true;
+}
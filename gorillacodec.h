@@ -0,0 +1,41 @@
+/**
+ * @file gorillacodec.h
+ * @brief Kompresja bloków pomiarów metodą Gorilla (delta-of-delta i XOR).
+ */
+
+#ifndef GORILLACODEC_H
+#define GORILLACODEC_H
+
+#include <QByteArray>
+#include "measurementseries.h"
+
+/**
+ * @brief Kompresuje posortowany fragment serii.
+ *
+ * Znaczniki czasu kodowane są jako różnice drugiego rzędu (dla pomiarów godzinowych
+ * zwykle jeden bit na pomiar), a wartości jako XOR z poprzednią wartością, z zapisem
+ * jedynie znaczących bitów (format Gorilla, Pelkonen i in., VLDB 2015).
+ *
+ * @param timestamps Znaczniki czasu (niemalejące).
+ * @param values Wartości.
+ * @param count Liczba pomiarów.
+ * @return Skompresowane dane.
+ */
+QByteArray gorillaEncode(const qint64 *timestamps, const double *values, int count);
+
+/**
+ * @brief Dekompresuje blok, dopisując do serii pomiary z przedziału [from, to].
+ *
+ * Pomiary trafiają bezpośrednio do kolumn serii, bez buforów pośrednich.
+ *
+ * @param data Skompresowane dane.
+ * @param size Rozmiar danych w bajtach.
+ * @param count Liczba pomiarów zapisanych w bloku.
+ * @param from Początek przedziału w milisekundach od epoki.
+ * @param to Koniec przedziału w milisekundach od epoki.
+ * @param series Seria, do której trafią pomiary.
+ * @return false, jeśli dane są uszkodzone.
+ */
+bool gorillaDecode(const char *data, qint64 size, int count, qint64 from, qint64 to, MeasurementSeries &series);
+
+#endif // GORILLACODEC_H
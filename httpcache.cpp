@@ -0,0 +1,131 @@
+/**
+ * @file httpcache.cpp
+ * @brief Implementacja dyskowej pamięci podręcznej odpowiedzi HTTP.
+ */
+#include "httpcache.h"
+#include <QNetworkRequest>
+#include <QDateTime>
+
+namespace {
+
+/** @brief Atrybut metadanych przechowujący czas ostatniego użycia wpisu. */
+const QNetworkRequest::Attribute LastUsedAttribute = QNetworkRequest::User;
+
+}
+
+/**
+ * @brief Konstruktor klasy HttpCache.
+ * @param directory Katalog z plikami pamięci podręcznej.
+ * @param parent Obiekt nadrzędny.
+ */
+HttpCache::HttpCache(const QString &directory, QObject *parent)
+    : QNetworkDiskCache(parent)
+{
+    setCacheDirectory(directory);
+    setMaximumCacheSize(DefaultMaximumSize);
+}
+
+/**
+ * @brief Ustawia czas ważności odpowiedzi dla endpointu.
+ * @param pathPrefix Początek ścieżki adresu URL endpointu.
+ * @param seconds Czas ważności w sekundach.
+ */
+void HttpCache::setTimeToLive(const QString &pathPrefix, int seconds)
+{
+    for (QPair<QString, int> &entry : timesToLive) {
+        if (entry.first == pathPrefix) {
+            entry.second = seconds;
+            return;
+        }
+    }
+    timesToLive.append({ pathPrefix, seconds });
+}
+
+/**
+ * @brief Zwraca czas ważności odpowiedzi dla adresu.
+ *
+ * Przy kilku pasujących prefiksach wybierany jest najdłuższy.
+ *
+ * @param url Adres zapytania.
+ * @return Czas ważności w sekundach lub -1.
+ */
+int HttpCache::timeToLive(const QUrl &url) const
+{
+    const QString path = url.path();
+    int seconds = -1;
+    int matchedLength = -1;
+    for (const QPair<QString, int> &entry : timesToLive) {
+        if (entry.first.size() > matchedLength && path.startsWith(entry.first)) {
+            seconds = entry.second;
+            matchedLength = entry.first.size();
+        }
+    }
+    return seconds;
+}
+
+/**
+ * @brief Sprawdza, czy zapisana odpowiedź może zostać użyta bez kontaktu z serwerem.
+ * @param url Adres zapytania.
+ * @return true, jeśli wpis istnieje i nie upłynął jeszcze jego czas ważności.
+ */
+bool HttpCache::isFresh(const QUrl &url)
+{
+    if (timeToLive(url) < 0)
+        return false;
+    const QNetworkCacheMetaData meta = metaData(url);
+    return meta.isValid() && meta.expirationDate().isValid()
+           && QDateTime::currentDateTimeUtc() < meta.expirationDate();
+}
+
+/**
+ * @brief Zapisuje czas użycia wpisu.
+ *
+ * QNetworkDiskCache usuwa najpierw najstarsze pliki, a zapis metadanych tworzy plik wpisu
+ * od nowa, więc odświeżenie czasu użycia przesuwa wpis na koniec kolejki usuwania.
+ * Aby nie przepisywać pliku przy każdym trafieniu, zapis wykonywany jest co najwyżej
+ * raz na TouchIntervalSecs.
+ *
+ * @param url Adres zapytania.
+ */
+void HttpCache::touch(const QUrl &url)
+{
+    QNetworkCacheMetaData meta = metaData(url);
+    if (!meta.isValid())
+        return;
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    QNetworkCacheMetaData::AttributesMap attributes = meta.attributes();
+    const QDateTime lastUsed = attributes.value(LastUsedAttribute).toDateTime();
+    if (lastUsed.isValid() && lastUsed.secsTo(now) < TouchIntervalSecs)
+        return;
+
+    attributes.insert(LastUsedAttribute, now);
+    meta.setAttributes(attributes);
+    preserveExpiration = true;
+    updateMetaData(meta);
+    preserveExpiration = false;
+}
+
+/**
+ * @brief Przygotowuje zapis odpowiedzi.
+ *
+ * Dla endpointów z ustawionym czasem ważności data wygaśnięcia liczona jest od chwili
+ * zapisu. Dotyczy to również odpowiedzi 304, po której Qt zapisuje zaktualizowane metadane.
+ *
+ * @param metaData Metadane odpowiedzi.
+ * @return Urządzenie, do którego zapisywana jest treść odpowiedzi.
+ */
+QIODevice *HttpCache::prepare(const QNetworkCacheMetaData &metaData)
+{
+    const int seconds = timeToLive(metaData.url());
+    if (seconds < 0 || preserveExpiration)
+        return QNetworkDiskCache::prepare(metaData);
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    QNetworkCacheMetaData stamped(metaData);
+    stamped.setExpirationDate(now.addSecs(seconds));
+    QNetworkCacheMetaData::AttributesMap attributes = stamped.attributes();
+    attributes.insert(LastUsedAttribute, now);
+    stamped.setAttributes(attributes);
+    return QNetworkDiskCache::prepare(stamped);
+}
@@ -0,0 +1,102 @@
+/**
+ * @file httpcache.h
+ * @brief Definicja klasy HttpCache - dyskowej pamięci podręcznej odpowiedzi HTTP.
+ */
+
+#ifndef HTTPCACHE_H
+#define HTTPCACHE_H
+
+#include <QNetworkDiskCache>
+#include <QNetworkCacheMetaData>
+#include <QVector>
+#include <QPair>
+#include <QUrl>
+
+/**
+ * @class HttpCache
+ * @brief Pamięć podręczna odpowiedzi HTTP z czasem ważności ustalanym dla każdego endpointu.
+ *
+ * Odpowiedź endpointu z ustawionym czasem ważności (TTL) jest traktowana jako aktualna
+ * przez podany czas, niezależnie od nagłówków serwera. Po jego upływie zapytanie jest
+ * wysyłane warunkowo (If-None-Match / If-Modified-Since), a odpowiedź 304 odświeża wpis
+ * bez ponownego pobierania treści. Rozmiar katalogu jest ograniczony; po jego przekroczeniu
+ * usuwane są najdawniej używane wpisy.
+ */
+class HttpCache : public QNetworkDiskCache
+{
+    Q_OBJECT
+
+public:
+    /** @brief Domyślny maksymalny rozmiar pamięci podręcznej w bajtach. */
+    static const qint64 DefaultMaximumSize = 8 * 1024 * 1024;
+
+    /** @brief Minimalny odstęp (w sekundach) między kolejnymi zapisami czasu użycia wpisu. */
+    static const int TouchIntervalSecs = 10 * 60;
+
+    /**
+     * @brief Konstruktor klasy HttpCache.
+     * @param directory Katalog z plikami pamięci podręcznej.
+     * @param parent Obiekt nadrzędny.
+     */
+    explicit HttpCache(const QString &directory, QObject *parent = nullptr);
+
+    /**
+     * @brief Ustawia czas ważności odpowiedzi dla endpointu.
+     * @param pathPrefix Początek ścieżki adresu URL endpointu.
+     * @param seconds Czas ważności w sekundach.
+     */
+    void setTimeToLive(const QString &pathPrefix, int seconds);
+
+    /**
+     * @brief Zwraca czas ważności odpowiedzi dla adresu.
+     * @param url Adres zapytania.
+     * @return Czas ważności w sekundach lub -1, jeśli endpoint nie ma ustawionego czasu.
+     */
+    int timeToLive(const QUrl &url) const;
+
+    /**
+     * @brief Sprawdza, czy zapisana odpowiedź może zostać użyta bez kontaktu z serwerem.
+     * @param url Adres zapytania.
+     */
+    bool isFresh(const QUrl &url);
+
+    /**
+     * @brief Zapisuje czas użycia wpisu, od którego zależy kolejność usuwania.
+     * @param url Adres zapytania.
+     */
+    void touch(const QUrl &url);
+
+    /** @brief Zlicza odpowiedź obsłużoną z pamięci podręcznej bez zapytania do serwera. */
+    void recordHit() { ++hitCount; }
+
+    /** @brief Zlicza odpowiedź potwierdzoną przez serwer zapytaniem warunkowym (304). */
+    void recordRevalidation() { ++revalidationCount; }
+
+    /** @brief Zlicza odpowiedź pobraną w całości z serwera. */
+    void recordMiss() { ++missCount; }
+
+    /** @brief Zwraca liczbę trafień bez zapytania do serwera. */
+    int hits() const { return hitCount; }
+
+    /** @brief Zwraca liczbę trafień potwierdzonych zapytaniem warunkowym. */
+    int revalidations() const { return revalidationCount; }
+
+    /** @brief Zwraca liczbę odpowiedzi pobranych z serwera. */
+    int misses() const { return missCount; }
+
+    /**
+     * @brief Przygotowuje zapis odpowiedzi, ustawiając jej datę wygaśnięcia według TTL endpointu.
+     * @param metaData Metadane odpowiedzi.
+     * @return Urządzenie, do którego zapisywana jest treść odpowiedzi.
+     */
+    QIODevice *prepare(const QNetworkCacheMetaData &metaData) override;
+
+private:
+    QVector<QPair<QString, int>> timesToLive;
+    bool preserveExpiration = false;
+    int hitCount = 0;
+    int revalidationCount = 0;
+    int missCount = 0;
+};
+
+#endif // HTTPCACHE_H
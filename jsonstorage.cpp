@@ -2,11 +2,38 @@
  * @file jsonstorage.cpp
  */
 #include "jsonstorage.h"
-#include "dataworker.h"
+#include "measurementstore.h"
+#include "rollupstore.h"
+#include "tracing.h"
 #include <QDir>
 #include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRecursiveMutex>
+#include <QSaveFile>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QSet>
+/**
+ * @brief Zwraca blokadę plików sensora.
+ *
+ * Zapis odbywa się w wątku MeasurementWriter, a odczyt w wątku interfejsu, więc operacje
+ * na plikach jednego sensora są wzajemnie wykluczane. Blokada jest rekurencyjna, bo
+ * funkcje zapisu wywołują funkcje odczytu.
+ *
+ * @param stationId ID stacji.
+ * @param sensorId ID sensora.
+ */
+static QRecursiveMutex &sensorMutex(int stationId, int sensorId) {
+    static QMutex mutex;
+    static QHash<QPair<int, int>, QRecursiveMutex *> mutexes;
+    QMutexLocker locker(&mutex);
+    QRecursiveMutex *&sensor = mutexes[qMakePair(stationId, sensorId)];
+    if (!sensor)
+        sensor = new QRecursiveMutex;
+    return *sensor;
+}
 /**
  * @brief Zwraca ścieżkę do katalogu z plikami JSON.
  * @return Ścieżka do katalogu jako QString.
@@ -40,14 +67,18 @@ QJsonDocument loadJsonDoc(const QString &filename) {
 }
 /**
  * @brief Zapisuje dane do pliku JSON.
+ *
+ * Plik zapisywany jest przez QSaveFile (plik tymczasowy i zmiana nazwy), więc przerwany
+ * zapis nie uszkadza poprzedniej wersji.
+ *
  * @param filename Ścieżka do pliku.
  * @param array Dane w formacie QJsonArray.
  */
 void saveJsonDoc(const QString &filename, const QJsonArray &array) {
-    QFile file(filename);
+    QSaveFile file(filename);
     if (file.open(QIODevice::WriteOnly)) {
         file.write(QJsonDocument(array).toJson());
-        file.close();
+        file.commit();
     }
 }
 
@@ -78,57 +109,197 @@ void saveStation(const QJsonArray &stations) {
 }
 /**
  * @brief Zapisuje listę sensorów dla danej stacji.
+ *
+ * Nowe sensory dopisywane są do katalogu. Sensorom już zapisanym bez kodu parametru
+ * (katalogi sprzed wprowadzenia pola paramCode) kod jest uzupełniany z odpowiedzi API.
+ *
  * @param stationId ID stacji.
  * @param sensors Lista sensorów jako QJsonArray.
  */
 void saveSensors(int stationId, const QJsonArray &sensors) {
     QString filename = getJsonFilePath(QString("%1-listasensorow.json").arg(stationId));
     QJsonArray currentFile = loadJsonDoc(filename).array();
-    QSet<int> existingIds;
+    QHash<int, int> existingIndex;
 
-    for (const QJsonValue &val : currentFile)
-        existingIds << val.toObject().value("id").toInt();
+    for (int i = 0; i < currentFile.size(); ++i)
+        existingIndex.insert(currentFile[i].toObject().value("id").toInt(), i);
 
     for (const QJsonValue &val : sensors) {
         QJsonObject original = val.toObject();
         int id = original.value("id").toInt();
+        const QString paramCode = original.value("param").toObject().value("paramCode").toString();
 
-        if (!existingIds.contains(id)) {
-            QJsonObject minimalObj;
-            minimalObj.insert("id", id);
-            minimalObj.insert("paramName", original.value("param").toObject().value("paramName").toString());
-            currentFile.append(minimalObj);
-            existingIds.insert(id);
+        const auto existing = existingIndex.constFind(id);
+        if (existing != existingIndex.constEnd()) {
+            QJsonObject stored = currentFile[existing.value()].toObject();
+            if (stored.value("paramCode").toString().isEmpty() && !paramCode.isEmpty()) {
+                stored.insert("paramCode", paramCode);
+                currentFile[existing.value()] = stored;
+            }
+            continue;
         }
+
+        QJsonObject minimalObj;
+        minimalObj.insert("id", id);
+        minimalObj.insert("paramName", original.value("param").toObject().value("paramName").toString());
+        minimalObj.insert("paramCode", paramCode);
+        existingIndex.insert(id, currentFile.size());
+        currentFile.append(minimalObj);
     }
 
     saveJsonDoc(filename, currentFile);
 }
+/**
+ * @brief Zwraca ścieżkę do binarnego pliku z pomiarami sensora.
+ * @param stationId ID stacji.
+ * @param sensorId ID sensora.
+ * @return Pełna ścieżka do pliku.
+ */
+QString getMeasurementFilePath(int stationId, int sensorId) {
+    return getJsonFilePath(QString("%1-%2.bin").arg(stationId).arg(sensorId));
+}
+/**
+ * @brief Jednorazowo przenosi pomiary sensora z pliku JSON do pliku binarnego.
+ *
+ * Jeśli plik binarny jeszcze nie istnieje, a istnieje plik JSON zapisany przez wcześniejsze
+ * wersje aplikacji, jego zawartość jest przepisywana do pliku binarnego, a plik JSON
+ * otrzymuje rozszerzenie ".migrated".
+ *
+ * @param stationId ID stacji.
+ * @param sensorId ID sensora.
+ * @return true, jeśli plik binarny istnieje po zakończeniu migracji.
+ */
+bool migrateJsonMeasurements(int stationId, int sensorId) {
+    QString binFilename = getMeasurementFilePath(stationId, sensorId);
+    if (QFile::exists(binFilename))
+        return true;
+
+    QString jsonFilename = getJsonFilePath(QString("%1-%2.json").arg(stationId).arg(sensorId));
+    if (!QFile::exists(jsonFilename))
+        return false;
+
+    QJsonArray array = loadJsonDoc(jsonFilename).array();
+    MeasurementSeries series;
+    series.reserve(array.size());
+
+    for (const QJsonValue &val : std::as_const(array)) {
+        QJsonObject obj = val.toObject();
+        QDateTime ts = QDateTime::fromString(obj["timestamp"].toString(), Qt::ISODate);
+        if (!ts.isValid())
+            continue;
+        series.append(ts.toMSecsSinceEpoch(), obj["value"].toDouble());
+    }
+
+    if (!MeasurementStore::create(binFilename, series))
+        return false;
+    QFile::rename(jsonFilename, jsonFilename + ".migrated");
+    return true;
+}
+/**
+ * @brief Zwraca ścieżkę bazową plików z agregatami pomiarów sensora.
+ * @param stationId ID stacji.
+ * @param sensorId ID sensora.
+ * @return Ścieżka bez przyrostka poziomu.
+ */
+QString getRollupBasePath(int stationId, int sensorId) {
+    return getJsonFilePath(QString("%1-%2").arg(stationId).arg(sensorId));
+}
+/**
+ * @brief Sprawdza, czy agregaty sensora zgadzają się z plikiem pomiarów.
+ *
+ * Agregaty uznawane są za aktualne, gdy obejmują tyle pomiarów, ile zapisano w pliku
+ * pomiarów (porównywane są same nagłówki). Niezgodność oznacza brak agregatów (pliki
+ * sprzed ich wprowadzenia) albo zapis przerwany między dopisaniem pomiarów a aktualizacją
+ * agregatów.
+ *
+ * @param stationId ID stacji.
+ * @param sensorId ID sensora.
+ * @return true, jeśli agregaty są aktualne.
+ */
+bool rollupsUpToDate(int stationId, int sensorId) {
+    QMutexLocker locker(&sensorMutex(stationId, sensorId));
+    const qint64 stored = MeasurementStore(getMeasurementFilePath(stationId, sensorId)).pointCount();
+    return stored >= 0 && RollupStore(getRollupBasePath(stationId, sensorId)).pointCount() == stored;
+}
+/**
+ * @brief Tworzy agregaty sensora od nowa, jeśli nie zgadzają się z plikiem pomiarów.
+ *
+ * Czyta wszystkie pomiary sensora i zapisuje pliki agregatów, więc wywoływana jest
+ * w wątku zapisu (MeasurementWriter) albo w trybach bez interfejsu, nigdy w wątku
+ * interfejsu.
+ *
+ * @param stationId ID stacji.
+ * @param sensorId ID sensora.
+ * @return true, jeśli po zakończeniu agregaty są aktualne.
+ */
+bool ensureRollups(int stationId, int sensorId) {
+    QMutexLocker locker(&sensorMutex(stationId, sensorId));
+    if (rollupsUpToDate(stationId, sensorId))
+        return true;
+    return RollupStore(getRollupBasePath(stationId, sensorId)).rebuild(loadMeasurements(stationId, sensorId));
+}
+/**
+ * @brief Usuwa z posortowanej serii pomiary o znacznikach czasu obecnych w drugiej serii.
+ * @param series Seria posortowana, bez powtórzeń.
+ * @param stored Seria posortowana.
+ * @return Pomiary występujące tylko w series; jeśli żaden nie był zapisany - series bez kopiowania.
+ */
+static MeasurementSeries withoutStoredTimestamps(const MeasurementSeries &series, const MeasurementSeries &stored) {
+    int i = 0, j = 0;
+    for (; i < series.size(); ++i) {
+        while (j < stored.size() && stored.timestamp(j) < series.timestamp(i))
+            ++j;
+        if (j < stored.size() && stored.timestamp(j) == series.timestamp(i))
+            break;
+    }
+    if (i == series.size())
+        return series;
+
+    MeasurementSeries fresh;
+    fresh.reserve(series.size());
+    fresh.append(series.timestamps().constData(), series.values().constData(), i);
+    for (; i < series.size(); ++i) {
+        while (j < stored.size() && stored.timestamp(j) < series.timestamp(i))
+            ++j;
+        if (j < stored.size() && stored.timestamp(j) == series.timestamp(i))
+            continue;
+        fresh.append(series.timestamp(i), series.value(i));
+    }
+    return fresh;
+}
 /**
  * @brief Zapisuje dane pomiarowe dla danego sensora.
+ *
+ * Pomiary dopisywane są do pliku binarnego, bez ponownego zapisu wcześniejszych danych.
+ * Pomiary już zapisane są pomijane, a nowe dodawane są również do agregatów
+ * dobowych i miesięcznych. Oba pliki nie są zapisywane atomowo razem: jeśli zapis
+ * zostanie przerwany po dopisaniu pomiarów, liczby pomiarów się rozejdą, a ensureRollups
+ * odbuduje agregaty przy następnym zapisie. Seria posortowana i bez powtórzeń (np. wynik DataWorker)
+ * nie jest przy tym kopiowana.
+ *
  * @param stationId ID stacji.
  * @param sensorId ID sensora.
- * @param points Lista punktów pomiarowych.
- */
-void saveMeasurements(int stationId, int sensorId, const QVector<DataPoint> &points) {
-    QString filename = getJsonFilePath(QString("%1-%2.json").arg(stationId).arg(sensorId));
-    QJsonArray merged = loadJsonDoc(filename).array();
-    QSet<QString> existingTimestamps;
-
-    for (const QJsonValue &val : merged)
-        existingTimestamps.insert(val.toObject()["timestamp"].toString());
-
-    for (const DataPoint &dp : points) {
-        QString ts = dp.timestamp.toString(Qt::ISODate);
-        if (!existingTimestamps.contains(ts)) {
-            QJsonObject obj;
-            obj["timestamp"] = ts;
-            obj["value"] = dp.value;
-            merged.append(obj);
-        }
+ * @param series Seria pomiarów.
+ */
+void saveMeasurements(int stationId, int sensorId, const MeasurementSeries &series) {
+    TRACE_SPAN("saveMeasurements");
+    QMutexLocker locker(&sensorMutex(stationId, sensorId));
+    migrateJsonMeasurements(stationId, sensorId);
+    ensureRollups(stationId, sensorId);
+
+    MeasurementStore store(getMeasurementFilePath(stationId, sensorId));
+    MeasurementSeries fresh = series;
+    fresh.sortUnique();
+    if (fresh.isEmpty())
+        return;
+    if (store.exists()) {
+        MeasurementSeries stored;
+        store.readRange(fresh.timestamp(0), fresh.timestamp(fresh.size() - 1), stored);
+        fresh = withoutStoredTimestamps(fresh, stored);
     }
 
-    saveJsonDoc(filename, merged);
+    if (store.append(fresh) > 0)
+        RollupStore(getRollupBasePath(stationId, sensorId)).add(fresh);
 }
 /**
  * @brief Wczytuje listę stacji z pliku JSON.
@@ -149,21 +320,153 @@ QJsonArray loadSensors(int stationId) {
     return doc.array();
 }
 /**
- * @brief Wczytuje dane pomiarowe z pliku JSON.
+ * @brief Wczytuje dane pomiarowe z pliku binarnego.
  * @param stationId ID stacji.
  * @param sensorId ID sensora.
- * @return Wektor punktów pomiarowych typu DataPoint.
+ * @return Seria pomiarów posortowana według czasu.
  */
-QVector<DataPoint> loadMeasurements(int stationId, int sensorId) {
-    QVector<DataPoint> data;
-    QString filename = getJsonFilePath(QString("%1-%2.json").arg(stationId).arg(sensorId));
-    QJsonDocument doc = loadJsonDoc(filename);
+MeasurementSeries loadMeasurements(int stationId, int sensorId) {
+    TRACE_SPAN("loadMeasurements");
+    QMutexLocker locker(&sensorMutex(stationId, sensorId));
+    MeasurementSeries series;
+    if (migrateJsonMeasurements(stationId, sensorId))
+        MeasurementStore(getMeasurementFilePath(stationId, sensorId)).readAll(series);
+    return series;
+}
+/**
+ * @brief Wczytuje dane pomiarowe z zadanego przedziału czasu.
+ *
+ * Korzysta z uporządkowania pliku binarnego, dzięki czemu czyta tylko bloki
+ * obejmujące przedział, a wynik jest już posortowany według czasu.
+ *
+ * @param stationId ID stacji.
+ * @param sensorId ID sensora.
+ * @param from Początek przedziału (włącznie).
+ * @param to Koniec przedziału (włącznie).
+ * @return Seria pomiarów posortowana według czasu.
+ */
+MeasurementSeries loadMeasurementsRange(int stationId, int sensorId, const QDateTime &from, const QDateTime &to) {
+    TRACE_SPAN("loadMeasurements");
+    QMutexLocker locker(&sensorMutex(stationId, sensorId));
+    MeasurementSeries series;
+    if (migrateJsonMeasurements(stationId, sensorId)) {
+        MeasurementStore store(getMeasurementFilePath(stationId, sensorId));
+        store.readRange(from.toMSecsSinceEpoch(), to.toMSecsSinceEpoch(), series);
+    }
+    return series;
+}
+/**
+ * @brief Wczytuje mapę przedziałów czasu pobranych dla sensora.
+ * @param stationId ID stacji.
+ * @param sensorId ID sensora.
+ * @return Mapa pokrycia (pusta, jeśli plik nie istnieje).
+ */
+CoverageMap loadCoverage(int stationId, int sensorId) {
+    QMutexLocker locker(&sensorMutex(stationId, sensorId));
+    QString filename = getJsonFilePath(QString("%1-%2-pokrycie.json").arg(stationId).arg(sensorId));
+    return CoverageMap::fromJson(loadJsonDoc(filename).array());
+}
+/**
+ * @brief Zapisuje mapę przedziałów czasu pobranych dla sensora.
+ * @param stationId ID stacji.
+ * @param sensorId ID sensora.
+ * @param coverage Mapa pokrycia.
+ */
+void saveCoverage(int stationId, int sensorId, const CoverageMap &coverage) {
+    QMutexLocker locker(&sensorMutex(stationId, sensorId));
+    QString filename = getJsonFilePath(QString("%1-%2-pokrycie.json").arg(stationId).arg(sensorId));
+    saveJsonDoc(filename, coverage.toJson());
+}
+/**
+ * @brief Wczytuje agregaty sensora z poziomu dla przedziału czasu.
+ *
+ * Zapisane agregaty używane są tylko dla przedziałów poziomu mieszczących się w całości
+ * w [from, to]. Przedziały na krańcach zakresu, objęte nim tylko częściowo, sumowane są
+ * z pomiarów godzinowych z zakresu, więc statystyki nie obejmują pomiarów spoza niego.
+ * Agregaty krańcowe mają ten sam początek co zapisane (RollupStore::bucketStart).
+ *
+ * Funkcja tylko czyta pliki: nieaktualne agregaty (rollupsUpToDate) odbudowuje wątek
+ * zapisu (MeasurementWriter::updateRollups), więc wywołujący powinien wcześniej zlecić
+ * odbudowę i poczekać na nią.
+ *
+ * @param stationId ID stacji.
+ * @param sensorId ID sensora.
+ * @param tier Poziom (RollupStore::Daily lub RollupStore::Monthly).
+ * @param from Początek przedziału.
+ * @param to Koniec przedziału.
+ * @return Agregaty posortowane według czasu.
+ */
+QVector<RollupBucket> loadRollups(int stationId, int sensorId, RollupStore::Tier tier, const QDateTime &from, const QDateTime &to) {
+    TRACE_SPAN("loadRollups");
+    QMutexLocker locker(&sensorMutex(stationId, sensorId));
+    const qint64 rangeFrom = from.toMSecsSinceEpoch();
+    const qint64 rangeTo = to.toMSecsSinceEpoch();
+    QVector<RollupBucket> buckets;
+    if (rangeFrom > rangeTo)
+        return buckets;
 
-    for (const QJsonValue &val : doc.array()) {
-        QJsonObject obj = val.toObject();
-        QDateTime ts = QDateTime::fromString(obj["timestamp"].toString(), Qt::ISODate);
-        double value = obj["value"].toDouble();
-        data.append({ ts, value });
+    const qint64 first = RollupStore::bucketStart(tier, rangeFrom);
+    const qint64 wholeFrom = (first == rangeFrom) ? rangeFrom : RollupStore::nextBucketStart(tier, first);
+    const qint64 wholeTo = RollupStore::bucketStart(tier, rangeTo + 1);
+    auto addHourly = [&](qint64 partFrom, qint64 partTo) {
+        if (partFrom > partTo)
+            return;
+        buckets += RollupStore::aggregate(tier, loadMeasurementsRange(stationId, sensorId,
+                                                                      QDateTime::fromMSecsSinceEpoch(partFrom),
+                                                                      QDateTime::fromMSecsSinceEpoch(partTo)));
+    };
+
+    if (wholeFrom >= wholeTo) {
+        addHourly(rangeFrom, rangeTo);
+        return buckets;
     }
-    return data;
+    addHourly(rangeFrom, wholeFrom - 1);
+    RollupStore(getRollupBasePath(stationId, sensorId)).read(tier, wholeFrom, wholeTo - 1, buckets);
+    addHourly(wholeTo, rangeTo);
+    return buckets;
+}
+/**
+ * @brief Zwraca fragmenty zakresu dat, których nie ma jeszcze w lokalnej bazie sensora.
+ *
+ * Zakres wyrównywany jest do pełnych godzin, a brakujące fragmenty wyznaczane na podstawie
+ * mapy pokrycia sensora.
+ *
+ * @param stationId ID stacji.
+ * @param sensorId ID sensora.
+ * @param from Początek zakresu.
+ * @param to Koniec zakresu.
+ * @return Przedziały (pierwsza godzina, ostatnia godzina) do pobrania, posortowane chronologicznie.
+ */
+QVector<QPair<QDateTime, QDateTime>> missingRanges(int stationId, int sensorId, const QDateTime &from, const QDateTime &to) {
+    const qint64 hour = 3600 * 1000;
+    const qint64 rangeFrom = from.toMSecsSinceEpoch() / hour * hour;
+    const qint64 rangeTo = to.toMSecsSinceEpoch() / hour * hour + hour;
+
+    QVector<QPair<QDateTime, QDateTime>> ranges;
+    const QVector<CoverageMap::Interval> gaps = loadCoverage(stationId, sensorId).missing(rangeFrom, rangeTo);
+    for (const CoverageMap::Interval &gap : gaps)
+        ranges.append({ QDateTime::fromMSecsSinceEpoch(gap.first), QDateTime::fromMSecsSinceEpoch(gap.second - hour) });
+    return ranges;
+}
+/**
+ * @brief Zapisuje pobrane pomiary i oznacza przedziały jako pobrane.
+ *
+ * Ostatnie CoverageSettleHours godzin nie jest oznaczanych jako pobrane, bo GIOŚ może
+ * je jeszcze uzupełniać; przy kolejnym zapytaniu zostaną pobrane ponownie.
+ *
+ * @param stationId ID stacji.
+ * @param sensorId ID sensora.
+ * @param ranges Pobrane przedziały (pierwsza godzina, ostatnia godzina).
+ * @param series Pobrane pomiary.
+ */
+void saveFetchedRanges(int stationId, int sensorId, const QVector<QPair<QDateTime, QDateTime>> &ranges, const MeasurementSeries &series) {
+    QMutexLocker locker(&sensorMutex(stationId, sensorId));
+    saveMeasurements(stationId, sensorId, series);
+
+    const qint64 hour = 3600 * 1000;
+    const qint64 settled = (QDateTime::currentMSecsSinceEpoch() - CoverageSettleHours * hour) / hour * hour;
+    CoverageMap coverage = loadCoverage(stationId, sensorId);
+    for (const QPair<QDateTime, QDateTime> &range : ranges)
+        coverage.add(range.first.toMSecsSinceEpoch(), qMin(range.second.toMSecsSinceEpoch() + hour, settled));
+    saveCoverage(stationId, sensorId, coverage);
 }
@@ -6,10 +6,13 @@
 
 #include <QString>
 #include <QVector>
+#include <QPair>
+#include <QDateTime>
 #include <QJsonArray>
 #include <QJsonObject>
-
-struct DataPoint;
+#include "measurementseries.h"
+#include "coveragemap.h"
+#include "rollupstore.h"
 
 /** @brief Zwraca ścieżkę do katalogu z plikami JSON. */
 QString getJsonDir();
@@ -29,8 +32,23 @@ void saveStation(const QJsonArray &stations);
 /** @brief Zapisuje listę sensorów dla danej stacji. */
 void saveSensors(int stationId, const QJsonArray &sensors);
 
+/** @brief Zwraca ścieżkę do binarnego pliku z pomiarami sensora. */
+QString getMeasurementFilePath(int stationId, int sensorId);
+
+/** @brief Jednorazowo przenosi pomiary sensora z pliku JSON do pliku binarnego. */
+bool migrateJsonMeasurements(int stationId, int sensorId);
+
+/** @brief Zwraca ścieżkę bazową plików z agregatami pomiarów sensora. */
+QString getRollupBasePath(int stationId, int sensorId);
+
+/** @brief Sprawdza, czy agregaty sensora zgadzają się z plikiem pomiarów. */
+bool rollupsUpToDate(int stationId, int sensorId);
+
+/** @brief Tworzy agregaty sensora od nowa, jeśli nie zgadzają się z plikiem pomiarów. */
+bool ensureRollups(int stationId, int sensorId);
+
 /** @brief Zapisuje pomiary dla danego sensora. */
-void saveMeasurements(int stationId, int sensorId, const QVector<DataPoint> &points);
+void saveMeasurements(int stationId, int sensorId, const MeasurementSeries &series);
 
 /** @brief Wczytuje listę stacji z lokalnego pliku. */
 QJsonArray loadStationList();
@@ -39,6 +57,27 @@ QJsonArray loadStationList();
 QJsonArray loadSensors(int stationId);
 
 /** @brief Wczytuje dane pomiarowe z pliku. */
-QVector<DataPoint> loadMeasurements(int stationId, int sensorId);
+MeasurementSeries loadMeasurements(int stationId, int sensorId);
+
+/** @brief Wczytuje posortowane dane pomiarowe z zadanego przedziału czasu. */
+MeasurementSeries loadMeasurementsRange(int stationId, int sensorId, const QDateTime &from, const QDateTime &to);
+
+/** @brief Wczytuje agregaty sensora z poziomu dla przedziału czasu (niepełne przedziały z pomiarów godzinowych). */
+QVector<RollupBucket> loadRollups(int stationId, int sensorId, RollupStore::Tier tier, const QDateTime &from, const QDateTime &to);
+
+/** @brief Wczytuje mapę przedziałów czasu pobranych dla sensora. */
+CoverageMap loadCoverage(int stationId, int sensorId);
+
+/** @brief Zapisuje mapę przedziałów czasu pobranych dla sensora. */
+void saveCoverage(int stationId, int sensorId, const CoverageMap &coverage);
+
+/** @brief Liczba ostatnich godzin, które nie są oznaczane jako pobrane, bo mogą być jeszcze uzupełniane. */
+const int CoverageSettleHours = 3;
+
+/** @brief Zwraca fragmenty zakresu dat, których nie ma jeszcze w lokalnej bazie sensora. */
+QVector<QPair<QDateTime, QDateTime>> missingRanges(int stationId, int sensorId, const QDateTime &from, const QDateTime &to);
+
+/** @brief Zapisuje pobrane pomiary i oznacza przedziały jako pobrane. */
+void saveFetchedRanges(int stationId, int sensorId, const QVector<QPair<QDateTime, QDateTime>> &ranges, const MeasurementSeries &series);
 
 #endif // JSONSTORAGE_H
@@ -1,19 +1,64 @@
 /**
  * @file main.cpp
- * @brief Główna funkcja uruchamiająca aplikację GUI.
+ * @brief Główna funkcja uruchamiająca aplikację GUI lub tryb wsadowy.
  */
 
 #include "mainwindow.h"
+#include "analyticsrunner.h"
+#include "batchrunner.h"
+#include "networktransport.h"
+#include "tracing.h"
 #include <QApplication>
+#include <QCoreApplication>
+#include <QTimer>
+#include <cstdio>
 
 /**
  * @brief Funkcja główna aplikacji.
+ *
+ * Z argumentem --batch program działa bez interfejsu graficznego (QCoreApplication),
+ * więc może być uruchamiany na serwerze bez ekranu, np. z crona. Argument --analyze
+ * uruchamia zestawienia z lokalnej bazy, również bez interfejsu graficznego. Pomiary
+ * wydajności są osobnym programem (podkatalog benchmarks). Zmienne środowiskowe
+ * JP_TRANSPORT itd. włączają nagrywanie lub odtwarzanie odpowiedzi sieciowych
+ * (zob. NetworkTransport::settingsFromEnvironment), a JP_TRACE - pomiar czasu etapów
+ * (zob. Tracer::configureFromEnvironment).
+ *
  * @param argc Liczba argumentów.
  * @param argv Tablica argumentów.
  * @return Kod zakończenia programu.
  */
 int main(int argc, char *argv[])
 {
+    NetworkTransport::setDefaultSettings(NetworkTransport::settingsFromEnvironment());
+    Tracer::configureFromEnvironment();
+
+    if (AnalyticsRunner::isRequested(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        AnalyticsRunner::Options options;
+        QString error;
+        if (!AnalyticsRunner::parseArguments(app.arguments(), options, error)) {
+            std::fprintf(stderr, "%s\n", qPrintable(error));
+            return 2;
+        }
+        return AnalyticsRunner(options).run();
+    }
+
+    if (BatchRunner::isRequested(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        BatchRunner::Options options;
+        QString error;
+        if (!BatchRunner::parseArguments(app.arguments(), options, error)) {
+            std::fprintf(stderr, "%s\n", qPrintable(error));
+            return 2;
+        }
+
+        BatchRunner runner(options);
+        QObject::connect(&runner, &BatchRunner::finished, &app, &QCoreApplication::exit, Qt::QueuedConnection);
+        QTimer::singleShot(0, &runner, &BatchRunner::start);
+        return app.exec();
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
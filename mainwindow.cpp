@@ -8,19 +8,42 @@
 #include <QHBoxLayout>
 #include <QWidget>
 #include <QMessageBox>
+#include <QStatusBar>
+#include <QSignalBlocker>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
-#include <QThread>
+#include <QDebug>
+#include <QSharedPointer>
+#include <QPointer>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 #include "jsonstorage.h"
 #include "dataworker.h"
+#include "fetchservice.h"
+#include "cachingnetworkmanager.h"
 #include "chartwindow.h"
+#include "seriesstatistics.h"
+#include "rollupstore.h"
+#include "syncscheduler.h"
+#include "measurementwriter.h"
+#include "tracing.h"
+#include "cancellationtoken.h"
+#include <algorithm>
+
+namespace {
+
+/** @brief Widok FetchService dla wykresu z okna głównego; nowe zapytanie zastępuje poprzednie. */
+const QString ChartView = QStringLiteral("chart");
+
+}
 
 /**
  * @brief Konstruktor klasy MainWindow.
  *
  * Inicjalizuje komponenty interfejsu użytkownika, ustawia połączenia sygnałów i slotów,
- * ustawia domyślne daty oraz pobiera listę stacji pomiarowych z API.
+ * ustawia domyślne daty, od razu wyświetla zapisaną lokalnie listę stacji, a następnie
+ * odświeża ją w tle na podstawie API. Po krótkim opóźnieniu rusza synchronizacja lokalnej bazy w tle.
  *
  * @param parent Wskaźnik na obiekt rodzica.
  */
@@ -36,7 +59,12 @@ MainWindow::MainWindow(QWidget *parent)
     dateTimeFrom(new QDateTimeEdit(this)),
     dateTimeTo(new QDateTimeEdit(this)),
     generateChartButton(new QPushButton("Wygeneruj wykres", this)),
-    networkManager(new QNetworkAccessManager(this)),
+    addComparisonButton(new QPushButton("Dodaj do porównania", this)),
+    compareButton(new QPushButton(this)),
+    networkManager(new CachingNetworkManager(getJsonFilePath("httpcache"), this)),
+    fetchService(new FetchService(FetchService::DefaultThreadCount, FetchService::DefaultQueueCapacity, this)),
+    measurementWriter(new MeasurementWriter(this)),
+    syncScheduler(new SyncScheduler(fetchService, measurementWriter, this)),
     currentStep(1)
 {
     QWidget *central = new QWidget(this);
@@ -57,25 +85,39 @@ MainWindow::MainWindow(QWidget *parent)
     vertical->addWidget(dateTo);
     vertical->addWidget(dateTimeTo);
     vertical->addWidget(generateChartButton);
+    vertical->addWidget(addComparisonButton);
+    vertical->addWidget(compareButton);
     central->setLayout(vertical);
 
     connect(backButton, &QPushButton::clicked, this, &MainWindow::onBackClicked);
     connect(nextButton, &QPushButton::clicked, this, &MainWindow::onNextClicked);
     connect(generateChartButton, &QPushButton::clicked, this, &MainWindow::onGenerateClicked);
+    connect(addComparisonButton, &QPushButton::clicked, this, &MainWindow::onAddComparisonClicked);
+    connect(compareButton, &QPushButton::clicked, this, &MainWindow::onCompareClicked);
     connect(networkManager, &QNetworkAccessManager::finished, this, &MainWindow::onDataReceived);
 
     dateTimeFrom->setDateTime(QDateTime::currentDateTime().addDays(-1));
     dateTimeTo->setDateTime(QDateTime::currentDateTime());
     dateTimeFrom->setMaximumDateTime(QDateTime::currentDateTime());
     dateTimeTo->setMaximumDateTime(QDateTime::currentDateTime());
+    applyItems(comboBox, stationItems(loadStationList(), false));
     updateUI();
     fetchDataFromUrl("https://api.gios.gov.pl/pjp-api/rest/station/findAll?sort=stationName");
+    syncScheduler->start();
 }
 
 /**
  * @brief Destruktor klasy MainWindow.
+ *
+ * Wypisuje statystyki pamięci podręcznej odpowiedzi HTTP.
  */
-MainWindow::~MainWindow() {}
+MainWindow::~MainWindow()
+{
+    const HttpCache *cache = networkManager->httpCache();
+    qInfo().nospace() << "Pamięć podręczna HTTP: trafienia " << cache->hits()
+                      << ", potwierdzone (304) " << cache->revalidations()
+                      << ", chybienia " << cache->misses();
+}
 
 /**
  * @brief Obsługuje kliknięcie przycisku "Cofnij".
@@ -93,6 +135,7 @@ void MainWindow::onBackClicked()
  * @brief Obsługuje kliknięcie przycisku "Dalej".
  *
  * Pobiera dane w zależności od aktualnego kroku formularza i przechodzi dalej.
+ * Lista parametrów stacji wyświetlana jest od razu z lokalnego katalogu i odświeżana w tle.
  */
 void MainWindow::onNextClicked()
 {
@@ -100,8 +143,9 @@ void MainWindow::onNextClicked()
         currentStep = 2;
         int stationId = comboBox->currentData().toInt();
         selectedStationName = comboBox->currentText();
+        sensorsStationId = stationId;
+        applyItems(comboBoxSensors, sensorItems(loadSensors(stationId), false));
         QString indexUrl = QString("https://api.gios.gov.pl/pjp-api/rest/aqindex/getIndex/%1").arg(stationId);
-        avoidWarning = true;
         fetchDataFromUrl(indexUrl);
         QString sensorsUrl = QString("https://api.gios.gov.pl/pjp-api/rest/station/sensors/%1").arg(stationId);
         fetchDataFromUrl(sensorsUrl);
@@ -124,13 +168,28 @@ void MainWindow::fetchDataFromUrl(const QString &url)
 {
     QUrl qurl(url);
     QNetworkRequest request(qurl);
-    networkManager->get(request);
+    QNetworkReply *reply = networkManager->get(request);
+    if (Tracer::isEnabled())
+        reply->setProperty("traceStart", Tracer::now());
 }
 
 /**
  * @brief Obsługuje kliknięcie przycisku "Wygeneruj wykres".
  *
- * Tworzy osobny wątek do pobierania danych i otwiera nowe okno z wykresem.
+ * Na podstawie mapy pokrycia sensora wyznacza fragmenty zakresu, których nie ma jeszcze
+ * w lokalnej bazie, i tylko je przekazuje do pobrania puli wątków FetchService. Wykres
+ * tworzony jest z danych lokalnych uzupełnionych o pobrane fragmenty. Pobrane dane
+ * zapisuje w tle MeasurementWriter. Jeśli cały zakres jest już zapisany, wykres powstaje
+ * bez żadnego zapytania do sieci.
+ *
+ * Dla zakresów rysowanych z pomiarów godzinowych okno wykresu otwierane jest od razu
+ * z danymi lokalnymi, a kolejne strony archiwum dopisywane są do niego w miarę
+ * pobierania (DataWorker::batchReady). Wykresy średnich dobowych i miesięcznych
+ * powstają z agregatów, więc otwierane są dopiero po zapisaniu pobranych danych.
+ *
+ * Nowe zapytanie zastępuje poprzednie, jeszcze niezakończone: jego pobieranie jest
+ * anulowane (FetchService::cancel), pobrane strony nie są zapisywane, a otwarte dla
+ * niego okno wykresu jest zamykane.
  */
 void MainWindow::onGenerateClicked()
 {
@@ -142,115 +201,290 @@ void MainWindow::onGenerateClicked()
 
     int sensorId = comboBoxSensors->currentData().toInt();
     int stationId = comboBox->currentData().toInt();
-    QThread *thread = new QThread;
-    DataWorker *worker = new DataWorker(sensorId, from, to);
-    worker->moveToThread(thread);
+    // Odcinek "chartRequest" kończy się po zwolnieniu ostatniej kopii wskaźnika, czyli
+    // gdy wszystkie funkcje obsługujące to zapytanie zostaną usunięte.
+    const QSharedPointer<TraceSpan> trace(new TraceSpan("chartRequest"));
+    fetchService->cancel(ChartView);
 
-    connect(thread, &QThread::started, worker, &DataWorker::start);
-    connect(worker, &DataWorker::dataReady, this, [=](QVector<DataPoint> data) {
+    const QVector<QPair<QDateTime, QDateTime>> ranges = missingRanges(stationId, sensorId, from, to);
+    if (ranges.isEmpty()) {
+        showChart(stationId, sensorId, from, to);
+        return;
+    }
 
-        QVector<QPointF> points;
-        QVector<QDateTime> timestamps;
+    DataWorker *worker = new DataWorker(sensorId, ranges);
+    const CancellationToken token = worker->cancellationToken();
 
-        if (data.isEmpty()) {
-            QVector<DataPoint> offline = loadMeasurements(stationId, sensorId);
+    QPointer<ChartWindow> window;
+    if (RollupStore::tierForRange(from.toMSecsSinceEpoch(), to.toMSecsSinceEpoch()) == RollupStore::Hourly) {
+        const MeasurementSeries local = loadMeasurementsRange(stationId, sensorId, from, to);
+        window = new ChartWindow(local, SeriesStatistics::compute(local), paramName, selectedStationName);
+        window->setAttribute(Qt::WA_DeleteOnClose);
+        window->startStreaming();
+        window->show();
+        connect(worker, &DataWorker::batchReady, window.data(), &ChartWindow::appendBatch);
+        connect(worker, &DataWorker::cancelled, window.data(), &QWidget::close);
+    }
+    const bool streaming = !window.isNull();
 
-            QVector<DataPoint> filtered;
-            for (const DataPoint &dp : std::as_const(offline)) {
-                if (dp.timestamp >= from && dp.timestamp <= to) {
-                    filtered.append(dp);
-                }
-            }
+    connect(worker, &DataWorker::dataReady, this, [=, trace = trace](MeasurementSeries fetched, bool complete) {
+        if (token.isCancelled()) {
+            // Zastąpione zapytanie zakończyło się przed anulowaniem: dane są kompletne,
+            // więc trafiają do bazy, ale wykres nie jest już potrzebny.
+            if (window)
+                window->close();
+            if (complete)
+                measurementWriter->enqueue(stationId, sensorId, ranges, fetched);
+            return;
+        }
+        if (window)
+            window->finishStreaming(complete);
 
-            if (!filtered.isEmpty()) {
+        if (!complete) {
+            if (streaming)
+                return;
+            if (!loadMeasurementsRange(stationId, sensorId, from, to).isEmpty()) {
                 QMessageBox::information(this, "Brak połączenia", "Nie udało się pobrać danych z sieci.\nZaładowano dane lokalne.");
-                std::sort(filtered.begin(), filtered.end(), [](const DataPoint &a, const DataPoint &b) {
-                    return a.timestamp < b.timestamp;
-                });
-                data = filtered;
             } else {
                 QMessageBox::information(this, "Brak połączenia", "Nie udało się pobrać danych z sieci.\nBrak danych lokalnych w podanym zakresie.");
                 return;
             }
+            showChart(stationId, sensorId, from, to);
+            return;
         }
 
-        double sum = 0, min = data[0].value, max = data[0].value;
-        QDateTime minTime = data[0].timestamp, maxTime = data[0].timestamp;
-
-        for (int i = 0; i < data.size(); ++i) {
-            double val = data[i].value;
-            points.append(QPointF(i, val));
-            timestamps.append(data[i].timestamp);
-            sum += val;
-            if (val < min) {
-                min = val;
-                minTime = data[i].timestamp;
-            }
-            if (val > max) {
-                max = val;
-                maxTime = data[i].timestamp;
-            }
+        const quint64 sequence = measurementWriter->enqueue(stationId, sensorId, ranges, fetched);
+        if (streaming)
+            return;
+        whenSaved(stationId, sensorId, sequence, [=, trace = trace]() {
+            if (token.isCancelled())
+                return;
+            showChart(stationId, sensorId, from, to);
+        });
+    });
+
+    if (!fetchService->submit(worker, FetchService::Interactive, ChartView)) {
+        delete worker;
+        if (window)
+            window->finishStreaming(false);
+        QMessageBox::information(this, "Zbyt wiele zapytań", "Poprzednie wykresy są jeszcze pobierane.\nSpróbuj ponownie za chwilę.");
+    }
+}
+
+/**
+ * @brief Zwraca sensor wybrany w formularzu jako pozycję porównania.
+ * @return Stacja i sensor wraz z nazwami.
+ */
+ComparisonQuery::Target MainWindow::currentTarget() const
+{
+    ComparisonQuery::Target target;
+    target.stationId = comboBox->currentData().toInt();
+    target.sensorId = comboBoxSensors->currentData().toInt();
+    target.paramName = paramName;
+    target.stationName = selectedStationName;
+    return target;
+}
+
+/**
+ * @brief Obsługuje kliknięcie przycisku "Dodaj do porównania".
+ *
+ * Zapamiętuje wybrany sensor. Po powrocie do wcześniejszych kroków można wybrać
+ * inny parametr lub inną stację i dodać kolejny sensor.
+ */
+void MainWindow::onAddComparisonClicked()
+{
+    const ComparisonQuery::Target target = currentTarget();
+    if (comparisonTargets.contains(target)) {
+        statusBar()->showMessage("Ten parametr jest już dodany do porównania.");
+        return;
+    }
+    if (comparisonTargets.size() >= ComparisonQuery::MaxTargets) {
+        QMessageBox::information(this, "Porównanie", QString("Można porównać najwyżej %1 parametrów.").arg(ComparisonQuery::MaxTargets));
+        return;
+    }
+    comparisonTargets.append(target);
+    statusBar()->showMessage(QString("Dodano do porównania: %1").arg(target.label()));
+    updateUI();
+}
+
+/**
+ * @brief Obsługuje kliknięcie przycisku "Wykres porównawczy".
+ *
+ * Porównywane są sensory dodane do porównania oraz sensor wybrany w formularzu, w zakresie
+ * dat z formularza. Dane wszystkich sensorów pobiera i wczytuje równolegle ComparisonQuery.
+ */
+void MainWindow::onCompareClicked()
+{
+    dateTimeFrom->setMaximumDateTime(QDateTime::currentDateTime());
+    dateTimeTo->setMaximumDateTime(QDateTime::currentDateTime());
+
+    QVector<ComparisonQuery::Target> targets = comparisonTargets;
+    const ComparisonQuery::Target target = currentTarget();
+    if (!targets.contains(target) && targets.size() < ComparisonQuery::MaxTargets)
+        targets.append(target);
+    if (targets.size() < 2) {
+        QMessageBox::information(this, "Porównanie", "Dodaj do porównania co najmniej jeden inny parametr lub stację.");
+        return;
+    }
+
+    ComparisonQuery *query = new ComparisonQuery(fetchService, measurementWriter, targets,
+                                                 dateTimeFrom->dateTime(), dateTimeTo->dateTime(), this);
+    connect(query, &ComparisonQuery::finished, this, &MainWindow::showComparison);
+    query->start();
+    comparisonTargets.clear();
+    statusBar()->showMessage("Pobieranie danych do porównania...");
+    updateUI();
+}
+
+/**
+ * @brief Otwiera okno z wykresem porównawczym.
+ * @param comparison Serie, statystyki i wyrównanie wczytane przez ComparisonQuery.
+ */
+void MainWindow::showComparison(const ComparisonResult &comparison)
+{
+    statusBar()->clearMessage();
+    const bool hasData = std::any_of(comparison.series.constBegin(), comparison.series.constEnd(),
+                                     [](const MeasurementSeries &series) { return !series.isEmpty(); });
+    if (!hasData) {
+        QMessageBox::information(this, "Brak danych", "Brak pomiarów w podanym zakresie.");
+        return;
+    }
+
+    ChartWindow *window = new ChartWindow(comparison);
+    window->setAttribute(Qt::WA_DeleteOnClose);
+    window->show();
+}
+
+/**
+ * @brief Wczytuje dane z lokalnej bazy, oblicza statystyki i otwiera nowe okno z wykresem.
+ *
+ * Dla długich zakresów zamiast pomiarów godzinowych używany jest najmniej szczegółowy
+ * poziom agregatów (dobowy lub miesięczny), który nadal daje wystarczającą liczbę punktów
+ * wykresu (RollupStore::tierForRange). Wykres przedstawia wtedy średnie z przedziałów.
+ * Percentyli nie da się wyznaczyć z agregatów, a wymagają odczytu wszystkich pomiarów
+ * godzinowych zakresu, więc okno otwierane jest od razu ze statystykami z agregatów,
+ * a percentyle liczone są w puli wątków QtConcurrent i uzupełniane po obliczeniu.
+ *
+ * Nieaktualne agregaty (np. po przerwanym zapisie) odbudowuje wątek zapisu, bo wymaga to
+ * odczytu wszystkich pomiarów sensora; okno otwierane jest po zakończeniu odbudowy.
+ *
+ * @param stationId ID stacji.
+ * @param sensorId ID sensora.
+ * @param from Początek zakresu.
+ * @param to Koniec zakresu.
+ * @param updateRollups false, jeśli odbudowa agregatów została już zlecona.
+ */
+void MainWindow::showChart(int stationId, int sensorId, const QDateTime &from, const QDateTime &to, bool updateRollups)
+{
+    TRACE_SPAN("showChart");
+    const RollupStore::Tier tier = RollupStore::tierForRange(from.toMSecsSinceEpoch(), to.toMSecsSinceEpoch());
+    MeasurementSeries data;
+    SeriesStatistics stats;
+    QString resolution;
+
+    if (tier == RollupStore::Hourly) {
+        data = loadMeasurementsRange(stationId, sensorId, from, to);
+        stats = SeriesStatistics::compute(data);
+    } else {
+        if (updateRollups && !rollupsUpToDate(stationId, sensorId)) {
+            whenSaved(stationId, sensorId, measurementWriter->updateRollups(stationId, sensorId),
+                      [=]() { showChart(stationId, sensorId, from, to, false); });
+            return;
         }
+        const QVector<RollupBucket> buckets = loadRollups(stationId, sensorId, tier, from, to);
+        data.reserve(buckets.size());
+        for (const RollupBucket &bucket : buckets)
+            data.append(bucket.start, bucket.mean());
+        stats = SeriesStatistics::fromRollups(buckets);
+        resolution = (tier == RollupStore::Daily) ? "średnie dobowe" : "średnie miesięczne";
+    }
 
-        double avg = sum / data.size();
-        QString trend = (points.last().y() > points.first().y()) ? "rośnie" : (points.last().y() < points.first().y()) ? "maleje" : "brak";
+    if (data.isEmpty()) {
+        QMessageBox::information(this, "Brak danych", "Brak pomiarów w podanym zakresie.");
+        return;
+    }
 
+    ChartWindow *window = new ChartWindow(data, stats, paramName, selectedStationName, resolution);
 
-        ChartWindow *window = new ChartWindow(points, timestamps, min, minTime, max, maxTime, avg, trend, paramName, selectedStationName);
+    window->setAttribute(Qt::WA_DeleteOnClose);
+    window->show();
+    if (tier == RollupStore::Hourly || !stats.isValid())
+        return;
 
-        window->setAttribute(Qt::WA_DeleteOnClose);
-        window->show();
-        saveMeasurements(stationId, sensorId, data);
-        worker->deleteLater();
-        thread->deleteLater();
+    window->setStatistics(stats, "Obliczanie percentyli...");
+    const QPointer<ChartWindow> target(window);
+    QFutureWatcher<SeriesStatistics> *watcher = new QFutureWatcher<SeriesStatistics>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [watcher, target]() {
+        if (target)
+            target->setStatistics(watcher->result());
+        watcher->deleteLater();
     });
+    watcher->setFuture(QtConcurrent::run([stationId, sensorId, from, to, stats]() {
+        TRACE_SPAN("percentiles");
+        SeriesStatistics result = stats;
+        result.computePercentiles(loadMeasurementsRange(stationId, sensorId, from, to));
+        return result;
+    }));
+}
 
-    connect(worker, &DataWorker::dataReady, thread, &QThread::quit);
-    thread->start();
+/**
+ * @brief Wykonuje akcję po zakończeniu zlecenia zapisu sensora w MeasurementWriter.
+ * @param stationId ID stacji.
+ * @param sensorId ID sensora.
+ * @param sequence Numer zlecenia.
+ * @param action Akcja wykonywana raz, w wątku interfejsu.
+ */
+void MainWindow::whenSaved(int stationId, int sensorId, quint64 sequence, const std::function<void()> &action)
+{
+    QSharedPointer<QMetaObject::Connection> connection(new QMetaObject::Connection);
+    *connection = connect(measurementWriter, &MeasurementWriter::saved, this,
+                          [=](int savedStationId, int savedSensorId, quint64 savedSequence) {
+        if (savedStationId != stationId || savedSensorId != sensorId || savedSequence < sequence)
+            return;
+        disconnect(*connection);
+        action();
+    });
 }
 /**
  * @brief Obsługuje zakończenie zapytania sieciowego.
  *
- * Przetwarza odpowiedź w formacie JSON i aktualizuje interfejs lub pobiera dane lokalne.
+ * Rodzaj odpowiedzi rozpoznawany jest po adresie zapytania. Listy stacji i parametrów
+ * są już wyświetlone z lokalnego katalogu, więc odpowiedź z API nanosi na nie jedynie
+ * zmiany. W razie błędu sieci pozostają dane lokalne.
  *
  * @param reply Wskaźnik do odpowiedzi z serwera.
  */
 void MainWindow::onDataReceived(QNetworkReply *reply)
 {
+    TRACE_SPAN("onDataReceived");
+    const qint64 traceStart = reply->property("traceStart").toLongLong();
+    if (traceStart != 0)
+        Tracer::record("metadataRequest", traceStart, Tracer::now());
+
+    const QString path = reply->url().path();
+    const bool isStationList = path.contains("/station/findAll");
+    const bool isSensorList = path.contains("/station/sensors/");
+    const int sensorListStationId = isSensorList ? path.section('/', -1).toInt() : -1;
+
     if (reply->error() != QNetworkReply::NoError) {
-        if (currentStep == 1) {
-            QJsonArray stations = loadStationList();
-            if (stations.isEmpty()) {
+        if (isStationList) {
+            if (comboBox->count() == 0) {
                 QMessageBox::warning(this, "Brak połączenia", "Nie udało się pobrać danych z sieci.\nBrak zapisanych stacji.");
                 nextButton->setVisible(false);
             }
             else {
-                comboBox->clear();
-                QMessageBox::warning(this, "Brak połączenia", "Nie udało się pobrać danych z sieci.\nZaładowano dane lokalne.");
-                for (const QJsonValue &val : std::as_const(stations)) {
-                    QJsonObject obj = val.toObject();
-                    comboBox->addItem(obj["stationName"].toString(), obj["id"].toInt());
-                }
+                statusBar()->showMessage("Brak połączenia z siecią - wyświetlono zapisaną listę stacji.");
             }
-        } else if (!avoidWarning && currentStep == 2) {
-            int stationId = comboBox->currentData().toInt();
-            QJsonArray sensors = loadSensors(stationId);
-            if (sensors.isEmpty()) {
+        } else if (isSensorList && sensorListStationId == sensorsStationId && currentStep == 2) {
+            if (comboBoxSensors->count() == 0) {
                 QMessageBox::warning(this, "Brak połączenia", "Nie udało się pobrać danych z sieci.\nBrak zapisanych danych dla wybranej stacji.");
                 currentStep = 1;
                 updateUI();
             }
             else {
-                QMessageBox::warning(this, "Brak połączenia", "Nie udało się pobrać danych z sieci.\nZaładowano dane lokalne.");
-                comboBoxSensors->clear();
-                for (const QJsonValue &val : std::as_const(sensors)) {
-                    QJsonObject obj = val.toObject();
-                    QString name = obj["paramName"].toString();
-                    comboBoxSensors->addItem(name, obj["id"].toInt());
-                }
+                statusBar()->showMessage("Brak połączenia z siecią - wyświetlono zapisaną listę parametrów.");
             }
         }
-        avoidWarning=false;
         reply->deleteLater();
         return;
     }
@@ -260,29 +494,15 @@ void MainWindow::onDataReceived(QNetworkReply *reply)
     if (jsonDoc.isArray()) {
         QJsonArray jsonArray = jsonDoc.array();
 
-        if (currentStep == 1) {
-            comboBox->clear();
-            for (const QJsonValue &value : std::as_const(jsonArray)) {
-                QJsonObject obj = value.toObject();
-                QString name = obj["stationName"].toString();
-                int stationId = obj["id"].toInt();
-                if (!name.isEmpty()) {
-                    comboBox->addItem(name, stationId);
-                }
-            }
+        if (isStationList) {
+            applyItems(comboBox, stationItems(jsonArray, true));
             saveStation(jsonArray);
+            statusBar()->clearMessage();
         }
-        else if (currentStep == 2) {
-            comboBoxSensors->clear();
-            for (const QJsonValue &value : std::as_const(jsonArray)) {
-                QJsonObject sensorObj = value.toObject();
-                QJsonObject paramObj = sensorObj["param"].toObject();
-                QString paramName = paramObj["paramName"].toString();
-                int sensorId = sensorObj["id"].toInt();
-                comboBoxSensors->addItem(paramName, sensorId);
-            }
-            int stationId = comboBox->currentData().toInt();
-            saveSensors(stationId, jsonArray);
+        else if (isSensorList) {
+            if (sensorListStationId == sensorsStationId)
+                applyItems(comboBoxSensors, sensorItems(jsonArray, true));
+            saveSensors(sensorListStationId, jsonArray);
         }
     }
     else if (jsonDoc.isObject()) {
@@ -307,6 +527,84 @@ void MainWindow::onDataReceived(QNetworkReply *reply)
     updateUI();
     reply->deleteLater();
 }
+/**
+ * @brief Tworzy listę pozycji (nazwa, ID) stacji.
+ *
+ * @param stations Lista stacji z API lub z lokalnego katalogu.
+ * @param sorted true, jeśli lista jest już posortowana według nazwy (odpowiedź API).
+ * @return Lista par nazwa stacji - ID.
+ */
+QVector<QPair<QString, int>> MainWindow::stationItems(const QJsonArray &stations, bool sorted)
+{
+    QVector<QPair<QString, int>> items;
+    items.reserve(stations.size());
+    for (const QJsonValue &value : stations) {
+        QJsonObject obj = value.toObject();
+        QString name = obj["stationName"].toString();
+        if (!name.isEmpty())
+            items.append({ name, obj["id"].toInt() });
+    }
+    if (!sorted) {
+        std::sort(items.begin(), items.end(), [](const QPair<QString, int> &a, const QPair<QString, int> &b) {
+            return QString::localeAwareCompare(a.first, b.first) < 0;
+        });
+    }
+    return items;
+}
+/**
+ * @brief Tworzy listę pozycji (nazwa parametru, ID) sensorów stacji.
+ *
+ * @param sensors Lista sensorów z API lub z lokalnego katalogu.
+ * @param fromApi true dla odpowiedzi API (nazwa parametru w obiekcie "param").
+ * @return Lista par nazwa parametru - ID sensora.
+ */
+QVector<QPair<QString, int>> MainWindow::sensorItems(const QJsonArray &sensors, bool fromApi)
+{
+    QVector<QPair<QString, int>> items;
+    items.reserve(sensors.size());
+    for (const QJsonValue &value : sensors) {
+        QJsonObject obj = value.toObject();
+        QString name = fromApi ? obj["param"].toObject()["paramName"].toString() : obj["paramName"].toString();
+        items.append({ name, obj["id"].toInt() });
+    }
+    return items;
+}
+/**
+ * @brief Nanosi na listę rozwijaną różnice względem nowej listy pozycji.
+ *
+ * Pozycje niezmienione pozostają na miejscu, zmienione nazwy są poprawiane, nowe pozycje
+ * wstawiane, a nieistniejące usuwane. Wybrana pozycja jest zachowywana, jeśli nadal istnieje.
+ *
+ * @param box Lista rozwijana.
+ * @param items Docelowa lista par nazwa - ID.
+ */
+void MainWindow::applyItems(QComboBox *box, const QVector<QPair<QString, int>> &items)
+{
+    const QVariant current = box->currentData();
+    const QSignalBlocker blocker(box);
+    int position = 0;
+
+    for (const QPair<QString, int> &item : items) {
+        if (position < box->count() && box->itemData(position).toInt() == item.second) {
+            if (box->itemText(position) != item.first)
+                box->setItemText(position, item.first);
+            ++position;
+            continue;
+        }
+        const int existing = box->findData(item.second);
+        if (existing >= 0 && existing < position)
+            continue;
+        if (existing > position)
+            box->removeItem(existing);
+        box->insertItem(position, item.first, item.second);
+        ++position;
+    }
+    while (box->count() > position)
+        box->removeItem(box->count() - 1);
+
+    const int index = current.isValid() ? box->findData(current) : -1;
+    box->setCurrentIndex(index >= 0 ? index : (box->count() > 0 ? 0 : -1));
+}
 /**
  * @brief Aktualizuje stan i widoczność komponentów UI w zależności od aktualnego kroku.
  */
@@ -319,6 +617,10 @@ void MainWindow::updateUI()
     dateTimeFrom->setVisible(false);
     dateTimeTo->setVisible(false);
     generateChartButton->setVisible(false);
+    addComparisonButton->setVisible(false);
+    compareButton->setVisible(false);
+    compareButton->setText(QString("Wykres porównawczy (dodano: %1)").arg(comparisonTargets.size()));
+    compareButton->setEnabled(!comparisonTargets.isEmpty());
     dateFrom->setVisible(false);
     dateTo->setVisible(false);
 
@@ -341,6 +643,8 @@ void MainWindow::updateUI()
         dateTimeFrom->setVisible(true);
         dateTimeTo->setVisible(true);
         generateChartButton->setVisible(true);
+        addComparisonButton->setVisible(true);
+        compareButton->setVisible(true);
         dateFrom->setVisible(true);
         dateTo->setVisible(true);
         break;
@@ -14,6 +14,17 @@
 #include <QPushButton>
 #include <QLabel>
 #include <QDateTimeEdit>
+#include <QJsonArray>
+#include <QVector>
+#include <QPair>
+#include <functional>
+#include "measurementseries.h"
+#include "comparisonquery.h"
+
+class FetchService;
+class CachingNetworkManager;
+class SyncScheduler;
+class MeasurementWriter;
 
 /**
  * @class MainWindow
@@ -45,6 +56,12 @@ private slots:
     /** @brief Obsługuje kliknięcie przycisku "Wygeneruj wykres". */
     void onGenerateClicked();
 
+    /** @brief Obsługuje kliknięcie przycisku "Dodaj do porównania". */
+    void onAddComparisonClicked();
+
+    /** @brief Obsługuje kliknięcie przycisku "Wykres porównawczy". */
+    void onCompareClicked();
+
     /**
      * @brief Obsługuje odpowiedź z zapytania sieciowego.
      * @param reply Odpowiedź z serwera.
@@ -61,6 +78,27 @@ private slots:
     void updateUI();
 
 private:
+    /** @brief Wczytuje dane z lokalnej bazy, oblicza statystyki i otwiera nowe okno z wykresem. */
+    void showChart(int stationId, int sensorId, const QDateTime &from, const QDateTime &to, bool updateRollups = true);
+
+    /** @brief Wykonuje akcję po zakończeniu zlecenia zapisu sensora w MeasurementWriter. */
+    void whenSaved(int stationId, int sensorId, quint64 sequence, const std::function<void()> &action);
+
+    /** @brief Otwiera okno z wykresem porównawczym. */
+    void showComparison(const ComparisonResult &comparison);
+
+    /** @brief Zwraca sensor wybrany w formularzu jako pozycję porównania. */
+    ComparisonQuery::Target currentTarget() const;
+
+    /** @brief Tworzy listę pozycji (nazwa, ID) stacji. */
+    static QVector<QPair<QString, int>> stationItems(const QJsonArray &stations, bool sorted);
+
+    /** @brief Tworzy listę pozycji (nazwa parametru, ID) sensorów stacji. */
+    static QVector<QPair<QString, int>> sensorItems(const QJsonArray &sensors, bool fromApi);
+
+    /** @brief Nanosi na listę rozwijaną różnice względem nowej listy pozycji. */
+    void applyItems(QComboBox *box, const QVector<QPair<QString, int>> &items);
+
     QComboBox *comboBox;
     QComboBox *comboBoxSensors;
     QPushButton *backButton;
@@ -71,14 +109,20 @@ private:
     QDateTimeEdit *dateTimeFrom;
     QDateTimeEdit *dateTimeTo;
     QPushButton *generateChartButton;
+    QPushButton *addComparisonButton;
+    QPushButton *compareButton;
 
-    QNetworkAccessManager *networkManager;
+    CachingNetworkManager *networkManager;
+    FetchService *fetchService;
+    MeasurementWriter *measurementWriter;
+    SyncScheduler *syncScheduler;
     int currentStep;
     QString selectedStationName;
     QString paramName;
     QString airQuality;
     QString paramValue;
-    bool avoidWarning = false;
+    int sensorsStationId = -1;
+    QVector<ComparisonQuery::Target> comparisonTargets;
 };
 
 #endif // MAINWINDOW_H
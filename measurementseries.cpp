@@ -0,0 +1,216 @@
+/**
+ * @file measurementseries.cpp
+ * @brief Implementacja klasy MeasurementSeries.
+ */
+#include "measurementseries.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <numeric>
+
+/**
+ * @brief Tworzy serię z gotowych kolumn.
+ * @param timestamps Znaczniki czasu w milisekundach od epoki.
+ * @param values Wartości pomiarów.
+ */
+MeasurementSeries::MeasurementSeries(const QVector<qint64> &timestamps, const QVector<double> &values)
+    : timestampColumn(timestamps), valueColumn(values)
+{
+    const int count = qMin(timestampColumn.size(), valueColumn.size());
+    timestampColumn.resize(count);
+    valueColumn.resize(count);
+}
+
+/**
+ * @brief Rezerwuje miejsce na podaną liczbę pomiarów.
+ * @param count Liczba pomiarów.
+ */
+void MeasurementSeries::reserve(int count)
+{
+    timestampColumn.reserve(count);
+    valueColumn.reserve(count);
+}
+
+/**
+ * @brief Usuwa wszystkie pomiary.
+ */
+void MeasurementSeries::clear()
+{
+    timestampColumn.clear();
+    valueColumn.clear();
+}
+
+/**
+ * @brief Dodaje na końcu serii pomiary z podanych tablic.
+ * @param timestamps Znaczniki czasu.
+ * @param values Wartości.
+ * @param count Liczba pomiarów.
+ */
+void MeasurementSeries::append(const qint64 *timestamps, const double *values, int count)
+{
+    if (count <= 0)
+        return;
+    const int start = timestampColumn.size();
+    timestampColumn.resize(start + count);
+    valueColumn.resize(start + count);
+    std::memcpy(timestampColumn.data() + start, timestamps, size_t(count) * sizeof(qint64));
+    std::memcpy(valueColumn.data() + start, values, size_t(count) * sizeof(double));
+}
+
+/**
+ * @brief Dodaje na końcu serii wszystkie pomiary innej serii.
+ *
+ * Pusta seria przejmuje kolumny serii źródłowej bez kopiowania (współdzieli je).
+ *
+ * @param other Seria źródłowa.
+ */
+void MeasurementSeries::append(const MeasurementSeries &other)
+{
+    if (isEmpty()) {
+        timestampColumn = other.timestampColumn;
+        valueColumn = other.valueColumn;
+        return;
+    }
+    append(other.timestampColumn.constData(), other.valueColumn.constData(), other.size());
+}
+
+/**
+ * @brief Scala posortowaną serię z inną posortowaną serią, zachowując porządek czasu.
+ *
+ * Pomiary późniejsze od ostatniego są jedynie dopisywane. W pozostałych przypadkach
+ * przepisywana jest tylko część serii od pierwszego pomiaru późniejszego niż początek
+ * drugiej serii. Przy równych znacznikach czasu pomiary tej serii występują pierwsze.
+ *
+ * @param other Seria posortowana według czasu.
+ */
+void MeasurementSeries::mergeSorted(const MeasurementSeries &other)
+{
+    if (other.isEmpty())
+        return;
+    if (isEmpty() || other.timestamp(0) >= timestampColumn.last()) {
+        append(other);
+        return;
+    }
+
+    const int start = int(std::upper_bound(timestampColumn.constBegin(), timestampColumn.constEnd(), other.timestamp(0))
+                          - timestampColumn.constBegin());
+    const QVector<qint64> tailTimestamps = timestampColumn.mid(start);
+    const QVector<double> tailValues = valueColumn.mid(start);
+    timestampColumn.resize(start);
+    valueColumn.resize(start);
+    reserve(start + tailTimestamps.size() + other.size());
+
+    int i = 0, j = 0;
+    while (i < tailTimestamps.size() || j < other.size()) {
+        if (j == other.size() || (i < tailTimestamps.size() && tailTimestamps[i] <= other.timestamp(j))) {
+            append(tailTimestamps[i], tailValues[i]);
+            ++i;
+        } else {
+            append(other.timestamp(j), other.value(j));
+            ++j;
+        }
+    }
+}
+
+/**
+ * @brief Sprawdza, czy znaczniki czasu są niemalejące.
+ * @return true, jeśli seria jest posortowana.
+ */
+bool MeasurementSeries::isSorted() const
+{
+    return std::is_sorted(timestampColumn.constBegin(), timestampColumn.constEnd());
+}
+
+/**
+ * @brief Sortuje pomiary rosnąco według czasu (stabilnie).
+ *
+ * Seria ściśle malejąca (np. od najnowszego pomiaru) jest jedynie odwracana,
+ * w pozostałych przypadkach sortowana jest permutacja indeksów, a kolumny
+ * przepisywane są jednokrotnie.
+ */
+void MeasurementSeries::sortByTime()
+{
+    if (isSorted())
+        return;
+
+    const bool strictlyDecreasing = std::adjacent_find(timestampColumn.constBegin(), timestampColumn.constEnd(),
+                                                       std::less_equal<qint64>()) == timestampColumn.constEnd();
+    if (strictlyDecreasing) {
+        std::reverse(timestampColumn.begin(), timestampColumn.end());
+        std::reverse(valueColumn.begin(), valueColumn.end());
+        return;
+    }
+
+    QVector<int> order(size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return timestampColumn[a] < timestampColumn[b];
+    });
+
+    QVector<qint64> sortedTimestamps(size());
+    QVector<double> sortedValues(size());
+    for (int i = 0; i < order.size(); ++i) {
+        sortedTimestamps[i] = timestampColumn[order[i]];
+        sortedValues[i] = valueColumn[order[i]];
+    }
+    timestampColumn.swap(sortedTimestamps);
+    valueColumn.swap(sortedValues);
+}
+
+/**
+ * @brief Sortuje pomiary według czasu i usuwa powtórzone znaczniki czasu.
+ *
+ * Przy powtórzeniach zachowywany jest pomiar występujący wcześniej w serii. Seria
+ * już posortowana i bez powtórzeń nie jest modyfikowana, więc nie traci współdzielonych
+ * kolumn.
+ */
+void MeasurementSeries::sortUnique()
+{
+    sortByTime();
+
+    const auto duplicate = std::adjacent_find(timestampColumn.constBegin(), timestampColumn.constEnd());
+    if (duplicate == timestampColumn.constEnd())
+        return;
+
+    int out = int(duplicate - timestampColumn.constBegin()) + 1;
+    for (int i = out; i < size(); ++i) {
+        if (out > 0 && timestampColumn[out - 1] == timestampColumn[i])
+            continue;
+        timestampColumn[out] = timestampColumn[i];
+        valueColumn[out] = valueColumn[i];
+        ++out;
+    }
+    timestampColumn.resize(out);
+    valueColumn.resize(out);
+}
+
+/**
+ * @brief Zwraca indeks pierwszego pomiaru nie wcześniejszego niż podany czas.
+ * @param timestamp Znacznik czasu w milisekundach od epoki.
+ * @return Indeks w zakresie [0, size()].
+ */
+int MeasurementSeries::lowerBound(qint64 timestamp) const
+{
+    return int(std::lower_bound(timestampColumn.constBegin(), timestampColumn.constEnd(), timestamp)
+               - timestampColumn.constBegin());
+}
+
+/**
+ * @brief Zwraca fragment posortowanej serii z przedziału [from, to].
+ * @param from Początek przedziału w milisekundach od epoki.
+ * @param to Koniec przedziału w milisekundach od epoki.
+ * @return Seria z pomiarami z przedziału; przedział obejmujący całą serię zwraca serię
+ *         współdzielącą kolumny z tą serią.
+ */
+MeasurementSeries MeasurementSeries::range(qint64 from, qint64 to) const
+{
+    const int begin = lowerBound(from);
+    const int end = int(std::upper_bound(timestampColumn.constBegin() + begin, timestampColumn.constEnd(), to)
+                        - timestampColumn.constBegin());
+    if (begin == 0 && end == size())
+        return *this;
+
+    MeasurementSeries result;
+    result.append(timestampColumn.constData() + begin, valueColumn.constData() + begin, end - begin);
+    return result;
+}
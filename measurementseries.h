@@ -0,0 +1,122 @@
+/**
+ * @file measurementseries.h
+ * @brief Definicja klasy MeasurementSeries - serii pomiarów przechowywanej kolumnowo.
+ */
+
+#ifndef MEASUREMENTSERIES_H
+#define MEASUREMENTSERIES_H
+
+#include <QVector>
+#include <QDateTime>
+
+/**
+ * @class MeasurementSeries
+ * @brief Seria pomiarów w układzie struktury tablic.
+ *
+ * Znaczniki czasu (milisekundy od epoki UTC) i wartości przechowywane są w dwóch
+ * osobnych, ciągłych tablicach. Sortowanie, filtrowanie po czasie i przeglądanie wartości
+ * działa więc na zwartych blokach pamięci, bez obiektów QDateTime dla każdego pomiaru.
+ *
+ * Kolumny są współdzielone niejawnie (z licznikiem referencji), więc kopia serii - także
+ * przekazanej sygnałem między wątkami - nie kopiuje pomiarów. Wszyscy odbiorcy serii
+ * pobranej przez DataWorker (wykres, statystyki, zapis) czytają ten sam bufor; własną
+ * kopię tworzy dopiero modyfikacja serii współdzielonej. Metody, które nie zmieniają
+ * danych (np. sortUnique() dla serii już uporządkowanej), pozostawiają bufor wspólny.
+ */
+class MeasurementSeries
+{
+public:
+    /** @brief Tworzy pustą serię. */
+    MeasurementSeries() = default;
+
+    /**
+     * @brief Tworzy serię z gotowych kolumn.
+     * @param timestamps Znaczniki czasu w milisekundach od epoki.
+     * @param values Wartości pomiarów (tej samej długości co timestamps).
+     */
+    MeasurementSeries(const QVector<qint64> &timestamps, const QVector<double> &values);
+
+    /** @brief Zwraca liczbę pomiarów. */
+    int size() const { return timestampColumn.size(); }
+
+    /** @brief Sprawdza, czy seria jest pusta. */
+    bool isEmpty() const { return timestampColumn.isEmpty(); }
+
+    /** @brief Rezerwuje miejsce na podaną liczbę pomiarów. */
+    void reserve(int count);
+
+    /** @brief Usuwa wszystkie pomiary. */
+    void clear();
+
+    /**
+     * @brief Dodaje pomiar na końcu serii.
+     * @param timestamp Znacznik czasu w milisekundach od epoki.
+     * @param value Wartość pomiaru.
+     */
+    void append(qint64 timestamp, double value)
+    {
+        timestampColumn.append(timestamp);
+        valueColumn.append(value);
+    }
+
+    /**
+     * @brief Dodaje na końcu serii pomiary z podanych tablic.
+     * @param timestamps Znaczniki czasu.
+     * @param values Wartości.
+     * @param count Liczba pomiarów.
+     */
+    void append(const qint64 *timestamps, const double *values, int count);
+
+    /** @brief Dodaje na końcu serii wszystkie pomiary innej serii (pusta seria współdzieli jej kolumny). */
+    void append(const MeasurementSeries &other);
+
+    /**
+     * @brief Scala posortowaną serię z inną posortowaną serią, zachowując porządek czasu.
+     * @param other Seria posortowana według czasu.
+     */
+    void mergeSorted(const MeasurementSeries &other);
+
+    /** @brief Zwraca znacznik czasu pomiaru o podanym indeksie. */
+    qint64 timestamp(int index) const { return timestampColumn[index]; }
+
+    /** @brief Zwraca wartość pomiaru o podanym indeksie. */
+    double value(int index) const { return valueColumn[index]; }
+
+    /** @brief Zwraca czas pomiaru o podanym indeksie jako czas lokalny. */
+    QDateTime dateTime(int index) const { return QDateTime::fromMSecsSinceEpoch(timestampColumn[index]); }
+
+    /** @brief Zwraca kolumnę znaczników czasu. */
+    const QVector<qint64> &timestamps() const { return timestampColumn; }
+
+    /** @brief Zwraca kolumnę wartości. */
+    const QVector<double> &values() const { return valueColumn; }
+
+    /** @brief Sprawdza, czy znaczniki czasu są niemalejące. */
+    bool isSorted() const;
+
+    /** @brief Sortuje pomiary rosnąco według czasu (stabilnie). */
+    void sortByTime();
+
+    /** @brief Sortuje pomiary według czasu i usuwa powtórzone znaczniki czasu, zachowując pierwszy pomiar. */
+    void sortUnique();
+
+    /**
+     * @brief Zwraca indeks pierwszego pomiaru nie wcześniejszego niż podany czas.
+     * @param timestamp Znacznik czasu w milisekundach od epoki.
+     * @return Indeks w zakresie [0, size()]. Seria musi być posortowana.
+     */
+    int lowerBound(qint64 timestamp) const;
+
+    /**
+     * @brief Zwraca fragment posortowanej serii z przedziału [from, to].
+     * @param from Początek przedziału w milisekundach od epoki.
+     * @param to Koniec przedziału w milisekundach od epoki.
+     */
+    MeasurementSeries range(qint64 from, qint64 to) const;
+
+private:
+    QVector<qint64> timestampColumn;
+    QVector<double> valueColumn;
+};
+
+#endif // MEASUREMENTSERIES_H
@@ -0,0 +1,997 @@
+/**
+ * @file measurementstore.cpp
+ * @brief Implementacja binarnego, kolumnowego magazynu pomiarów.
+ */
+#include "measurementstore.h"
+#include "gorillacodec.h"
+#include <QSaveFile>
+#include <QtGlobal>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+#error "Format pliku pomiarów zakłada kolejność bajtów little-endian."
+#endif
+
+namespace {
+
+const char FileMagic[4] = { 'J', 'P', 'M', 'S' };
+const quint16 FormatVersion = 1;
+const char IndexMagic[4] = { 'J', 'P', 'M', 'X' };
+
+/** @brief Rozmiar fragmentu kopiowanego przy przepisywaniu pliku. */
+const qint64 CopyChunkBytes = 4 * 1024 * 1024;
+
+/**
+ * @struct FileHeader
+ * @brief Nagłówek pliku z pomiarami.
+ */
+struct FileHeader {
+    char magic[4];
+    quint16 version;
+    quint16 codec;
+    quint32 blockCapacity;
+    quint32 blockCount;
+    quint64 pointCount;
+    qint64 maxTimestamp;
+};
+
+/**
+ * @struct BlockHeader
+ * @brief Nagłówek pojedynczego bloku. Kolumny bloku zaczynają się zaraz po nim.
+ */
+struct BlockHeader {
+    quint32 count;
+    quint32 payloadBytes;
+    qint64 minTimestamp;
+    qint64 maxTimestamp;
+    qint64 reserved;
+};
+
+/**
+ * @struct IndexHeader
+ * @brief Nagłówek pliku indeksu; po nim następuje blockCount wpisów IndexEntry.
+ */
+struct IndexHeader {
+    char magic[4];
+    quint32 blockCount;
+};
+
+/**
+ * @struct IndexEntry
+ * @brief Wpis rzadkiego indeksu: położenie bloku oraz czas jego pierwszego i ostatniego pomiaru.
+ */
+struct IndexEntry {
+    qint64 offset;
+    qint64 minTimestamp;
+    qint64 maxTimestamp;
+};
+
+static_assert(sizeof(FileHeader) == 32, "Nieprawidłowy rozmiar nagłówka pliku");
+static_assert(sizeof(BlockHeader) == 32, "Nieprawidłowy rozmiar nagłówka bloku");
+static_assert(sizeof(IndexHeader) == 8, "Nieprawidłowy rozmiar nagłówka indeksu");
+static_assert(sizeof(IndexEntry) == 24, "Nieprawidłowy rozmiar wpisu indeksu");
+
+/**
+ * @struct BlockIndex
+ * @brief Rzadki indeks bloków pliku wczytany do pamięci.
+ */
+struct BlockIndex {
+    QVector<IndexEntry> entries;
+    qint64 end = qint64(sizeof(FileHeader)); ///< Koniec ostatniego bloku.
+};
+
+/**
+ * @brief Zwraca rozmiar bloku w bajtach (nagłówek i obie kolumny).
+ * @param capacity Pojemność bloku.
+ */
+qint64 blockBytes(quint32 capacity)
+{
+    return qint64(sizeof(BlockHeader)) + qint64(capacity) * qint64(sizeof(qint64) + sizeof(double));
+}
+
+/**
+ * @brief Zwraca położenie bloku w pliku.
+ * @param capacity Pojemność bloku.
+ * @param index Numer bloku.
+ */
+qint64 blockOffset(quint32 capacity, quint32 index)
+{
+    return qint64(sizeof(FileHeader)) + qint64(index) * blockBytes(capacity);
+}
+
+/**
+ * @brief Sprawdza poprawność nagłówka pliku.
+ * @param header Nagłówek odczytany z pliku.
+ */
+bool isValidHeader(const FileHeader &header)
+{
+    return std::memcmp(header.magic, FileMagic, sizeof(FileMagic)) == 0
+           && header.version == FormatVersion
+           && (header.codec == MeasurementStore::Raw || header.codec == MeasurementStore::Gorilla)
+           && header.blockCapacity > 0;
+}
+
+/**
+ * @brief Tworzy nagłówek pustego pliku.
+ * @param codec Sposób zapisu bloków.
+ */
+FileHeader makeHeader(MeasurementStore::Codec codec)
+{
+    FileHeader header;
+    std::memcpy(header.magic, FileMagic, sizeof(FileMagic));
+    header.version = FormatVersion;
+    header.codec = quint16(codec);
+    header.blockCapacity = MeasurementStore::BlockCapacity;
+    header.blockCount = 0;
+    header.pointCount = 0;
+    header.maxTimestamp = std::numeric_limits<qint64>::min();
+    return header;
+}
+
+/**
+ * @brief Buduje kompletny blok zawierający podane pomiary.
+ * @param timestamps Znaczniki czasu.
+ * @param values Wartości.
+ * @param count Liczba pomiarów (nie większa niż pojemność).
+ * @param capacity Pojemność bloku.
+ */
+QByteArray makeBlock(const qint64 *timestamps, const double *values, quint32 count, quint32 capacity)
+{
+    QByteArray block(blockBytes(capacity), '\0');
+    BlockHeader header;
+    header.count = count;
+    header.payloadBytes = capacity * quint32(sizeof(qint64) + sizeof(double));
+    header.minTimestamp = *std::min_element(timestamps, timestamps + count);
+    header.maxTimestamp = *std::max_element(timestamps, timestamps + count);
+    header.reserved = 0;
+
+    char *out = block.data();
+    std::memcpy(out, &header, sizeof(header));
+    std::memcpy(out + sizeof(BlockHeader), timestamps, count * sizeof(qint64));
+    std::memcpy(out + sizeof(BlockHeader) + capacity * sizeof(qint64), values, count * sizeof(double));
+    return block;
+}
+
+/**
+ * @brief Buduje skompresowany blok zawierający podane pomiary.
+ *
+ * Blok ma rozmiar nagłówka i skompresowanych danych (payloadBytes), więc bloki
+ * skompresowanego pliku mają różne rozmiary.
+ *
+ * @param timestamps Znaczniki czasu (posortowane).
+ * @param values Wartości.
+ * @param count Liczba pomiarów (nie większa niż pojemność).
+ */
+QByteArray makeCompressedBlock(const qint64 *timestamps, const double *values, quint32 count)
+{
+    const QByteArray payload = gorillaEncode(timestamps, values, int(count));
+    BlockHeader header;
+    header.count = count;
+    header.payloadBytes = quint32(payload.size());
+    header.minTimestamp = timestamps[0];
+    header.maxTimestamp = timestamps[count - 1];
+    header.reserved = 0;
+
+    QByteArray block(reinterpret_cast<const char *>(&header), sizeof(header));
+    block.append(payload);
+    return block;
+}
+
+/**
+ * @brief Buduje kolejne bloki dla posortowanych pomiarów.
+ * @param timestamps Znaczniki czasu.
+ * @param values Wartości.
+ * @param count Liczba pomiarów.
+ * @param header Nagłówek pliku (sposób zapisu i pojemność bloków); liczba bloków jest zwiększana.
+ * @return Bloki gotowe do zapisu jeden za drugim.
+ */
+QByteArray makeBlocks(const qint64 *timestamps, const double *values, int count, FileHeader &header)
+{
+    const quint32 capacity = header.blockCapacity;
+    QByteArray blocks;
+    if (header.codec == MeasurementStore::Raw)
+        blocks.reserve(int(((count + capacity - 1) / capacity) * blockBytes(capacity)));
+    for (int i = 0; i < count; i += int(capacity)) {
+        const quint32 n = quint32(qMin(int(capacity), count - i));
+        blocks.append(header.codec == MeasurementStore::Raw ? makeBlock(timestamps + i, values + i, n, capacity)
+                                                             : makeCompressedBlock(timestamps + i, values + i, n));
+        ++header.blockCount;
+    }
+    return blocks;
+}
+
+/**
+ * @brief Zapisuje dane pod wskazanym położeniem w pliku.
+ */
+bool writeAt(QFile &file, qint64 offset, const void *data, qint64 size)
+{
+    return file.seek(offset) && file.write(static_cast<const char *>(data), size) == size;
+}
+
+/**
+ * @brief Odczytuje dane spod wskazanego położenia w pliku.
+ */
+bool readAt(QFile &file, qint64 offset, void *data, qint64 size)
+{
+    return file.seek(offset) && file.read(static_cast<char *>(data), size) == size;
+}
+
+/**
+ * @brief Przekazuje bufory pliku do systemu i czeka na zapisanie danych na dysku.
+ *
+ * QFile::flush przekazuje dane tylko do systemu operacyjnego, który może je zapisać na dysk
+ * w dowolnej kolejności. Zapisy w miejscu rozdzielone są więc tą funkcją: dane muszą trafić
+ * na dysk przed nagłówkiem, który je zatwierdza.
+ *
+ * @param file Plik otwarty do zapisu.
+ * @return true, jeśli dane zostały zapisane.
+ */
+bool syncToDisk(QFile &file)
+{
+    if (!file.flush())
+        return false;
+#if defined(Q_OS_WIN)
+    return _commit(file.handle()) == 0;
+#elif defined(Q_OS_DARWIN)
+    return ::fsync(file.handle()) == 0;
+#else
+    return ::fdatasync(file.handle()) == 0;
+#endif
+}
+
+/**
+ * @brief Odczytuje nagłówek pliku i sprawdza jego poprawność.
+ */
+bool readHeader(QFile &file, FileHeader &header)
+{
+    return readAt(file, 0, &header, sizeof(header)) && isValidHeader(header);
+}
+
+/**
+ * @brief Zwraca ścieżkę pliku indeksu zapisywanego obok pliku z pomiarami.
+ * @param path Ścieżka do pliku z pomiarami.
+ */
+QString indexPath(const QString &path)
+{
+    return path + ".idx";
+}
+
+/**
+ * @brief Zwraca położenie bloku lub, dla numeru równego liczbie bloków, koniec ostatniego bloku.
+ */
+qint64 blockStart(const BlockIndex &index, quint32 block)
+{
+    return block < quint32(index.entries.size()) ? index.entries[int(block)].offset : index.end;
+}
+
+/**
+ * @brief Dopisuje do indeksu wpisy kolejnych bloków, odczytując ich nagłówki.
+ *
+ * Bloki nieskompresowane mają stały rozmiar, więc ich położenie wynika z numeru. Bloki
+ * skompresowane odnajdywane są przez przejście po nagłówkach (każdy podaje rozmiar danych).
+ *
+ * @param file Otwarty plik z pomiarami.
+ * @param header Nagłówek pliku.
+ * @param offset Położenie pierwszego bloku bez wpisu w indeksie.
+ * @param index Indeks uzupełniany do liczby bloków z nagłówka pliku.
+ * @return false, jeśli nagłówki bloków są uszkodzone.
+ */
+bool readBlockEntries(QFile &file, const FileHeader &header, qint64 offset, BlockIndex &index)
+{
+    if (header.codec == MeasurementStore::Raw
+        && offset != blockOffset(header.blockCapacity, quint32(index.entries.size())))
+        return false;
+    index.entries.reserve(int(header.blockCount));
+    for (quint32 b = quint32(index.entries.size()); b < header.blockCount; ++b) {
+        BlockHeader blockHeader;
+        if (!readAt(file, offset, &blockHeader, sizeof(blockHeader)) || blockHeader.count > header.blockCapacity)
+            return false;
+        index.entries.append({ offset, blockHeader.minTimestamp, blockHeader.maxTimestamp });
+        offset += header.codec == MeasurementStore::Raw ? blockBytes(header.blockCapacity)
+                                                        : qint64(sizeof(BlockHeader)) + blockHeader.payloadBytes;
+    }
+    index.end = offset;
+    return offset <= file.size();
+}
+
+/**
+ * @brief Sprawdza, czy wpisy odczytane z pliku indeksu mogą opisywać bloki pliku.
+ *
+ * Bloki leżą jeden za drugim od końca nagłówka pliku, a ich pomiary są posortowane
+ * i nie powtarzają się. Uszkodzony plik indeksu jest dzięki temu odrzucany bez czytania bloków.
+ *
+ * @param header Nagłówek pliku.
+ * @param entries Wpisy indeksu.
+ */
+bool isValidIndex(const FileHeader &header, const QVector<IndexEntry> &entries)
+{
+    for (int i = 0; i < entries.size(); ++i) {
+        const IndexEntry &entry = entries[i];
+        const bool placed = header.codec == MeasurementStore::Raw || i == 0
+                                ? entry.offset == blockOffset(header.blockCapacity, quint32(i))
+                                : entry.offset >= entries[i - 1].offset + qint64(sizeof(BlockHeader));
+        if (!placed || entry.minTimestamp > entry.maxTimestamp
+            || (i > 0 && entries[i - 1].maxTimestamp >= entry.minTimestamp))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Zapisuje rzadki indeks bloków do pliku indeksu.
+ *
+ * Indeks jest tylko pomocniczy, więc błąd zapisu nie jest błędem magazynu: brakujący indeks
+ * jest odbudowywany przy następnym odczycie.
+ *
+ * @param path Ścieżka do pliku z pomiarami.
+ * @param index Indeks bloków.
+ * @return true, jeśli zapis się powiódł.
+ */
+bool saveBlockIndex(const QString &path, const BlockIndex &index)
+{
+    IndexHeader indexHeader;
+    std::memcpy(indexHeader.magic, IndexMagic, sizeof(IndexMagic));
+    indexHeader.blockCount = quint32(index.entries.size());
+    const qint64 entryBytes = qint64(index.entries.size()) * qint64(sizeof(IndexEntry));
+
+    QSaveFile out(indexPath(path));
+    if (!out.open(QIODevice::WriteOnly)
+        || out.write(reinterpret_cast<const char *>(&indexHeader), sizeof(indexHeader)) != qint64(sizeof(indexHeader))
+        || out.write(reinterpret_cast<const char *>(index.entries.constData()), entryBytes) != entryBytes)
+        return false;
+    return out.commit();
+}
+
+/**
+ * @brief Wczytuje rzadki indeks bloków, uzupełniając go o bloki dopisane od jego zapisu.
+ *
+ * Z pliku indeksu brane są wpisy bloków zatwierdzonych w nagłówku pliku. Ostatni z nich
+ * (blok nieskompresowany mógł zostać od tego czasu uzupełniony) i wszystkie późniejsze
+ * odczytywane są z nagłówków bloków, więc koszt zależy od liczby bloków dopisanych od
+ * zapisu indeksu, a nie od rozmiaru pliku. Indeks uszkodzony (isValidIndex) lub niezgodny
+ * z plikiem (inny czas pierwszego pomiaru ponownie odczytanego bloku) budowany jest od nowa.
+ * Zmieniony indeks jest zapisywany.
+ *
+ * @param file Otwarty plik z pomiarami.
+ * @param header Nagłówek pliku.
+ * @param index Indeks bloków.
+ * @return false, jeśli nagłówki bloków są uszkodzone.
+ */
+bool loadBlockIndex(QFile &file, const FileHeader &header, BlockIndex &index)
+{
+    index.entries.clear();
+    IndexHeader indexHeader;
+    QFile stored(indexPath(file.fileName()));
+    if (stored.open(QIODevice::ReadOnly) && readAt(stored, 0, &indexHeader, sizeof(indexHeader))
+        && std::memcmp(indexHeader.magic, IndexMagic, sizeof(IndexMagic)) == 0) {
+        index.entries.resize(int(qMin(indexHeader.blockCount, header.blockCount)));
+        if (!readAt(stored, sizeof(indexHeader), index.entries.data(),
+                    qint64(index.entries.size()) * qint64(sizeof(IndexEntry)))
+            || !isValidIndex(header, index.entries))
+            index.entries.clear();
+    } else {
+        indexHeader.blockCount = 0;
+    }
+    stored.close();
+
+    bool unchanged = false;
+    if (!index.entries.isEmpty()) {
+        const int last = index.entries.size() - 1;
+        const IndexEntry stale = index.entries.takeLast();
+        if (readBlockEntries(file, header, stale.offset, index)
+            && index.entries[last].minTimestamp == stale.minTimestamp)
+            unchanged = indexHeader.blockCount == header.blockCount
+                        && index.entries[last].maxTimestamp == stale.maxTimestamp;
+        else
+            index.entries.clear();
+    }
+    if (index.entries.isEmpty() && !readBlockEntries(file, header, qint64(sizeof(FileHeader)), index))
+        return false;
+    if (!unchanged)
+        saveBlockIndex(file.fileName(), index);
+    return true;
+}
+
+/**
+ * @brief Aktualizuje plik indeksu po zatwierdzeniu zapisu pliku z pomiarami.
+ * @param path Ścieżka do pliku z pomiarami.
+ */
+void updateBlockIndex(const QString &path)
+{
+    QFile file(path);
+    FileHeader header;
+    BlockIndex index;
+    if (file.open(QIODevice::ReadOnly) && readHeader(file, header))
+        loadBlockIndex(file, header, index);
+}
+
+/**
+ * @brief Ogranicza plik indeksu do podanej liczby początkowych bloków.
+ *
+ * Wywoływana przed podmianą pliku z pomiarami, w którym zmieniają się bloki od podanego:
+ * ich wpisy przestają być ważne jeszcze przed zatwierdzeniem zapisu.
+ *
+ * @param path Ścieżka do pliku z pomiarami.
+ * @param blockCount Liczba bloków, które pozostają bez zmian.
+ * @return true, jeśli indeks nie opisuje już zmienianych bloków.
+ */
+bool truncateBlockIndex(const QString &path, quint32 blockCount)
+{
+    if (!QFile::exists(indexPath(path)))
+        return true;
+    QFile stored(indexPath(path));
+    IndexHeader indexHeader;
+    if (!stored.open(QIODevice::ReadWrite) || !readAt(stored, 0, &indexHeader, sizeof(indexHeader))) {
+        stored.close();
+        return QFile::remove(indexPath(path));
+    }
+    if (indexHeader.blockCount <= blockCount)
+        return true;
+    indexHeader.blockCount = blockCount;
+    return writeAt(stored, 0, &indexHeader, sizeof(indexHeader)) && syncToDisk(stored);
+}
+
+/**
+ * @brief Wyszukuje binarnie w indeksie pierwszy blok, którego najpóźniejszy pomiar nie jest
+ * wcześniejszy od podanego czasu.
+ * @param index Indeks bloków.
+ * @param timestamp Szukany znacznik czasu.
+ * @return Numer bloku lub liczba bloków, jeśli żaden nie pasuje.
+ */
+quint32 findBlock(const BlockIndex &index, qint64 timestamp)
+{
+    const auto found = std::partition_point(index.entries.begin(), index.entries.end(),
+                                            [timestamp](const IndexEntry &entry) {
+                                                return entry.maxTimestamp < timestamp;
+                                            });
+    return quint32(found - index.entries.begin());
+}
+
+/**
+ * @brief Ogranicza liczbę pomiarów bloku do liczby zatwierdzonej nagłówkiem pliku.
+ *
+ * W pliku nieskompresowanym wszystkie bloki poza ostatnim są pełne, więc liczbę pomiarów
+ * ostatniego bloku wyznacza liczba pomiarów w nagłówku pliku. appendTail uzupełnia ostatni
+ * blok w miejscu i zapisuje jego nagłówek przed nagłówkiem pliku; po przerwanym zapisie
+ * niezatwierdzone pomiary są dzięki temu pomijane.
+ *
+ * @param header Nagłówek pliku.
+ * @param index Numer bloku.
+ * @param blockHeader Nagłówek bloku do poprawienia.
+ */
+void clampToHeader(const FileHeader &header, quint32 index, BlockHeader &blockHeader)
+{
+    if (header.codec != MeasurementStore::Raw || index + 1 != header.blockCount)
+        return;
+    const quint64 full = quint64(index) * header.blockCapacity;
+    const quint64 committed = header.pointCount > full ? header.pointCount - full : 0;
+    if (committed < blockHeader.count)
+        blockHeader.count = quint32(committed);
+}
+
+/**
+ * @brief Odczytuje pomiary bloku i dopisuje je do serii.
+ * @param file Otwarty plik z pomiarami.
+ * @param header Nagłówek pliku.
+ * @param blockIndex Indeks bloków (loadBlockIndex).
+ * @param index Numer bloku.
+ * @param series Seria, do której trafią pomiary.
+ * @return true, jeśli odczyt się powiódł.
+ */
+bool readBlock(QFile &file, const FileHeader &header, const BlockIndex &blockIndex, quint32 index,
+               MeasurementSeries &series)
+{
+    const qint64 offset = blockIndex.entries[int(index)].offset;
+    BlockHeader blockHeader;
+    if (!readAt(file, offset, &blockHeader, sizeof(blockHeader)) || blockHeader.count > header.blockCapacity)
+        return false;
+    clampToHeader(header, index, blockHeader);
+
+    const int n = int(blockHeader.count);
+    const qint64 columnStart = offset + qint64(sizeof(BlockHeader));
+    if (header.codec != MeasurementStore::Raw) {
+        QByteArray payload(int(blockHeader.payloadBytes), Qt::Uninitialized);
+        return readAt(file, columnStart, payload.data(), payload.size())
+               && gorillaDecode(payload.constData(), payload.size(), n, std::numeric_limits<qint64>::min(),
+                                std::numeric_limits<qint64>::max(), series);
+    }
+
+    QVector<qint64> timestamps(n);
+    QVector<double> values(n);
+    if (!readAt(file, columnStart, timestamps.data(), n * qint64(sizeof(qint64)))
+        || !readAt(file, columnStart + qint64(header.blockCapacity) * qint64(sizeof(qint64)),
+                   values.data(), n * qint64(sizeof(double))))
+        return false;
+    series.append(timestamps.constData(), values.constData(), n);
+    return true;
+}
+
+/**
+ * @brief Zapisuje nowe bloki za ostatnim blokiem pliku i zatwierdza je zapisem nagłówka.
+ *
+ * Dopóki nagłówek pliku nie zostanie zapisany, nowe bloki leżą poza zakresem wskazywanym
+ * przez liczbę bloków i są pomijane przy odczycie, więc przerwany zapis nie zmienia
+ * zawartości pliku. Pozostałości takiego zapisu są nadpisywane przy następnym dopisaniu.
+ * Bloki są zapisywane na dysk (syncToDisk) przed nagłówkiem, a nagłówek zaraz po nim.
+ * Po zatwierdzeniu indeks bloków uzupełniany jest o nowe bloki.
+ *
+ * @param file Plik otwarty do odczytu i zapisu.
+ * @param header Nagłówek pliku.
+ * @param blockIndex Indeks bloków (loadBlockIndex).
+ * @param series Posortowane pomiary późniejsze od wszystkich zapisanych.
+ * @return true, jeśli zapis się powiódł.
+ */
+bool appendBlocks(QFile &file, FileHeader header, const BlockIndex &blockIndex, const MeasurementSeries &series)
+{
+    const qint64 writeOffset = blockIndex.end;
+    const QByteArray blocks = makeBlocks(series.timestamps().constData(), series.values().constData(),
+                                         series.size(), header);
+    if (!writeAt(file, writeOffset, blocks.constData(), blocks.size())
+        || !file.resize(writeOffset + blocks.size()) || !syncToDisk(file))
+        return false;
+
+    header.pointCount += quint64(series.size());
+    header.maxTimestamp = series.timestamps().last();
+    if (!writeAt(file, 0, &header, sizeof(header)) || !syncToDisk(file))
+        return false;
+    updateBlockIndex(file.fileName());
+    return true;
+}
+
+/**
+ * @brief Przepisuje plik, scalając pomiary z blokami od podanego bloku do końca.
+ *
+ * Plik zapisywany jest na nowo przez QSaveFile: niezmienione bloki początkowe są kopiowane,
+ * a po nich zapisywana jest scalona końcówka. Przerwany zapis nie uszkadza więc
+ * istniejącego pliku. Przy powtórzonych znacznikach czasu zachowywany jest pomiar z pliku.
+ * Przed podmianą pliku indeks bloków jest ograniczany do niezmienionych bloków
+ * początkowych, a po niej uzupełniany o bloki przepisanej końcówki.
+ *
+ * @param path Ścieżka do pliku.
+ * @param file Plik otwarty do odczytu.
+ * @param header Nagłówek pliku.
+ * @param blockIndex Indeks bloków (loadBlockIndex).
+ * @param first Pierwszy przepisywany blok.
+ * @param series Posortowane pomiary bez powtórzeń.
+ * @return Liczba dopisanych pomiarów lub -1 w przypadku błędu.
+ */
+int rewriteFromBlock(const QString &path, QFile &file, FileHeader header, const BlockIndex &blockIndex,
+                     quint32 first, const MeasurementSeries &series)
+{
+    const QVector<qint64> &timestamps = series.timestamps();
+    const QVector<double> &values = series.values();
+
+    MeasurementSeries old;
+    for (quint32 b = first; b < header.blockCount; ++b) {
+        if (!readBlock(file, header, blockIndex, b, old))
+            return -1;
+    }
+    const QVector<qint64> &oldTimestamps = old.timestamps();
+    const QVector<double> &oldValues = old.values();
+
+    QVector<qint64> mergedTimestamps;
+    QVector<double> mergedValues;
+    mergedTimestamps.reserve(oldTimestamps.size() + timestamps.size());
+    mergedValues.reserve(oldTimestamps.size() + timestamps.size());
+
+    int i = 0, j = 0, added = 0;
+    while (i < oldTimestamps.size() || j < timestamps.size()) {
+        if (j == timestamps.size() || (i < oldTimestamps.size() && oldTimestamps[i] <= timestamps[j])) {
+            if (j < timestamps.size() && oldTimestamps[i] == timestamps[j])
+                ++j;
+            mergedTimestamps.append(oldTimestamps[i]);
+            mergedValues.append(oldValues[i]);
+            ++i;
+        } else {
+            mergedTimestamps.append(timestamps[j]);
+            mergedValues.append(values[j]);
+            ++j;
+            ++added;
+        }
+    }
+    if (added == 0)
+        return 0;
+
+    header.blockCount = first;
+    const QByteArray blocks = makeBlocks(mergedTimestamps.constData(), mergedValues.constData(),
+                                         mergedTimestamps.size(), header);
+    header.pointCount += quint64(added);
+    header.maxTimestamp = qMax(header.maxTimestamp, mergedTimestamps.last());
+
+    QSaveFile out(path);
+    if (!out.open(QIODevice::WriteOnly)
+        || out.write(reinterpret_cast<const char *>(&header), sizeof(header)) != qint64(sizeof(header)))
+        return -1;
+    const qint64 prefixEnd = blockStart(blockIndex, first);
+    QByteArray chunk;
+    for (qint64 offset = qint64(sizeof(header)); offset < prefixEnd; offset += chunk.size()) {
+        if (!file.seek(offset))
+            return -1;
+        chunk = file.read(qMin<qint64>(CopyChunkBytes, prefixEnd - offset));
+        if (chunk.isEmpty() || out.write(chunk) != chunk.size())
+            return -1;
+    }
+    if (out.write(blocks) != blocks.size() || !truncateBlockIndex(path, first))
+        return -1;
+    file.close();
+    if (!out.commit())
+        return -1;
+    updateBlockIndex(path);
+    return added;
+}
+
+/**
+ * @class MappedFile
+ * @brief Plik z pomiarami zmapowany w pamięć tylko do odczytu.
+ */
+class MappedFile
+{
+public:
+    explicit MappedFile(const QString &path) : file(path)
+    {
+        if (!file.open(QIODevice::ReadOnly) || file.size() < qint64(sizeof(FileHeader)))
+            return;
+        data = file.map(0, file.size());
+        if (!data)
+            return;
+        std::memcpy(&header, data, sizeof(FileHeader));
+        if (!isValidHeader(header) || !loadBlockIndex(file, header, blockIndex)) {
+            file.unmap(data);
+            data = nullptr;
+        }
+    }
+
+    ~MappedFile()
+    {
+        if (data)
+            file.unmap(data);
+    }
+
+    bool isValid() const { return data != nullptr; }
+
+    bool isCompressed() const { return header.codec != MeasurementStore::Raw; }
+
+    BlockHeader block(quint32 index) const
+    {
+        BlockHeader blockHeader;
+        std::memcpy(&blockHeader, data + blockIndex.entries[int(index)].offset, sizeof(BlockHeader));
+        clampToHeader(header, index, blockHeader);
+        return blockHeader;
+    }
+
+    const char *payload(quint32 index) const
+    {
+        return reinterpret_cast<const char *>(data + blockIndex.entries[int(index)].offset + sizeof(BlockHeader));
+    }
+
+    const qint64 *timestamps(quint32 index) const
+    {
+        return reinterpret_cast<const qint64 *>(payload(index));
+    }
+
+    const double *values(quint32 index) const
+    {
+        return reinterpret_cast<const double *>(payload(index) + header.blockCapacity * sizeof(qint64));
+    }
+
+    FileHeader header;
+    BlockIndex blockIndex;
+
+private:
+    QFile file;
+    uchar *data = nullptr;
+};
+
+} // namespace
+
+/**
+ * @brief Konstruktor klasy MeasurementStore.
+ * @param path Ścieżka do pliku z pomiarami.
+ */
+MeasurementStore::MeasurementStore(const QString &path)
+    : path(path)
+{
+}
+
+/**
+ * @brief Sprawdza, czy plik z pomiarami istnieje.
+ * @return true, jeśli plik istnieje.
+ */
+bool MeasurementStore::exists() const
+{
+    return QFile::exists(path);
+}
+
+/**
+ * @brief Zwraca liczbę pomiarów zapisanych w pliku.
+ * @return Liczba pomiarów z nagłówka pliku, 0 jeśli plik nie istnieje, lub -1 w przypadku błędu.
+ */
+qint64 MeasurementStore::pointCount() const
+{
+    if (!exists())
+        return 0;
+    QFile file(path);
+    FileHeader header;
+    if (!file.open(QIODevice::ReadOnly) || !readHeader(file, header))
+        return -1;
+    return qint64(header.pointCount);
+}
+
+/**
+ * @brief Dopisuje pomiary, zachowując uporządkowanie pliku według czasu.
+ *
+ * Pomiary późniejsze od ostatniego zapisanego dopisywane są na końcu pliku (najpierw do
+ * wolnych miejsc ostatniego bloku). Pomiary wcześniejsze scalane są z blokami od pierwszego,
+ * którego dotyczą, więc koszt zależy od długości przepisywanej końcówki, a nie całego pliku.
+ * Znaczniki czasu już zapisane są pomijane. Zapis nagłówka pliku, wykonywany na samym końcu,
+ * zatwierdza dopisane pomiary.
+ * Plik zapisany innym sposobem niż DefaultCodec jest przy tym przepisywany w całości.
+ *
+ * @param series Pomiary do zapisania.
+ * @return Liczba dopisanych pomiarów lub -1 w przypadku błędu.
+ */
+int MeasurementStore::append(const MeasurementSeries &series)
+{
+    MeasurementSeries sorted = series;
+    sorted.sortUnique();
+
+    if (!exists())
+        return create(path, sorted) ? sorted.size() : -1;
+    if (sorted.isEmpty())
+        return 0;
+
+    QFile file(path);
+    FileHeader header;
+    if (!file.open(QIODevice::ReadWrite) || !readHeader(file, header))
+        return -1;
+
+    if (header.codec != DefaultCodec) {
+        file.close();
+        return convert(sorted);
+    }
+    if (sorted.timestamp(0) > header.maxTimestamp)
+        return appendTail(file, sorted) ? sorted.size() : -1;
+    return mergeTail(file, sorted);
+}
+
+/**
+ * @brief Dopisuje na końcu pliku pomiary późniejsze od wszystkich zapisanych.
+ *
+ * W pliku nieskompresowanym pomiary wpisywane są w wolne miejsca ostatniego bloku, a reszta
+ * w nowych blokach za nim. Nagłówek ostatniego bloku zapisywany jest dopiero po danych,
+ * a zapis zatwierdza nagłówek pliku: do tego czasu nowe pomiary ostatniego bloku są
+ * pomijane przy odczycie (clampToHeader), a nowe bloki leżą poza liczbą bloków.
+ * Każdy z tych etapów jest zapisywany na dysk (syncToDisk) przed następnym, a po
+ * zatwierdzeniu aktualizowany jest indeks bloków.
+ * W pliku skompresowanym niepełny ostatni blok jest scalany z nowymi pomiarami, aby
+ * częste małe dopisania nie tworzyły wielu krótkich bloków. Nie jest on jednak
+ * nadpisywany w miejscu: plik przepisywany jest przez QSaveFile (pliki skompresowane są
+ * małe, ok. 3 bajtów na pomiar). Gdy ostatni blok jest pełny, nowe bloki dopisywane są
+ * za nim i zatwierdzane zapisem nagłówka pliku.
+ *
+ * @param file Plik otwarty do odczytu i zapisu.
+ * @param series Posortowane pomiary bez powtórzeń.
+ * @return true, jeśli zapis się powiódł.
+ */
+bool MeasurementStore::appendTail(QFile &file, const MeasurementSeries &series)
+{
+    FileHeader header;
+    if (!readHeader(file, header))
+        return false;
+    if (header.codec != Raw) {
+        BlockIndex blockIndex;
+        if (!loadBlockIndex(file, header, blockIndex))
+            return false;
+        if (header.blockCount > 0) {
+            BlockHeader tail;
+            if (!readAt(file, blockIndex.entries.last().offset, &tail, sizeof(tail)))
+                return false;
+            if (tail.count < header.blockCapacity)
+                return rewriteFromBlock(path, file, header, blockIndex, header.blockCount - 1, series) >= 0;
+        }
+        return appendBlocks(file, header, blockIndex, series);
+    }
+
+    const QVector<qint64> &timestamps = series.timestamps();
+    const QVector<double> &values = series.values();
+    const quint32 capacity = header.blockCapacity;
+    const int total = timestamps.size();
+    int written = 0;
+    qint64 tailOffset = -1;
+    BlockHeader tail;
+
+    if (header.blockCount > 0) {
+        tailOffset = blockOffset(capacity, header.blockCount - 1);
+        if (!readAt(file, tailOffset, &tail, sizeof(tail)) || tail.count > capacity)
+            return false;
+        clampToHeader(header, header.blockCount - 1, tail);
+
+        const int n = qMin(int(capacity - tail.count), total);
+        if (n > 0) {
+            const qint64 columnStart = tailOffset + qint64(sizeof(BlockHeader));
+            if (!writeAt(file, columnStart + qint64(tail.count) * qint64(sizeof(qint64)),
+                         timestamps.constData(), n * qint64(sizeof(qint64)))
+                || !writeAt(file, columnStart + qint64(capacity + tail.count) * qint64(sizeof(qint64)),
+                            values.constData(), n * qint64(sizeof(double))))
+                return false;
+
+            if (tail.count == 0)
+                tail.minTimestamp = timestamps.first();
+            tail.maxTimestamp = timestamps[n - 1];
+            tail.count += quint32(n);
+            written = n;
+        }
+    }
+
+    quint32 blockCount = header.blockCount;
+    while (written < total) {
+        const quint32 n = quint32(qMin(int(capacity), total - written));
+        const QByteArray block = makeBlock(timestamps.constData() + written, values.constData() + written, n, capacity);
+        if (!writeAt(file, blockOffset(capacity, blockCount), block.constData(), block.size()))
+            return false;
+        ++blockCount;
+        written += int(n);
+    }
+
+    if (!syncToDisk(file)
+        || (tailOffset >= 0 && (!writeAt(file, tailOffset, &tail, sizeof(tail)) || !syncToDisk(file))))
+        return false;
+
+    header.blockCount = blockCount;
+    header.pointCount += quint64(total);
+    header.maxTimestamp = timestamps.last();
+    if (!writeAt(file, 0, &header, sizeof(header)) || !syncToDisk(file))
+        return false;
+    updateBlockIndex(path);
+    return true;
+}
+
+/**
+ * @brief Scala pomiary z końcówką pliku zaczynającą się od pierwszego bloku, którego dotyczą.
+ *
+ * Plik zapisywany jest na nowo przez QSaveFile (rewriteFromBlock), więc przerwany zapis
+ * nie uszkadza istniejącego pliku.
+ *
+ * @param file Plik otwarty do odczytu i zapisu.
+ * @param series Posortowane pomiary bez powtórzeń.
+ * @return Liczba dopisanych pomiarów lub -1 w przypadku błędu.
+ */
+int MeasurementStore::mergeTail(QFile &file, const MeasurementSeries &series)
+{
+    FileHeader header;
+    BlockIndex blockIndex;
+    if (!readHeader(file, header) || !loadBlockIndex(file, header, blockIndex))
+        return -1;
+    return rewriteFromBlock(path, file, header, blockIndex, findBlock(blockIndex, series.timestamps().first()), series);
+}
+
+/**
+ * @brief Przepisuje plik w formacie DefaultCodec, dopisując przy tym nowe pomiary.
+ *
+ * Przy powtórzonych znacznikach czasu zachowywany jest pomiar zapisany wcześniej w pliku.
+ *
+ * @param series Posortowane pomiary bez powtórzeń.
+ * @return Liczba dopisanych pomiarów lub -1 w przypadku błędu.
+ */
+int MeasurementStore::convert(const MeasurementSeries &series)
+{
+    MeasurementSeries merged;
+    if (!readAll(merged))
+        return -1;
+    const int stored = merged.size();
+    merged.append(series);
+    merged.sortUnique();
+    return create(path, merged) ? merged.size() - stored : -1;
+}
+
+/**
+ * @brief Wczytuje wszystkie pomiary z pliku zmapowanego w pamięć.
+ * @param series Seria, do której trafią pomiary.
+ * @return true, jeśli odczyt się powiódł.
+ */
+bool MeasurementStore::readAll(MeasurementSeries &series)
+{
+    series.clear();
+
+    MappedFile mapped(path);
+    if (!mapped.isValid())
+        return false;
+
+    series.reserve(int(mapped.header.pointCount));
+    for (quint32 b = 0; b < mapped.header.blockCount; ++b) {
+        const BlockHeader blockHeader = mapped.block(b);
+        if (blockHeader.count > mapped.header.blockCapacity)
+            return false;
+        if (!mapped.isCompressed())
+            series.append(mapped.timestamps(b), mapped.values(b), int(blockHeader.count));
+        else if (!gorillaDecode(mapped.payload(b), blockHeader.payloadBytes, int(blockHeader.count),
+                                std::numeric_limits<qint64>::min(), std::numeric_limits<qint64>::max(), series))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Wczytuje pomiary z przedziału czasu [from, to].
+ *
+ * Pierwszy pasujący blok wyszukiwany jest binarnie w indeksie bloków, a w jego obrębie
+ * binarnie po kolumnie czasu (blok skompresowany jest dekompresowany do końca przedziału).
+ * Odczyt kończy się na pierwszym bloku spoza zakresu, więc koszt zależy od liczby
+ * zwróconych pomiarów, a nie od rozmiaru pliku.
+ *
+ * @param from Początek przedziału w milisekundach od epoki.
+ * @param to Koniec przedziału w milisekundach od epoki.
+ * @param series Seria, do której trafią pomiary.
+ * @return true, jeśli odczyt się powiódł.
+ */
+bool MeasurementStore::readRange(qint64 from, qint64 to, MeasurementSeries &series)
+{
+    series.clear();
+
+    MappedFile mapped(path);
+    if (!mapped.isValid())
+        return false;
+
+    for (quint32 b = findBlock(mapped.blockIndex, from); b < mapped.header.blockCount; ++b) {
+        if (mapped.blockIndex.entries[int(b)].minTimestamp > to)
+            break;
+        const BlockHeader blockHeader = mapped.block(b);
+        if (blockHeader.count > mapped.header.blockCapacity)
+            return false;
+
+        if (mapped.isCompressed()) {
+            if (!gorillaDecode(mapped.payload(b), blockHeader.payloadBytes, int(blockHeader.count), from, to, series))
+                return false;
+            continue;
+        }
+        const qint64 *column = mapped.timestamps(b);
+        const qint64 *begin = std::lower_bound(column, column + blockHeader.count, from);
+        const qint64 *end = std::upper_bound(begin, column + blockHeader.count, to);
+        series.append(begin, mapped.values(b) + (begin - column), int(end - begin));
+    }
+    return true;
+}
+
+/**
+ * @brief Tworzy nowy plik z podanymi pomiarami.
+ *
+ * Pomiary są sortowane według czasu, powtórzone znaczniki czasu są pomijane. Plik
+ * zapisywany jest przez QSaveFile, więc istniejący plik zostaje podmieniony dopiero
+ * po poprawnym zapisaniu całości. Indeks bloków zapisywany jest od nowa.
+ *
+ * @param path Ścieżka do pliku.
+ * @param series Pomiary do zapisania.
+ * @param codec Sposób zapisu bloków.
+ * @return true, jeśli zapis się powiódł.
+ */
+bool MeasurementStore::create(const QString &path, const MeasurementSeries &series, Codec codec)
+{
+    MeasurementSeries sorted = series;
+    sorted.sortUnique();
+    const QVector<qint64> &sortedTimestamps = sorted.timestamps();
+
+    const int count = sortedTimestamps.size();
+    FileHeader header = makeHeader(codec);
+    const QByteArray blocks = makeBlocks(sortedTimestamps.constData(), sorted.values().constData(), count, header);
+    header.pointCount = quint64(count);
+    if (count > 0)
+        header.maxTimestamp = sortedTimestamps.last();
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || !truncateBlockIndex(path, 0))
+        return false;
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(blocks);
+    if (!file.commit())
+        return false;
+    updateBlockIndex(path);
+    return true;
+}
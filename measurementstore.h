@@ -0,0 +1,101 @@
+/**
+ * @file measurementstore.h
+ * @brief Definicja klasy MeasurementStore - binarnego, kolumnowego magazynu pomiarów.
+ */
+
+#ifndef MEASUREMENTSTORE_H
+#define MEASUREMENTSTORE_H
+
+#include <QString>
+#include <QVector>
+#include <QFile>
+#include "measurementseries.h"
+
+/**
+ * @class MeasurementStore
+ * @brief Plik z pomiarami jednego sensora zapisany w formacie kolumnowym.
+ *
+ * Plik składa się z nagłówka oraz bloków o stałej pojemności. Każdy blok ma własny
+ * nagłówek i dwie kolumny: znaczniki czasu (int64, milisekundy od epoki) oraz wartości (double),
+ * zapisane wprost (Raw) albo skompresowane metodą Gorilla (bloki o zmiennym rozmiarze).
+ * Pomiary w pliku są posortowane według czasu. Położenie każdego bloku oraz czas jego
+ * pierwszego i ostatniego pomiaru zapisywane są w pliku indeksu obok pliku z pomiarami
+ * (ścieżka z dopisanym ".idx"). Ten rzadki indeks przeszukiwany jest binarnie przy
+ * zapytaniach o przedział czasu, więc otwarcie pliku nie wymaga przejścia po nagłówkach
+ * wszystkich bloków. Brakujący lub nieaktualny indeks jest odbudowywany z nagłówków bloków.
+ * Nowe pomiary są dopisywane, a odczyt odbywa się przez mapowanie pliku w pamięć.
+ */
+class MeasurementStore
+{
+public:
+    /** @brief Sposób zapisu bloków pomiarów. */
+    enum Codec : quint16 {
+        Raw = 0,    ///< Kolumny zapisane wprost (16 bajtów na pomiar).
+        Gorilla = 1 ///< Znaczniki czasu jako delta-of-delta, wartości jako XOR z poprzednią.
+    };
+
+    /** @brief Sposób zapisu nowych plików; pliki zapisane inaczej są przepisywane przy następnym dopisaniu. */
+    static const Codec DefaultCodec = Gorilla;
+
+    /** @brief Liczba pomiarów mieszczących się w jednym bloku. */
+    static const quint32 BlockCapacity = 1024;
+
+    /**
+     * @brief Konstruktor klasy MeasurementStore.
+     * @param path Ścieżka do pliku z pomiarami.
+     */
+    explicit MeasurementStore(const QString &path);
+
+    /**
+     * @brief Sprawdza, czy plik z pomiarami istnieje.
+     * @return true, jeśli plik istnieje.
+     */
+    bool exists() const;
+
+    /**
+     * @brief Zwraca liczbę pomiarów zapisanych w pliku (z nagłówka, bez czytania bloków).
+     * @return Liczba pomiarów, 0 jeśli plik nie istnieje, lub -1 w przypadku błędu.
+     */
+    qint64 pointCount() const;
+
+    /**
+     * @brief Dopisuje pomiary, pomijając znaczniki czasu już obecne w pliku i zachowując sortowanie.
+     * @param series Pomiary do zapisania.
+     * @return Liczba dopisanych pomiarów lub -1 w przypadku błędu.
+     */
+    int append(const MeasurementSeries &series);
+
+    /**
+     * @brief Wczytuje wszystkie pomiary z pliku.
+     * @param series Seria, do której trafią pomiary.
+     * @return true, jeśli odczyt się powiódł.
+     */
+    bool readAll(MeasurementSeries &series);
+
+    /**
+     * @brief Wczytuje pomiary z przedziału czasu [from, to].
+     * @param from Początek przedziału w milisekundach od epoki.
+     * @param to Koniec przedziału w milisekundach od epoki.
+     * @param series Seria, do której trafią pomiary.
+     * @return true, jeśli odczyt się powiódł.
+     */
+    bool readRange(qint64 from, qint64 to, MeasurementSeries &series);
+
+    /**
+     * @brief Tworzy nowy plik z podanymi pomiarami (zastępując istniejący).
+     * @param path Ścieżka do pliku.
+     * @param series Pomiary do zapisania.
+     * @param codec Sposób zapisu bloków.
+     * @return true, jeśli zapis się powiódł.
+     */
+    static bool create(const QString &path, const MeasurementSeries &series, Codec codec = DefaultCodec);
+
+private:
+    bool appendTail(QFile &file, const MeasurementSeries &series);
+    int mergeTail(QFile &file, const MeasurementSeries &series);
+    int convert(const MeasurementSeries &series);
+
+    QString path;
+};
+
+#endif // MEASUREMENTSTORE_H
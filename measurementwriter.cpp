@@ -0,0 +1,126 @@
+/**
+ * @file measurementwriter.cpp
+ * @brief Implementacja zapisu pobranych pomiarów w osobnym wątku.
+ */
+#include "measurementwriter.h"
+#include "jsonstorage.h"
+#include <QMutexLocker>
+/**
+ * @brief Konstruktor klasy MeasurementWriter.
+ *
+ * Tworzy wątek zapisu i obiekt pomocniczy, w którego kontekście wykonywane są zapisy.
+ *
+ * @param parent Obiekt nadrzędny.
+ */
+MeasurementWriter::MeasurementWriter(QObject *parent)
+    : QObject(parent), thread(new QThread(this)), context(new QObject)
+{
+    context->moveToThread(thread);
+    connect(thread, &QThread::finished, context, &QObject::deleteLater);
+    thread->start();
+}
+
+/**
+ * @brief Destruktor - zapisuje oczekujące dane i zatrzymuje wątek.
+ */
+MeasurementWriter::~MeasurementWriter()
+{
+    flush();
+    thread->quit();
+    thread->wait();
+}
+
+/**
+ * @brief Zleca zapis pobranych pomiarów.
+ *
+ * Jeśli dane tego sensora czekają już na zapis, nowe przedziały i pomiary są do nich
+ * dołączane, więc sensor zostanie zapisany raz.
+ *
+ * @param stationId ID stacji.
+ * @param sensorId ID sensora.
+ * @param ranges Pobrane przedziały.
+ * @param series Pobrane pomiary.
+ * @return Numer zlecenia.
+ */
+quint64 MeasurementWriter::enqueue(int stationId, int sensorId, const QVector<QPair<QDateTime, QDateTime>> &ranges,
+                                   const MeasurementSeries &series)
+{
+    QMutexLocker locker(&mutex);
+    const QPair<int, int> key(stationId, sensorId);
+    auto it = pending.find(key);
+    if (it == pending.end()) {
+        it = pending.insert(key, PendingWrite());
+        it->stationId = stationId;
+        it->sensorId = sensorId;
+        order.enqueue(key);
+    }
+    it->ranges += ranges;
+    it->series.append(series);
+    it->sequence = ++lastSequence;
+    const quint64 sequence = lastSequence;
+
+    if (!drainScheduled) {
+        drainScheduled = true;
+        QMetaObject::invokeMethod(context, [this]() { drain(); }, Qt::QueuedConnection);
+    }
+    return sequence;
+}
+
+/**
+ * @brief Zleca odbudowę agregatów sensora.
+ *
+ * Zlecenie nie niesie danych, więc łączy się z oczekującym zapisem tego sensora
+ * (zapis pomiarów również aktualizuje agregaty).
+ *
+ * @param stationId ID stacji.
+ * @param sensorId ID sensora.
+ * @return Numer zlecenia.
+ */
+quint64 MeasurementWriter::updateRollups(int stationId, int sensorId)
+{
+    return enqueue(stationId, sensorId, {}, MeasurementSeries());
+}
+
+/**
+ * @brief Czeka na zapisanie wszystkich oczekujących danych.
+ *
+ * Zapis wykonywany jest w wątku zapisu; wywołujący czeka na jego zakończenie.
+ */
+void MeasurementWriter::flush()
+{
+    if (!thread->isRunning())
+        return;
+    QMetaObject::invokeMethod(context, [this]() { drain(); }, Qt::BlockingQueuedConnection);
+}
+
+/**
+ * @brief Zwraca liczbę sensorów oczekujących na zapis.
+ */
+int MeasurementWriter::pendingWrites() const
+{
+    QMutexLocker locker(&mutex);
+    return pending.size();
+}
+
+/**
+ * @brief Zapisuje kolejno wszystkie oczekujące dane (w wątku zapisu).
+ */
+void MeasurementWriter::drain()
+{
+    forever {
+        PendingWrite write;
+        {
+            QMutexLocker locker(&mutex);
+            if (order.isEmpty()) {
+                drainScheduled = false;
+                return;
+            }
+            write = pending.take(order.dequeue());
+        }
+        if (write.ranges.isEmpty() && write.series.isEmpty())
+            ensureRollups(write.stationId, write.sensorId);
+        else
+            saveFetchedRanges(write.stationId, write.sensorId, write.ranges, write.series);
+        emit saved(write.stationId, write.sensorId, write.sequence);
+    }
+}
@@ -0,0 +1,106 @@
+/**
+ * @file measurementwriter.h
+ * @brief Definicja klasy MeasurementWriter - zapisu pobranych pomiarów w osobnym wątku.
+ */
+
+#ifndef MEASUREMENTWRITER_H
+#define MEASUREMENTWRITER_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QQueue>
+#include <QThread>
+#include <QVector>
+#include <QDateTime>
+#include "measurementseries.h"
+
+/**
+ * @class MeasurementWriter
+ * @brief Zapisuje pobrane pomiary i mapy pokrycia w osobnym wątku (write-behind).
+ *
+ * Zapisy zlecane są z wątku interfejsu i wykonywane po kolei w wątku zapisu. Kilka
+ * oczekujących zapisów tego samego sensora łączonych jest w jeden. Zakończenie zapisu
+ * sygnalizowane jest sygnałem saved z numerem ostatniego zlecenia, które objął.
+ * W tym samym wątku odbudowywane są nieaktualne agregaty (updateRollups), bo wymaga to
+ * odczytu wszystkich pomiarów sensora.
+ * Destruktor czeka na zapisanie wszystkich oczekujących danych.
+ */
+class MeasurementWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Konstruktor klasy MeasurementWriter - uruchamia wątek zapisu.
+     * @param parent Obiekt nadrzędny.
+     */
+    explicit MeasurementWriter(QObject *parent = nullptr);
+
+    /**
+     * @brief Destruktor - zapisuje oczekujące dane i zatrzymuje wątek.
+     */
+    ~MeasurementWriter();
+
+    /**
+     * @brief Zleca zapis pobranych pomiarów (jak saveFetchedRanges).
+     * @param stationId ID stacji.
+     * @param sensorId ID sensora.
+     * @param ranges Pobrane przedziały.
+     * @param series Pobrane pomiary.
+     * @return Numer zlecenia.
+     */
+    quint64 enqueue(int stationId, int sensorId, const QVector<QPair<QDateTime, QDateTime>> &ranges,
+                    const MeasurementSeries &series);
+
+    /**
+     * @brief Zleca odbudowę agregatów sensora, jeśli nie zgadzają się z plikiem pomiarów (ensureRollups).
+     * @param stationId ID stacji.
+     * @param sensorId ID sensora.
+     * @return Numer zlecenia; zakończenie sygnalizuje saved.
+     */
+    quint64 updateRollups(int stationId, int sensorId);
+
+    /**
+     * @brief Czeka na zapisanie wszystkich oczekujących danych.
+     */
+    void flush();
+
+    /** @brief Zwraca liczbę sensorów oczekujących na zapis. */
+    int pendingWrites() const;
+
+signals:
+    /**
+     * @brief Emitowany po zapisaniu danych sensora.
+     * @param stationId ID stacji.
+     * @param sensorId ID sensora.
+     * @param sequence Numer ostatniego zlecenia objętego zapisem.
+     */
+    void saved(int stationId, int sensorId, quint64 sequence);
+
+private:
+    /**
+     * @struct PendingWrite
+     * @brief Połączone zlecenia zapisu jednego sensora.
+     */
+    struct PendingWrite {
+        int stationId = 0;
+        int sensorId = 0;
+        QVector<QPair<QDateTime, QDateTime>> ranges;
+        MeasurementSeries series;
+        quint64 sequence = 0;
+    };
+
+    void drain();
+
+    QThread *thread;
+    QObject *context;
+    mutable QMutex mutex;
+    QHash<QPair<int, int>, PendingWrite> pending;
+    QQueue<QPair<int, int>> order;
+    quint64 lastSequence = 0;
+    bool drainScheduled = false;
+};
+
+#endif // MEASUREMENTWRITER_H
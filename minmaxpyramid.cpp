@@ -0,0 +1,190 @@
+/**
+ * @file minmaxpyramid.cpp
+ * @brief Implementacja wielopoziomowych obwiedni minimum i maksimum serii.
+ */
+#include "minmaxpyramid.h"
+#include "tracing.h"
+#include <algorithm>
+
+/**
+ * @brief Tworzy piramidę dla serii.
+ * @param series Seria posortowana według czasu.
+ */
+MinMaxPyramid::MinMaxPyramid(const MeasurementSeries &series)
+{
+    build(series);
+}
+
+/**
+ * @brief Buduje piramidę od nowa dla serii.
+ * @param series Seria posortowana według czasu.
+ */
+void MinMaxPyramid::build(const MeasurementSeries &series)
+{
+    minLevels.clear();
+    maxLevels.clear();
+    update(series, 0);
+}
+
+/**
+ * @brief Aktualizuje piramidę po zmianie serii od podanego indeksu.
+ *
+ * Na najniższym poziomie przeliczane są bloki od bloku zawierającego firstChanged,
+ * a na każdym wyższym - od rodzica pierwszego przeliczonego bloku. Niepełny ostatni
+ * blok nie trafia do piramidy - jego pomiary przeglądane są bezpośrednio przy zapytaniach.
+ *
+ * @param series Seria posortowana według czasu.
+ * @param firstChanged Indeks pierwszego zmienionego lub dodanego pomiaru.
+ */
+void MinMaxPyramid::update(const MeasurementSeries &series, int firstChanged)
+{
+    TRACE_SPAN("pyramid");
+    source = series;
+
+    const double *values = source.values().constData();
+    int size = source.size() / BlockSize;
+    if (size == 0) {
+        minLevels.clear();
+        maxLevels.clear();
+        return;
+    }
+
+    int changed = qMax(0, firstChanged) / BlockSize;
+    int level = 0;
+    for (;;) {
+        if (level == minLevels.size()) {
+            minLevels.append(QVector<double>());
+            maxLevels.append(QVector<double>());
+        }
+        QVector<double> &mins = minLevels[level];
+        QVector<double> &maxs = maxLevels[level];
+        changed = qMin(changed, mins.size());
+        mins.resize(size);
+        maxs.resize(size);
+
+        if (level == 0) {
+            for (int b = changed; b < size; ++b) {
+                const double *block = values + b * BlockSize;
+                double lo = block[0], hi = block[0];
+                for (int i = 1; i < BlockSize; ++i) {
+                    lo = block[i] < lo ? block[i] : lo;
+                    hi = block[i] > hi ? block[i] : hi;
+                }
+                mins[b] = lo;
+                maxs[b] = hi;
+            }
+        } else {
+            const QVector<double> &lowerMins = minLevels[level - 1];
+            const QVector<double> &lowerMaxs = maxLevels[level - 1];
+            for (int j = changed; j < size; ++j) {
+                const int left = 2 * j, right = qMin(2 * j + 1, lowerMins.size() - 1);
+                mins[j] = qMin(lowerMins[left], lowerMins[right]);
+                maxs[j] = qMax(lowerMaxs[left], lowerMaxs[right]);
+            }
+        }
+
+        if (size == 1)
+            break;
+        changed /= 2;
+        size = (size + 1) / 2;
+        ++level;
+    }
+    minLevels.resize(level + 1);
+    maxLevels.resize(level + 1);
+}
+
+/**
+ * @brief Wyznacza minimum i maksimum pomiarów o indeksach z przedziału [first, last).
+ *
+ * Pomiary przed pierwszą i za ostatnią pełną granicą bloku przeglądane są bezpośrednio,
+ * a pełne bloki pomiędzy nimi - od dołu piramidy: na każdym poziomie dołączane są tylko
+ * bloki brzegowe bez pary, a reszta przedziału przechodzi poziom wyżej.
+ *
+ * @param first Indeks pierwszego pomiaru.
+ * @param last Indeks za ostatnim pomiarem.
+ * @param min Najmniejsza wartość.
+ * @param max Największa wartość.
+ * @return false, jeśli przedział jest pusty.
+ */
+bool MinMaxPyramid::extremes(int first, int last, double &min, double &max) const
+{
+    first = qMax(0, first);
+    last = qMin(source.size(), last);
+    if (first >= last)
+        return false;
+
+    const double *values = source.values().constData();
+    min = max = values[first];
+    auto include = [&min, &max](double lo, double hi) {
+        min = lo < min ? lo : min;
+        max = hi > max ? hi : max;
+    };
+
+    const int blocks = minLevels.isEmpty() ? 0 : minLevels.first().size();
+    int low = first, high = last;
+    while (low < high && (low % BlockSize != 0 || low / BlockSize >= blocks)) {
+        include(values[low], values[low]);
+        ++low;
+    }
+    while (high > low && (high % BlockSize != 0 || high / BlockSize > blocks)) {
+        --high;
+        include(values[high], values[high]);
+    }
+
+    int l = low / BlockSize, h = high / BlockSize;
+    for (int level = 0; l < h && level < minLevels.size(); ++level) {
+        const QVector<double> &mins = minLevels[level];
+        const QVector<double> &maxs = maxLevels[level];
+        if (level == minLevels.size() - 1) {
+            for (int j = l; j < h; ++j)
+                include(mins[j], maxs[j]);
+            break;
+        }
+        if (l & 1) {
+            include(mins[l], maxs[l]);
+            ++l;
+        }
+        if (h & 1) {
+            --h;
+            include(mins[h], maxs[h]);
+        }
+        l /= 2;
+        h /= 2;
+    }
+    return true;
+}
+
+/**
+ * @brief Dzieli zakres czasu na równe kolumny i wyznacza minimum i maksimum każdej z nich.
+ *
+ * Granice kolumn wyszukiwane są binarnie w części serii za poprzednią kolumną, a minimum
+ * i maksimum - w piramidzie, więc koszt zależy od liczby kolumn, a nie od liczby pomiarów
+ * w zakresie.
+ *
+ * @param from Początek zakresu w milisekundach od epoki.
+ * @param to Koniec zakresu w milisekundach od epoki (włącznie).
+ * @param columns Liczba kolumn.
+ * @return Kolumny w kolejności czasu.
+ */
+QVector<MinMaxPyramid::Column> MinMaxPyramid::envelope(qint64 from, qint64 to, int columns) const
+{
+    QVector<Column> result;
+    if (columns < 1 || to < from)
+        return result;
+    result.resize(columns);
+
+    const qint64 *timestamps = source.timestamps().constData();
+    const qint64 *end = timestamps + source.size();
+    const qint64 span = to - from + 1;
+    int position = source.lowerBound(from);
+    for (int c = 0; c < columns; ++c) {
+        const qint64 columnEnd = from + span * (c + 1) / columns;
+        const int next = int(std::lower_bound(timestamps + position, end, columnEnd) - timestamps);
+        Column &column = result[c];
+        column.first = position;
+        column.last = next;
+        extremes(position, next, column.min, column.max);
+        position = next;
+    }
+    return result;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file minmaxpyramid.h
+ * @brief Definicja klasy MinMaxPyramid - wielopoziomowych obwiedni minimum i maksimum serii.
+ */
+
+#ifndef MINMAXPYRAMID_H
+#define MINMAXPYRAMID_H
+
+#include <QVector>
+#include "measurementseries.h"
+
+/**
+ * @class MinMaxPyramid
+ * @brief Piramida minimów i maksimów serii pomiarów do szybkiego rysowania obwiedni.
+ *
+ * Najniższy poziom przechowuje minimum i maksimum każdego bloku BlockSize kolejnych
+ * pomiarów, a każdy wyższy - dwóch sąsiednich bloków poziomu niższego. Minimum i maksimum
+ * dowolnego przedziału indeksów wyznaczane są więc w czasie O(BlockSize + log n), a
+ * obwiednia wykresu o szerokości W kolumn - w czasie O(W log n), niezależnie od liczby
+ * pomiarów w widocznym zakresie. Piramida zajmuje około n / BlockSize * 4 liczb.
+ *
+ * Seria jest współdzielona z obiektem wywołującym (bez kopiowania pomiarów).
+ */
+class MinMaxPyramid
+{
+public:
+    /** @brief Liczba pomiarów w bloku najniższego poziomu. */
+    static const int BlockSize = 16;
+
+    /**
+     * @struct Column
+     * @brief Pomiary jednej kolumny obwiedni (zwykle jednego piksela szerokości).
+     */
+    struct Column {
+        int first = 0;          ///< Indeks pierwszego pomiaru kolumny.
+        int last = 0;           ///< Indeks za ostatnim pomiarem kolumny (first == last - kolumna pusta).
+        double min = 0;         ///< Najmniejsza wartość w kolumnie.
+        double max = 0;         ///< Największa wartość w kolumnie.
+
+        /** @brief Sprawdza, czy kolumna nie zawiera pomiarów. */
+        bool isEmpty() const { return first >= last; }
+    };
+
+    /** @brief Tworzy pustą piramidę. */
+    MinMaxPyramid() = default;
+
+    /**
+     * @brief Tworzy piramidę dla serii.
+     * @param series Seria posortowana według czasu.
+     */
+    explicit MinMaxPyramid(const MeasurementSeries &series);
+
+    /**
+     * @brief Buduje piramidę od nowa dla serii.
+     * @param series Seria posortowana według czasu.
+     */
+    void build(const MeasurementSeries &series);
+
+    /**
+     * @brief Aktualizuje piramidę po zmianie serii od podanego indeksu.
+     *
+     * Przeliczane są tylko bloki od zmienionego miejsca do końca serii, więc dopisanie
+     * porcji pomiarów na końcu kosztuje O(rozmiar porcji / BlockSize + log n).
+     *
+     * @param series Seria posortowana według czasu; pomiary przed firstChanged muszą być
+     *        takie same jak w serii, dla której piramida była aktualna.
+     * @param firstChanged Indeks pierwszego zmienionego lub dodanego pomiaru.
+     */
+    void update(const MeasurementSeries &series, int firstChanged);
+
+    /**
+     * @brief Zwalnia odwołanie do serii, zachowując poziomy piramidy.
+     *
+     * Pozwala zmienić serię w miejscu bez kopiowania jej kolumn; przed kolejnym
+     * zapytaniem należy wywołać update.
+     */
+    void release() { source = MeasurementSeries(); }
+
+    /** @brief Zwraca serię, dla której zbudowano piramidę. */
+    const MeasurementSeries &series() const { return source; }
+
+    /**
+     * @brief Wyznacza minimum i maksimum pomiarów o indeksach z przedziału [first, last).
+     * @param first Indeks pierwszego pomiaru.
+     * @param last Indeks za ostatnim pomiarem.
+     * @param min Najmniejsza wartość.
+     * @param max Największa wartość.
+     * @return false, jeśli przedział jest pusty.
+     */
+    bool extremes(int first, int last, double &min, double &max) const;
+
+    /**
+     * @brief Dzieli zakres czasu na równe kolumny i wyznacza minimum i maksimum każdej z nich.
+     * @param from Początek zakresu w milisekundach od epoki.
+     * @param to Koniec zakresu w milisekundach od epoki (włącznie).
+     * @param columns Liczba kolumn.
+     * @return Kolumny w kolejności czasu.
+     */
+    QVector<Column> envelope(qint64 from, qint64 to, int columns) const;
+
+private:
+    MeasurementSeries source;
+    QVector<QVector<double>> minLevels;
+    QVector<QVector<double>> maxLevels;
+};
+
+#endif // MINMAXPYRAMID_H
@@ -0,0 +1,295 @@
+/**
+ * @file networktransport.cpp
+ * @brief Implementacja menedżera sieci z nagrywaniem i odtwarzaniem odpowiedzi.
+ */
+#include "networktransport.h"
+#include "transportreply.h"
+#include "jsonstorage.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QNetworkReply>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QSharedPointer>
+#include <QTimer>
+#include <QDebug>
+
+namespace {
+
+/** @brief Odstęp między kolejnymi fragmentami odtwarzanej treści przy ograniczonej przepustowości. */
+const int TickMsecs = 20;
+
+/**
+ * @struct Recording
+ * @brief Nagrana odpowiedź.
+ */
+struct Recording {
+    int statusCode = 0;
+    QList<QPair<QByteArray, QByteArray>> headers;
+    QByteArray body;
+    QNetworkReply::NetworkError error = QNetworkReply::NoError;
+    QString errorString;
+    bool metaDataSet = false;
+};
+
+QMutex &settingsMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+NetworkTransport::Settings &sharedSettings()
+{
+    static NetworkTransport::Settings settings;
+    return settings;
+}
+
+/**
+ * @brief Przekazuje odbiorcy treść nagranej odpowiedzi od podanego miejsca.
+ *
+ * Przy ograniczonej przepustowości treść dzielona jest na fragmenty podawane co TickMsecs.
+ */
+void deliver(TransportReply *reply, QSharedPointer<const Recording> recording, int bytesPerSecond, qint64 offset)
+{
+    if (reply->isFinished())
+        return;
+
+    const qint64 size = recording->body.size();
+    const qint64 chunk = bytesPerSecond > 0 ? qMax<qint64>(1, qint64(bytesPerSecond) * TickMsecs / 1000) : size;
+    reply->appendData(recording->body.mid(offset, chunk));
+    if (offset + chunk < size) {
+        QTimer::singleShot(TickMsecs, reply, [reply, recording, bytesPerSecond, offset, chunk]() {
+            deliver(reply, recording, bytesPerSecond, offset + chunk);
+        });
+        return;
+    }
+    reply->finishReply(recording->error, recording->errorString);
+}
+
+/**
+ * @brief Przepisuje kod statusu i nagłówki odpowiedzi z sieci.
+ */
+void copyMetaData(QNetworkReply *from, Recording &recording)
+{
+    recording.statusCode = from->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    recording.headers = from->rawHeaderPairs();
+    recording.metaDataSet = true;
+}
+
+}
+
+/**
+ * @brief Odczytuje ustawienia ze zmiennych środowiskowych.
+ * @return Odczytane ustawienia (domyślnie tryb Live).
+ */
+NetworkTransport::Settings NetworkTransport::settingsFromEnvironment()
+{
+    Settings settings;
+    const QString mode = qEnvironmentVariable("JP_TRANSPORT").toLower();
+    if (mode == "record")
+        settings.mode = Record;
+    else if (mode == "replay")
+        settings.mode = Replay;
+    if (mode == "record" || mode == "replay")
+        qInfo().noquote() << "Transport sieciowy:" << mode;
+
+    settings.directory = qEnvironmentVariable("JP_TRANSPORT_DIR");
+    settings.latencyMsecs = qMax(0, qEnvironmentVariableIntValue("JP_LATENCY_MS"));
+    settings.bytesPerSecond = qMax(0, qEnvironmentVariableIntValue("JP_BANDWIDTH"));
+    settings.errorRate = qBound(0.0, qEnvironmentVariable("JP_ERROR_RATE").toDouble(), 1.0);
+    return settings;
+}
+
+/**
+ * @brief Ustawia ustawienia dla menedżerów tworzonych od tej chwili.
+ * @param settings Ustawienia.
+ */
+void NetworkTransport::setDefaultSettings(const Settings &settings)
+{
+    QMutexLocker locker(&settingsMutex());
+    sharedSettings() = settings;
+}
+
+/**
+ * @brief Zwraca ustawienia używane przez nowo tworzone menedżery.
+ */
+NetworkTransport::Settings NetworkTransport::defaultSettings()
+{
+    QMutexLocker locker(&settingsMutex());
+    return sharedSettings();
+}
+
+/**
+ * @brief Konstruktor klasy NetworkTransport.
+ *
+ * Bez podanego katalogu nagrania trafiają do podkatalogu "nagrania" lokalnej bazy.
+ *
+ * @param parent Obiekt nadrzędny.
+ */
+NetworkTransport::NetworkTransport(QObject *parent)
+    : QNetworkAccessManager(parent), transport(defaultSettings())
+{
+    if (transport.directory.isEmpty())
+        transport.directory = getJsonFilePath("nagrania");
+    if (transport.mode == Record)
+        QDir().mkpath(transport.directory);
+}
+
+/**
+ * @brief Tworzy odpowiedź na zapytanie zgodnie z trybem działania.
+ * @param op Rodzaj operacji HTTP.
+ * @param request Zapytanie.
+ * @param outgoingData Dane wysyłane w treści zapytania.
+ * @return Odpowiedź na zapytanie.
+ */
+QNetworkReply *NetworkTransport::createRequest(Operation op, const QNetworkRequest &request, QIODevice *outgoingData)
+{
+    if (transport.mode == Replay)
+        return replay(op, request);
+
+    QNetworkReply *reply = QNetworkAccessManager::createRequest(op, request, outgoingData);
+    if (transport.mode == Record)
+        return record(reply, op, request);
+    return reply;
+}
+
+/**
+ * @brief Przekazuje odpowiedź z sieci odbiorcy, zapisując ją jednocześnie na dysku.
+ *
+ * Nagranie składa się z pliku .json (adres, status, nagłówki, błąd) i pliku .body
+ * z treścią odpowiedzi. Zapisywane są również odpowiedzi zakończone błędem, aby
+ * odtwarzanie odzwierciedlało także awarie.
+ *
+ * @param liveReply Odpowiedź z sieci.
+ * @param op Rodzaj operacji HTTP.
+ * @param request Zapytanie.
+ * @return Odpowiedź przekazywana odbiorcy.
+ */
+QNetworkReply *NetworkTransport::record(QNetworkReply *liveReply, Operation op, const QNetworkRequest &request)
+{
+    TransportReply *reply = new TransportReply(op, request, this);
+    liveReply->setParent(reply);
+    QSharedPointer<Recording> recording(new Recording);
+
+    connect(liveReply, &QNetworkReply::metaDataChanged, reply, [reply, liveReply, recording]() {
+        copyMetaData(liveReply, *recording);
+        reply->setResponseMetaData(recording->statusCode, recording->headers,
+                                   liveReply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool());
+    });
+    connect(liveReply, &QNetworkReply::readyRead, reply, [reply, liveReply, recording]() {
+        const QByteArray data = liveReply->readAll();
+        recording->body.append(data);
+        reply->appendData(data);
+    });
+    connect(liveReply, &QNetworkReply::finished, reply, [this, reply, liveReply, recording, op]() {
+        if (!recording->metaDataSet) {
+            copyMetaData(liveReply, *recording);
+            reply->setResponseMetaData(recording->statusCode, recording->headers,
+                                       liveReply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool());
+        }
+        const QByteArray data = liveReply->readAll();
+        recording->body.append(data);
+        reply->appendData(data);
+        recording->error = liveReply->error();
+        recording->errorString = liveReply->errorString();
+
+        if (recording->error != QNetworkReply::OperationCanceledError) {
+            QJsonArray headers;
+            for (const QPair<QByteArray, QByteArray> &header : std::as_const(recording->headers))
+                headers.append(QJsonArray{ QString::fromLatin1(header.first), QString::fromLatin1(header.second) });
+            QJsonObject meta;
+            meta.insert("url", liveReply->url().toString());
+            meta.insert("status", recording->statusCode);
+            meta.insert("error", int(recording->error));
+            meta.insert("errorString", recording->error != QNetworkReply::NoError ? recording->errorString : QString());
+            meta.insert("headers", headers);
+
+            QSaveFile bodyFile(recordingPath(op, liveReply->url(), ".body"));
+            if (bodyFile.open(QIODevice::WriteOnly)) {
+                bodyFile.write(recording->body);
+                bodyFile.commit();
+            }
+            QSaveFile metaFile(recordingPath(op, liveReply->url(), ".json"));
+            if (metaFile.open(QIODevice::WriteOnly)) {
+                metaFile.write(QJsonDocument(meta).toJson());
+                metaFile.commit();
+            }
+        }
+        reply->finishReply(recording->error, recording->errorString);
+    });
+    connect(reply, &TransportReply::aborted, liveReply, &QNetworkReply::abort);
+    return reply;
+}
+
+/**
+ * @brief Tworzy odpowiedź odtwarzaną z nagrania.
+ *
+ * Odpowiedź startuje po latencyMsecs. Z prawdopodobieństwem errorRate kończy się błędem
+ * TemporaryNetworkFailureError bez treści; zapytanie bez nagrania kończy się błędem
+ * ContentNotFoundError.
+ *
+ * @param op Rodzaj operacji HTTP.
+ * @param request Zapytanie.
+ * @return Odpowiedź na zapytanie.
+ */
+QNetworkReply *NetworkTransport::replay(Operation op, const QNetworkRequest &request)
+{
+    TransportReply *reply = new TransportReply(op, request, this);
+    QSharedPointer<Recording> recording(new Recording);
+
+    const QJsonObject meta = loadJsonDoc(recordingPath(op, request.url(), ".json")).object();
+    QFile bodyFile(recordingPath(op, request.url(), ".body"));
+    const bool found = !meta.isEmpty() && bodyFile.open(QIODevice::ReadOnly);
+    if (found) {
+        recording->body = bodyFile.readAll();
+        recording->statusCode = meta["status"].toInt();
+        recording->error = QNetworkReply::NetworkError(meta["error"].toInt());
+        recording->errorString = meta["errorString"].toString();
+        const QJsonArray headers = meta["headers"].toArray();
+        for (const QJsonValue &header : headers) {
+            const QJsonArray pair = header.toArray();
+            recording->headers.append({ pair[0].toString().toLatin1(), pair[1].toString().toLatin1() });
+        }
+    } else {
+        qWarning().noquote() << "Brak nagrania dla" << request.url().toString();
+    }
+
+    const bool injectError = QRandomGenerator::global()->generateDouble() < transport.errorRate;
+    const int bytesPerSecond = transport.bytesPerSecond;
+    QTimer::singleShot(transport.latencyMsecs, reply, [reply, recording, found, injectError, bytesPerSecond]() {
+        if (reply->isFinished())
+            return;
+        if (!found) {
+            reply->setResponseMetaData(404, {});
+            reply->finishReply(QNetworkReply::ContentNotFoundError, "No recording for this request");
+            return;
+        }
+        if (injectError) {
+            reply->finishReply(QNetworkReply::TemporaryNetworkFailureError, "Injected network error");
+            return;
+        }
+        reply->setResponseMetaData(recording->statusCode, recording->headers);
+        deliver(reply, recording, bytesPerSecond, 0);
+    });
+    return reply;
+}
+
+/**
+ * @brief Zwraca ścieżkę pliku nagrania dla zapytania.
+ * @param op Rodzaj operacji HTTP.
+ * @param url Adres zapytania.
+ * @param suffix Rozszerzenie pliku (".json" lub ".body").
+ * @return Ścieżka pliku w katalogu nagrań.
+ */
+QString NetworkTransport::recordingPath(Operation op, const QUrl &url, const QString &suffix) const
+{
+    const QByteArray key = QByteArray::number(int(op)) + ' ' + url.toEncoded();
+    const QString name = QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex());
+    return transport.directory + "/" + name + suffix;
+}
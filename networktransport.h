@@ -0,0 +1,100 @@
+/**
+ * @file networktransport.h
+ * @brief Definicja klasy NetworkTransport - menedżera sieci z nagrywaniem i odtwarzaniem odpowiedzi.
+ */
+
+#ifndef NETWORKTRANSPORT_H
+#define NETWORKTRANSPORT_H
+
+#include <QNetworkAccessManager>
+#include <QString>
+
+/**
+ * @class NetworkTransport
+ * @brief Menedżer sieci, przez który przechodzą wszystkie zapytania programu.
+ *
+ * Działa w jednym z trzech trybów:
+ * - Live - zapytania trafiają do sieci bez zmian,
+ * - Record - zapytania trafiają do sieci, a każda odpowiedź zapisywana jest na dysku,
+ * - Replay - odpowiedzi odtwarzane są z dysku, bez połączenia z siecią, z zadanym
+ *   opóźnieniem, przepustowością i odsetkiem błędów.
+ *
+ * Tryb odtwarzania pozwala powtarzalnie mierzyć całe ścieżki programu (np. tryb wsadowy)
+ * na komputerze bez dostępu do sieci. Ustawienia są wspólne dla wszystkich menedżerów
+ * i odczytywane są przy ich tworzeniu.
+ */
+class NetworkTransport : public QNetworkAccessManager
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @enum Mode
+     * @brief Tryb działania.
+     */
+    enum Mode {
+        Live,       ///< Zapytania do sieci.
+        Record,     ///< Zapytania do sieci z zapisem odpowiedzi.
+        Replay      ///< Odtwarzanie zapisanych odpowiedzi.
+    };
+
+    /**
+     * @struct Settings
+     * @brief Ustawienia transportu.
+     */
+    struct Settings {
+        Mode mode = Live;               ///< Tryb działania.
+        QString directory;              ///< Katalog nagrań.
+        int latencyMsecs = 0;           ///< Opóźnienie odpowiedzi przy odtwarzaniu.
+        int bytesPerSecond = 0;         ///< Przepustowość przy odtwarzaniu (0 - bez ograniczenia).
+        double errorRate = 0.0;         ///< Odsetek odtwarzanych odpowiedzi zakończonych błędem (0-1).
+    };
+
+    /**
+     * @brief Odczytuje ustawienia ze zmiennych środowiskowych.
+     *
+     * JP_TRANSPORT (live, record, replay), JP_TRANSPORT_DIR, JP_LATENCY_MS,
+     * JP_BANDWIDTH (bajty na sekundę) i JP_ERROR_RATE.
+     *
+     * @return Odczytane ustawienia.
+     */
+    static Settings settingsFromEnvironment();
+
+    /**
+     * @brief Ustawia ustawienia dla menedżerów tworzonych od tej chwili.
+     * @param settings Ustawienia.
+     */
+    static void setDefaultSettings(const Settings &settings);
+
+    /** @brief Zwraca ustawienia używane przez nowo tworzone menedżery. */
+    static Settings defaultSettings();
+
+    /**
+     * @brief Konstruktor klasy NetworkTransport.
+     * @param parent Obiekt nadrzędny.
+     */
+    explicit NetworkTransport(QObject *parent = nullptr);
+
+    /** @brief Zwraca tryb działania menedżera. */
+    Mode mode() const { return transport.mode; }
+
+protected:
+    /**
+     * @brief Tworzy odpowiedź na zapytanie zgodnie z trybem działania.
+     * @param op Rodzaj operacji HTTP.
+     * @param request Zapytanie.
+     * @param outgoingData Dane wysyłane w treści zapytania.
+     * @return Odpowiedź na zapytanie.
+     */
+    QNetworkReply *createRequest(Operation op, const QNetworkRequest &request,
+                                 QIODevice *outgoingData = nullptr) override;
+
+private:
+    QNetworkReply *record(QNetworkReply *liveReply, Operation op, const QNetworkRequest &request);
+    QNetworkReply *replay(Operation op, const QNetworkRequest &request);
+    QString recordingPath(Operation op, const QUrl &url, const QString &suffix) const;
+
+    Settings transport;
+};
+
+#endif // NETWORKTRANSPORT_H
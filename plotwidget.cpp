@@ -0,0 +1,432 @@
+/**
+ * @file plotwidget.cpp
+ * @brief Implementacja lekkiego wykresu rysowanego bezpośrednio przez QPainter.
+ */
+#include "plotwidget.h"
+#include "tracing.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QWheelEvent>
+#include <QMouseEvent>
+#include <QDateTime>
+#include <QLineF>
+
+namespace {
+
+/** @brief Kolory kolejnych serii (jak w domyślnym motywie QtCharts). */
+const QRgb SeriesColors[] = { 0x209fdf, 0x99ca53, 0xf6a625, 0x6d5fd5, 0xbf593e, 0x38ad6b, 0x3c3c3c, 0xb09a77 };
+
+/** @brief Liczba kolorów serii. */
+const int SeriesColorCount = int(sizeof(SeriesColors) / sizeof(SeriesColors[0]));
+
+/** @brief Najkrótszy zakres osi czasu po przybliżeniu (jedna godzina). */
+const qint64 MinimumSpanMsecs = 3600 * 1000;
+
+/** @brief Marginesy obszaru wykresu: lewy, górny, prawy, dolny. */
+const int MarginLeft = 64, MarginTop = 28, MarginRight = 16, MarginBottom = 44;
+
+}
+
+/**
+ * @brief Konstruktor klasy PlotWidget.
+ * @param parent Rodzic widżetu.
+ */
+PlotWidget::PlotWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumSize(320, 200);
+}
+
+/**
+ * @brief Ustawia serie do narysowania.
+ *
+ * Jeśli zakres osi czasu nie był jeszcze ustawiony, obejmuje on wszystkie serie.
+ *
+ * @param series Serie posortowane według czasu.
+ * @param names Nazwy serii w legendzie.
+ */
+void PlotWidget::setSeries(const QVector<MeasurementSeries> &series, const QStringList &names)
+{
+    seriesList = series;
+    this->names = names;
+    pyramidsDirty = true;
+    if (from == to)
+        fullExtent(from, to);
+    update();
+}
+
+/**
+ * @brief Zwalnia odwołania widżetu do serii przed jej zmianą w miejscu.
+ *
+ * Poziomy piramidy pozostają, więc updateSeries przelicza tylko zmienioną część.
+ *
+ * @param index Indeks serii.
+ */
+void PlotWidget::releaseSeries(int index)
+{
+    if (index < 0 || index >= seriesList.size())
+        return;
+    seriesList[index] = MeasurementSeries();
+    if (index < pyramids.size())
+        pyramids[index].release();
+}
+
+/**
+ * @brief Zastępuje serię jej zmienioną wersją i aktualizuje piramidę od zmienionego miejsca.
+ *
+ * Jeśli piramidy nie zostały jeszcze zbudowane, zbudowane zostaną w całości przy
+ * najbliższym rysowaniu.
+ *
+ * @param index Indeks serii.
+ * @param series Seria posortowana według czasu.
+ * @param firstChanged Indeks pierwszego zmienionego lub dodanego pomiaru.
+ */
+void PlotWidget::updateSeries(int index, const MeasurementSeries &series, int firstChanged)
+{
+    if (index < 0 || index >= seriesList.size())
+        return;
+    seriesList[index] = series;
+    if (!pyramidsDirty)
+        pyramids[index].update(series, firstChanged);
+    if (from == to)
+        fullExtent(from, to);
+    update();
+}
+
+/**
+ * @brief Ustawia widoczny zakres osi czasu.
+ * @param from Początek zakresu w milisekundach od epoki.
+ * @param to Koniec zakresu w milisekundach od epoki.
+ */
+void PlotWidget::setTimeRange(qint64 from, qint64 to)
+{
+    this->from = qMin(from, to);
+    this->to = qMax(this->from + 1, qMax(from, to));
+    update();
+}
+
+/**
+ * @brief Ustawia zakres osi wartości.
+ *
+ * Zakres zerowej długości (np. seria stałych wartości) jest rozszerzany o 1 w obie strony.
+ *
+ * @param min Początek osi.
+ * @param max Koniec osi.
+ */
+void PlotWidget::setValueRange(double min, double max)
+{
+    minValue = qMin(min, max);
+    maxValue = qMax(min, max);
+    if (maxValue <= minValue) {
+        minValue -= 1;
+        maxValue += 1;
+    }
+    update();
+}
+
+/**
+ * @brief Ustawia tytuł wykresu i opis osi wartości.
+ * @param title Tytuł wykresu.
+ * @param axisTitle Opis osi wartości.
+ */
+void PlotWidget::setTitles(const QString &title, const QString &axisTitle)
+{
+    this->title = title;
+    this->axisTitle = axisTitle;
+    update();
+}
+
+/**
+ * @brief Zwraca prostokąt, w którym rysowane są serie.
+ */
+QRect PlotWidget::plotArea() const
+{
+    return rect().adjusted(MarginLeft, MarginTop, -MarginRight, -MarginBottom);
+}
+
+/**
+ * @brief Wyznacza zakres czasu obejmujący wszystkie serie.
+ * @param start Najwcześniejszy pomiar.
+ * @param end Najpóźniejszy pomiar.
+ */
+void PlotWidget::fullExtent(qint64 &start, qint64 &end) const
+{
+    start = end = 0;
+    bool hasRange = false;
+    for (const MeasurementSeries &series : seriesList) {
+        if (series.isEmpty())
+            continue;
+        start = hasRange ? qMin(start, series.timestamp(0)) : series.timestamp(0);
+        end = hasRange ? qMax(end, series.timestamp(series.size() - 1)) : series.timestamp(series.size() - 1);
+        hasRange = true;
+    }
+}
+
+/**
+ * @brief Zmienia zakres osi czasu w odpowiedzi na działanie użytkownika.
+ *
+ * Zakres nie jest krótszy niż MinimumSpanMsecs i nie wychodzi poza dane: przesunięcie
+ * za brzeg zatrzymuje się na pierwszym lub ostatnim pomiarze.
+ *
+ * @param newFrom Nowy początek zakresu.
+ * @param newTo Nowy koniec zakresu.
+ */
+void PlotWidget::changeTimeRange(qint64 newFrom, qint64 newTo)
+{
+    qint64 start, end;
+    fullExtent(start, end);
+    if (end - start <= MinimumSpanMsecs) {
+        newFrom = start;
+        newTo = qMax(end, start + 1);
+    } else {
+        const qint64 span = qBound(MinimumSpanMsecs, newTo - newFrom, end - start);
+        newFrom = qBound(start, newFrom, end - span);
+        newTo = newFrom + span;
+    }
+    if (newFrom == from && newTo == to)
+        return;
+    from = newFrom;
+    to = newTo;
+    update();
+    emit timeRangeChanged(from, to);
+}
+
+/**
+ * @brief Rysuje osie, serie i legendę.
+ *
+ * Piramidy obwiedni budowane są tu, jeśli serie zmieniły się od poprzedniego rysowania.
+ *
+ * @param event Zdarzenie rysowania.
+ */
+void PlotWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    TRACE_SPAN("plot");
+    if (pyramidsDirty) {
+        pyramids.resize(seriesList.size());
+        for (int i = 0; i < seriesList.size(); ++i)
+            pyramids[i].build(seriesList[i]);
+        pyramidsDirty = false;
+    }
+
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().color(QPalette::Base));
+    const QRect area = plotArea();
+    if (area.width() <= 0 || area.height() <= 0)
+        return;
+
+    drawAxes(painter, area);
+    painter.setClipRect(area);
+    for (int i = 0; i < seriesList.size(); ++i)
+        drawSeries(painter, area, i);
+    painter.setClipping(false);
+    drawLegend(painter, area);
+}
+
+/**
+ * @brief Rysuje ramkę, siatkę, opisy osi i tytuł.
+ * @param painter Obiekt rysujący.
+ * @param area Obszar wykresu.
+ */
+void PlotWidget::drawAxes(QPainter &painter, const QRect &area) const
+{
+    const QColor textColor = palette().color(QPalette::WindowText);
+    const QColor gridColor = palette().color(QPalette::Midlight);
+    const int textHeight = fontMetrics().height();
+
+    painter.setPen(textColor);
+    painter.drawText(QRect(0, 0, width(), area.top()), Qt::AlignCenter, title);
+    painter.drawText(QRect(4, 0, area.left() + area.width() / 3, area.top()), Qt::AlignLeft | Qt::AlignVCenter, axisTitle);
+    painter.drawText(QRect(0, height() - textHeight - 2, width(), textHeight), Qt::AlignCenter, "Data pomiaru");
+
+    const int valueTicks = 5;
+    for (int k = 0; k < valueTicks; ++k) {
+        const double value = minValue + (maxValue - minValue) * k / (valueTicks - 1);
+        const int y = area.bottom() - int((area.height() - 1) * double(k) / (valueTicks - 1));
+        painter.setPen(gridColor);
+        painter.drawLine(area.left(), y, area.right(), y);
+        painter.setPen(textColor);
+        painter.drawText(QRect(0, y - textHeight / 2, area.left() - 6, textHeight), Qt::AlignRight | Qt::AlignVCenter,
+                         QString::number(value, 'g', 4));
+    }
+
+    const int timeTicks = 4;
+    for (int k = 0; k < timeTicks; ++k) {
+        const qint64 time = from + (to - from) * k / (timeTicks - 1);
+        const int x = area.left() + int((area.width() - 1) * double(k) / (timeTicks - 1));
+        painter.setPen(gridColor);
+        painter.drawLine(x, area.top(), x, area.bottom());
+        painter.setPen(textColor);
+        const QString label = QDateTime::fromMSecsSinceEpoch(time).toString("yyyy-MM-dd HH:00");
+        const int labelWidth = fontMetrics().horizontalAdvance(label);
+        const int left = qBound(0, x - labelWidth / 2, width() - labelWidth);
+        painter.drawText(QRect(left, area.bottom() + 4, labelWidth, textHeight), Qt::AlignCenter, label);
+    }
+
+    painter.setPen(textColor);
+    painter.drawRect(area.adjusted(0, 0, -1, -1));
+}
+
+/**
+ * @brief Rysuje jedną serię.
+ *
+ * Jeśli w zakresie jest nie więcej niż dwa pomiary na piksel, rysowana jest łamana przez
+ * pomiary. W przeciwnym razie dla każdej kolumny pikseli rysowany jest odcinek od minimum
+ * do maksimum oraz odcinek od ostatniego pomiaru poprzedniej niepustej kolumny do
+ * pierwszego pomiaru bieżącej. Wszystkie odcinki przekazywane są jednym wywołaniem
+ * drawLines(). Pomiary tuż poza zakresem łączone są z brzegami wykresu.
+ *
+ * @param painter Obiekt rysujący.
+ * @param area Obszar wykresu.
+ * @param index Indeks serii.
+ */
+void PlotWidget::drawSeries(QPainter &painter, const QRect &area, int index) const
+{
+    const MeasurementSeries &series = seriesList[index];
+    if (series.isEmpty())
+        return;
+
+    const qint64 *timestamps = series.timestamps().constData();
+    const double *values = series.values().constData();
+    const double xScale = double(area.width()) / double(to - from);
+    const double yScale = double(area.height() - 1) / (maxValue - minValue);
+    auto xFor = [&](qint64 time) { return area.left() + double(time - from) * xScale; };
+    auto yFor = [&](double value) { return area.bottom() - (value - minValue) * yScale; };
+
+    painter.setPen(QPen(QColor(SeriesColors[index % SeriesColorCount]), 1));
+    const int visibleFirst = series.lowerBound(from);
+    const int visibleLast = series.lowerBound(to + 1);
+    const int first = qMax(0, visibleFirst - 1);
+    const int last = qMin(series.size(), visibleLast + 1);
+
+    if (last - first <= 2 * area.width()) {
+        QVector<QPointF> points;
+        points.reserve(last - first);
+        for (int i = first; i < last; ++i)
+            points.append(QPointF(xFor(timestamps[i]), yFor(values[i])));
+        if (points.size() == 1)
+            painter.drawPoint(points.first());
+        else
+            painter.drawPolyline(points.constData(), points.size());
+        return;
+    }
+
+    const QVector<MinMaxPyramid::Column> columns = pyramids[index].envelope(from, to, area.width());
+    QVector<QLineF> lines;
+    lines.reserve(2 * columns.size() + 2);
+    bool hasPrevious = first < visibleFirst;
+    double previousX = hasPrevious ? xFor(timestamps[first]) : 0;
+    double previousY = hasPrevious ? yFor(values[first]) : 0;
+    for (int c = 0; c < columns.size(); ++c) {
+        const MinMaxPyramid::Column &column = columns[c];
+        if (column.isEmpty())
+            continue;
+        const double x = area.left() + c + 0.5;
+        if (hasPrevious)
+            lines.append(QLineF(previousX, previousY, x, yFor(values[column.first])));
+        lines.append(QLineF(x, yFor(column.min), x, yFor(column.max)));
+        previousX = x;
+        previousY = yFor(values[column.last - 1]);
+        hasPrevious = true;
+    }
+    if (hasPrevious && visibleLast < series.size())
+        lines.append(QLineF(previousX, previousY, xFor(timestamps[visibleLast]), yFor(values[visibleLast])));
+    painter.drawLines(lines);
+}
+
+/**
+ * @brief Rysuje legendę w górnej części obszaru wykresu, jeśli serie mają nazwy.
+ * @param painter Obiekt rysujący.
+ * @param area Obszar wykresu.
+ */
+void PlotWidget::drawLegend(QPainter &painter, const QRect &area) const
+{
+    if (names.isEmpty())
+        return;
+    const int textHeight = fontMetrics().height();
+    int x = area.left() + 8;
+    int y = area.top() + 6;
+    painter.setPen(palette().color(QPalette::WindowText));
+    for (int i = 0; i < names.size(); ++i) {
+        const int itemWidth = textHeight + 4 + fontMetrics().horizontalAdvance(names[i]) + 12;
+        if (x + itemWidth > area.right() && x > area.left() + 8) {
+            x = area.left() + 8;
+            y += textHeight + 2;
+        }
+        painter.fillRect(QRect(x, y + 2, textHeight - 4, textHeight - 4), QColor(SeriesColors[i % SeriesColorCount]));
+        painter.drawText(QRect(x + textHeight, y, itemWidth - textHeight, textHeight), Qt::AlignLeft | Qt::AlignVCenter,
+                         names[i]);
+        x += itemWidth;
+    }
+}
+
+/**
+ * @brief Przybliża lub oddala oś czasu wokół położenia kursora.
+ * @param event Zdarzenie kółka myszy.
+ */
+void PlotWidget::wheelEvent(QWheelEvent *event)
+{
+    const QRect area = plotArea();
+    if (area.width() <= 0 || event->angleDelta().y() == 0) {
+        event->ignore();
+        return;
+    }
+    const double fraction = qBound(0.0, (event->position().x() - area.left()) / area.width(), 1.0);
+    const qint64 anchor = from + qint64(double(to - from) * fraction);
+    const double factor = event->angleDelta().y() > 0 ? 0.8 : 1.25;
+    changeTimeRange(anchor - qint64(double(anchor - from) * factor), anchor + qint64(double(to - anchor) * factor));
+    event->accept();
+}
+
+/**
+ * @brief Rozpoczyna przesuwanie osi czasu.
+ * @param event Zdarzenie myszy.
+ */
+void PlotWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton) {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+    dragX = int(event->position().x());
+    dragFrom = from;
+    dragTo = to;
+    setCursor(Qt::ClosedHandCursor);
+}
+
+/**
+ * @brief Przesuwa oś czasu o odległość przeciągnięcia.
+ * @param event Zdarzenie myszy.
+ */
+void PlotWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    const QRect area = plotArea();
+    if (dragX < 0 || area.width() <= 0)
+        return;
+    const qint64 shift = qint64((event->position().x() - dragX) * double(dragTo - dragFrom) / area.width());
+    changeTimeRange(dragFrom - shift, dragTo - shift);
+}
+
+/**
+ * @brief Kończy przesuwanie osi czasu.
+ * @param event Zdarzenie myszy.
+ */
+void PlotWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    Q_UNUSED(event);
+    dragX = -1;
+    unsetCursor();
+}
+
+/**
+ * @brief Przywraca pełny zakres osi czasu.
+ * @param event Zdarzenie myszy.
+ */
+void PlotWidget::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    Q_UNUSED(event);
+    qint64 start, end;
+    fullExtent(start, end);
+    changeTimeRange(start, end);
+}
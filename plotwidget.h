@@ -0,0 +1,135 @@
+/**
+ * @file plotwidget.h
+ * @brief Definicja klasy PlotWidget - lekkiego wykresu rysowanego bezpośrednio przez QPainter.
+ */
+
+#ifndef PLOTWIDGET_H
+#define PLOTWIDGET_H
+
+#include <QWidget>
+#include <QVector>
+#include <QStringList>
+#include "measurementseries.h"
+#include "minmaxpyramid.h"
+
+/**
+ * @class PlotWidget
+ * @brief Wykres liniowy dla serii liczących miliony pomiarów.
+ *
+ * Zamiast obiektów QtCharts dla każdego punktu widżet rysuje serie bezpośrednio z ciągłych
+ * kolumn MeasurementSeries. Dla każdej kolumny pikseli rysowany jest pionowy odcinek od
+ * minimum do maksimum oraz odcinek łączący z poprzednią kolumną; minima i maksima kolumn
+ * pochodzą z piramidy MinMaxPyramid, więc przybliżanie i przesuwanie kosztuje O(liczba
+ * pikseli), a nie O(liczba pomiarów). Przy dużym przybliżeniu, gdy widocznych pomiarów jest
+ * niewiele, rysowana jest zwykła łamana przez pomiary.
+ *
+ * Kółko myszy przybliża oś czasu wokół kursora, przeciąganie przesuwa ją, a podwójne
+ * kliknięcie przywraca pełny zakres.
+ */
+class PlotWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Konstruktor klasy PlotWidget.
+     * @param parent Rodzic widżetu.
+     */
+    explicit PlotWidget(QWidget *parent = nullptr);
+
+    /**
+     * @brief Ustawia serie do narysowania.
+     *
+     * Piramidy obwiedni budowane są przy najbliższym rysowaniu, więc ukryty widżet
+     * nie wykonuje żadnej pracy.
+     *
+     * @param series Serie posortowane według czasu (współdzielone, bez kopiowania).
+     * @param names Nazwy serii w legendzie; pusta lista ukrywa legendę.
+     */
+    void setSeries(const QVector<MeasurementSeries> &series, const QStringList &names = QStringList());
+
+    /**
+     * @brief Zwalnia odwołania widżetu do serii przed jej zmianą w miejscu.
+     *
+     * Obiekt wywołujący może wtedy dopisać pomiary do swojej kopii serii bez kopiowania
+     * kolumn. Do wywołania updateSeries seria nie jest rysowana.
+     *
+     * @param index Indeks serii.
+     */
+    void releaseSeries(int index);
+
+    /**
+     * @brief Zastępuje serię jej zmienioną wersją i aktualizuje piramidę od zmienionego miejsca.
+     * @param index Indeks serii.
+     * @param series Seria posortowana według czasu (współdzielona, bez kopiowania).
+     * @param firstChanged Indeks pierwszego zmienionego lub dodanego pomiaru.
+     */
+    void updateSeries(int index, const MeasurementSeries &series, int firstChanged);
+
+    /**
+     * @brief Ustawia widoczny zakres osi czasu.
+     * @param from Początek zakresu w milisekundach od epoki.
+     * @param to Koniec zakresu w milisekundach od epoki.
+     */
+    void setTimeRange(qint64 from, qint64 to);
+
+    /** @brief Zwraca początek widocznego zakresu osi czasu. */
+    qint64 timeFrom() const { return from; }
+
+    /** @brief Zwraca koniec widocznego zakresu osi czasu. */
+    qint64 timeTo() const { return to; }
+
+    /**
+     * @brief Ustawia zakres osi wartości.
+     * @param min Początek osi.
+     * @param max Koniec osi.
+     */
+    void setValueRange(double min, double max);
+
+    /**
+     * @brief Ustawia tytuł wykresu i opis osi wartości.
+     * @param title Tytuł wykresu.
+     * @param axisTitle Opis osi wartości.
+     */
+    void setTitles(const QString &title, const QString &axisTitle);
+
+signals:
+    /**
+     * @brief Emitowany po przybliżeniu lub przesunięciu osi czasu przez użytkownika.
+     * @param from Początek zakresu w milisekundach od epoki.
+     * @param to Koniec zakresu w milisekundach od epoki.
+     */
+    void timeRangeChanged(qint64 from, qint64 to);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+
+private:
+    QRect plotArea() const;
+    void fullExtent(qint64 &start, qint64 &end) const;
+    void changeTimeRange(qint64 newFrom, qint64 newTo);
+    void drawAxes(QPainter &painter, const QRect &area) const;
+    void drawSeries(QPainter &painter, const QRect &area, int index) const;
+    void drawLegend(QPainter &painter, const QRect &area) const;
+
+    QVector<MeasurementSeries> seriesList;
+    QStringList names;
+    QVector<MinMaxPyramid> pyramids;
+    bool pyramidsDirty = false;
+    QString title;
+    QString axisTitle;
+    qint64 from = 0;
+    qint64 to = 0;
+    double minValue = 0;
+    double maxValue = 1;
+    int dragX = -1;
+    qint64 dragFrom = 0;
+    qint64 dragTo = 0;
+};
+
+#endif // PLOTWIDGET_H
@@ -0,0 +1,337 @@
+/**
+ * @file rollupstore.cpp
+ * @brief Implementacja dobowych i miesięcznych agregatów pomiarów.
+ */
+#include "rollupstore.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QtGlobal>
+#include <cstring>
+
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+#error "Format pliku agregatów zakłada kolejność bajtów little-endian."
+#endif
+
+namespace {
+
+const char FileMagic[4] = { 'J', 'P', 'R', 'U' };
+const quint16 FormatVersion = 1;
+
+/**
+ * @struct FileHeader
+ * @brief Nagłówek pliku agregatów. Rekordy RollupBucket następują zaraz po nim.
+ *
+ * pointCount to liczba pomiarów objętych agregatami. W plikach zapisanych przed jej
+ * wprowadzeniem pole ma wartość 0, więc agregaty niepustego sensora są odbudowywane.
+ */
+struct FileHeader {
+    char magic[4];
+    quint16 version;
+    quint16 tier;
+    quint32 count;
+    quint32 pointCount;
+};
+
+static_assert(sizeof(FileHeader) == 16, "Nieprawidłowy rozmiar nagłówka pliku agregatów");
+static_assert(sizeof(RollupBucket) == 48, "Nieprawidłowy rozmiar rekordu agregatu");
+
+/**
+ * @brief Odczytuje i sprawdza nagłówek pliku agregatów.
+ * @param file Plik otwarty do odczytu.
+ * @param tier Oczekiwany poziom.
+ * @param header Odczytany nagłówek.
+ * @return true, jeśli nagłówek jest poprawny.
+ */
+bool readHeader(QFile &file, quint16 tier, FileHeader &header)
+{
+    return file.read(reinterpret_cast<char *>(&header), sizeof(header)) == qint64(sizeof(header))
+           && std::memcmp(header.magic, FileMagic, sizeof(FileMagic)) == 0
+           && header.version == FormatVersion && header.tier == tier;
+}
+
+}
+
+/**
+ * @brief Dodaje pomiar do agregatu.
+ * @param value Wartość pomiaru.
+ */
+void RollupBucket::add(double value)
+{
+    min = (count == 0 || value < min) ? value : min;
+    max = (count == 0 || value > max) ? value : max;
+    ++count;
+    sum += value;
+    sumSquares += value * value;
+}
+
+/**
+ * @brief Dołącza do agregatu inny agregat tego samego przedziału.
+ * @param other Agregat do dołączenia.
+ */
+void RollupBucket::merge(const RollupBucket &other)
+{
+    if (other.count == 0)
+        return;
+    min = (count == 0 || other.min < min) ? other.min : min;
+    max = (count == 0 || other.max > max) ? other.max : max;
+    count += other.count;
+    sum += other.sum;
+    sumSquares += other.sumSquares;
+}
+
+/**
+ * @brief Konstruktor klasy RollupStore.
+ * @param basePath Ścieżka bazowa plików agregatów.
+ */
+RollupStore::RollupStore(const QString &basePath)
+    : basePath(basePath)
+{
+}
+
+/**
+ * @brief Zwraca liczbę pomiarów objętych agregatami.
+ *
+ * Odczytywane są tylko nagłówki plików. Poziomy zapisywane są kolejno, więc po
+ * przerwanym zapisie mogą podawać różne liczby - agregaty uznawane są wtedy za nieaktualne.
+ *
+ * @return Liczba pomiarów lub -1, jeśli plików brak, są uszkodzone albo poziomy się różnią.
+ */
+qint64 RollupStore::pointCount() const
+{
+    qint64 points = -1;
+    for (Tier tier : { Daily, Monthly }) {
+        QFile file(tierPath(tier));
+        FileHeader header;
+        if (!file.open(QIODevice::ReadOnly) || !readHeader(file, quint16(tier), header))
+            return -1;
+        if (points >= 0 && points != qint64(header.pointCount))
+            return -1;
+        points = qint64(header.pointCount);
+    }
+    return points;
+}
+
+/**
+ * @brief Dodaje nowe pomiary do wszystkich poziomów.
+ *
+ * Pomiary sumowane są w przedziały, a następnie scalane z zapisanymi agregatami
+ * jednym przejściem po obu posortowanych tablicach. Wywołujący odpowiada za to,
+ * aby pomiary nie były wcześniej dodane (inaczej zostałyby policzone podwójnie).
+ *
+ * @param series Pomiary posortowane według czasu.
+ * @return true, jeśli zapis się powiódł.
+ */
+bool RollupStore::add(const MeasurementSeries &series)
+{
+    if (series.isEmpty())
+        return true;
+
+    for (Tier tier : { Daily, Monthly }) {
+        const QVector<RollupBucket> fresh = aggregate(tier, series);
+        QVector<RollupBucket> stored;
+        qint64 points = 0;
+        if (!load(tier, stored, points))
+            return false;
+
+        QVector<RollupBucket> merged;
+        merged.reserve(stored.size() + fresh.size());
+        int i = 0, j = 0;
+        while (i < stored.size() || j < fresh.size()) {
+            if (j == fresh.size() || (i < stored.size() && stored[i].start < fresh[j].start)) {
+                merged.append(stored[i++]);
+            } else if (i == stored.size() || fresh[j].start < stored[i].start) {
+                merged.append(fresh[j++]);
+            } else {
+                RollupBucket bucket = stored[i++];
+                bucket.merge(fresh[j++]);
+                merged.append(bucket);
+            }
+        }
+        if (!save(tier, merged, points + series.size()))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Tworzy agregaty od nowa na podstawie wszystkich pomiarów sensora.
+ * @param series Wszystkie pomiary posortowane według czasu.
+ * @return true, jeśli zapis się powiódł.
+ */
+bool RollupStore::rebuild(const MeasurementSeries &series)
+{
+    return save(Daily, aggregate(Daily, series), series.size())
+           && save(Monthly, aggregate(Monthly, series), series.size());
+}
+
+/**
+ * @brief Wczytuje agregaty poziomu, których przedziały w całości mieszczą się w [from, to].
+ *
+ * Przedziały poziomu przylegają do siebie, więc przedział zaczynający się w start kończy
+ * się przed to + 1 wtedy i tylko wtedy, gdy start poprzedza początek przedziału
+ * zawierającego to + 1. Granice wyznaczane są więc raz, a nie dla każdego agregatu.
+ *
+ * @param tier Poziom (Daily lub Monthly).
+ * @param from Początek przedziału w milisekundach od epoki.
+ * @param to Koniec przedziału w milisekundach od epoki.
+ * @param buckets Wektor, do którego trafią agregaty.
+ * @return true, jeśli odczyt się powiódł.
+ */
+bool RollupStore::read(Tier tier, qint64 from, qint64 to, QVector<RollupBucket> &buckets) const
+{
+    QVector<RollupBucket> stored;
+    qint64 points = 0;
+    if (!load(tier, stored, points))
+        return false;
+
+    const qint64 end = bucketStart(tier, to + 1);
+    for (const RollupBucket &bucket : std::as_const(stored)) {
+        if (bucket.start >= from && bucket.start < end)
+            buckets.append(bucket);
+    }
+    return true;
+}
+
+/**
+ * @brief Wybiera najmniej szczegółowy poziom, który daje co najmniej MinimumBuckets punktów.
+ * @param from Początek przedziału w milisekundach od epoki.
+ * @param to Koniec przedziału w milisekundach od epoki.
+ * @return Wybrany poziom.
+ */
+RollupStore::Tier RollupStore::tierForRange(qint64 from, qint64 to)
+{
+    const qint64 days = (to - from) / (24LL * 3600 * 1000);
+    if (days / 30 >= MinimumBuckets)
+        return Monthly;
+    if (days >= MinimumBuckets)
+        return Daily;
+    return Hourly;
+}
+
+/**
+ * @brief Zwraca początek przedziału poziomu zawierającego podany czas.
+ *
+ * Przedziały wyznaczane są w czasie lokalnym, tak jak daty wyświetlane użytkownikowi.
+ *
+ * @param tier Poziom (Daily lub Monthly).
+ * @param timestamp Czas w milisekundach od epoki.
+ * @return Początek doby lub miesiąca w milisekundach od epoki.
+ */
+qint64 RollupStore::bucketStart(Tier tier, qint64 timestamp)
+{
+    QDate date = QDateTime::fromMSecsSinceEpoch(timestamp).date();
+    if (tier == Monthly)
+        date = QDate(date.year(), date.month(), 1);
+    return date.startOfDay().toMSecsSinceEpoch();
+}
+
+/**
+ * @brief Zwraca początek przedziału następującego po przedziale zaczynającym się w start.
+ * @param tier Poziom (Daily lub Monthly).
+ * @param start Początek przedziału.
+ * @return Początek następnej doby lub miesiąca w milisekundach od epoki.
+ */
+qint64 RollupStore::nextBucketStart(Tier tier, qint64 start)
+{
+    const QDate date = QDateTime::fromMSecsSinceEpoch(start).date();
+    return (tier == Monthly ? date.addMonths(1) : date.addDays(1)).startOfDay().toMSecsSinceEpoch();
+}
+
+/**
+ * @brief Zwraca ścieżkę pliku poziomu.
+ * @param tier Poziom (Daily lub Monthly).
+ */
+QString RollupStore::tierPath(Tier tier) const
+{
+    return basePath + (tier == Monthly ? "-miesiace.bin" : "-doby.bin");
+}
+
+/**
+ * @brief Wczytuje wszystkie agregaty poziomu.
+ * @param tier Poziom.
+ * @param buckets Wektor, do którego trafią agregaty (brak pliku oznacza brak agregatów).
+ * @param pointCount Liczba pomiarów objętych agregatami.
+ * @return false, jeśli plik istnieje, ale jest uszkodzony.
+ */
+bool RollupStore::load(Tier tier, QVector<RollupBucket> &buckets, qint64 &pointCount) const
+{
+    buckets.clear();
+    pointCount = 0;
+    QFile file(tierPath(tier));
+    if (!file.exists())
+        return true;
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    FileHeader header;
+    if (!readHeader(file, quint16(tier), header))
+        return false;
+    pointCount = qint64(header.pointCount);
+
+    buckets.resize(int(header.count));
+    const qint64 bytes = qint64(header.count) * qint64(sizeof(RollupBucket));
+    if (file.read(reinterpret_cast<char *>(buckets.data()), bytes) != bytes) {
+        buckets.clear();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Zapisuje wszystkie agregaty poziomu.
+ * @param tier Poziom.
+ * @param buckets Agregaty posortowane według początku przedziału.
+ * @param pointCount Liczba pomiarów objętych agregatami.
+ * @return true, jeśli zapis się powiódł.
+ */
+bool RollupStore::save(Tier tier, const QVector<RollupBucket> &buckets, qint64 pointCount) const
+{
+    QSaveFile file(tierPath(tier));
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    FileHeader header;
+    std::memcpy(header.magic, FileMagic, sizeof(FileMagic));
+    header.version = FormatVersion;
+    header.tier = quint16(tier);
+    header.count = quint32(buckets.size());
+    header.pointCount = quint32(pointCount);
+
+    const qint64 bytes = qint64(buckets.size()) * qint64(sizeof(RollupBucket));
+    if (file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != qint64(sizeof(header))
+        || file.write(reinterpret_cast<const char *>(buckets.constData()), bytes) != bytes) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+/**
+ * @brief Sumuje posortowane pomiary w przedziały poziomu.
+ *
+ * Granice przedziału liczone są tylko przy przejściu do następnego przedziału,
+ * a nie dla każdego pomiaru.
+ *
+ * @param tier Poziom (Daily lub Monthly).
+ * @param series Pomiary posortowane według czasu.
+ * @return Agregaty niepustych przedziałów.
+ */
+QVector<RollupBucket> RollupStore::aggregate(Tier tier, const MeasurementSeries &series)
+{
+    QVector<RollupBucket> buckets;
+    const qint64 *timestamps = series.timestamps().constData();
+    const double *values = series.values().constData();
+    qint64 end = 0;
+
+    for (int i = 0; i < series.size(); ++i) {
+        if (buckets.isEmpty() || timestamps[i] >= end) {
+            RollupBucket bucket;
+            bucket.start = bucketStart(tier, timestamps[i]);
+            end = nextBucketStart(tier, bucket.start);
+            buckets.append(bucket);
+        }
+        buckets.last().add(values[i]);
+    }
+    return buckets;
+}
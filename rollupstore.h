@@ -0,0 +1,151 @@
+/**
+ * @file rollupstore.h
+ * @brief Definicja klasy RollupStore - zagregowanych (dobowych i miesięcznych) pomiarów sensora.
+ */
+
+#ifndef ROLLUPSTORE_H
+#define ROLLUPSTORE_H
+
+#include <QString>
+#include <QVector>
+#include "measurementseries.h"
+
+/**
+ * @struct RollupBucket
+ * @brief Agregat pomiarów z jednego przedziału czasu (doby lub miesiąca).
+ */
+struct RollupBucket
+{
+    /** @brief Początek przedziału w milisekundach od epoki (północ czasu lokalnego). */
+    qint64 start = 0;
+
+    /** @brief Liczba pomiarów. */
+    qint64 count = 0;
+
+    /** @brief Suma wartości. */
+    double sum = 0;
+
+    /** @brief Najmniejsza wartość. */
+    double min = 0;
+
+    /** @brief Największa wartość. */
+    double max = 0;
+
+    /** @brief Suma kwadratów wartości. */
+    double sumSquares = 0;
+
+    /** @brief Dodaje pomiar do agregatu. */
+    void add(double value);
+
+    /** @brief Dołącza do agregatu inny agregat tego samego przedziału. */
+    void merge(const RollupBucket &other);
+
+    /** @brief Zwraca średnią wartość. */
+    double mean() const { return count > 0 ? sum / count : 0; }
+};
+
+/**
+ * @class RollupStore
+ * @brief Poziomy agregatów (dobowy i miesięczny) utrzymywane obok pliku z pomiarami.
+ *
+ * Każdy poziom to osobny plik binarny z posortowaną tablicą agregatów (RollupBucket).
+ * Agregaty są aktualizowane przyrostowo: nowe pomiary sumowane są w przedziały
+ * i scalane z zapisanymi, bez ponownego czytania pomiarów godzinowych.
+ * Pliki są małe (doba to jeden rekord), więc zapisywane są w całości przez QSaveFile.
+ * Nagłówek każdego pliku podaje liczbę pomiarów objętych agregatami; jej niezgodność
+ * z plikiem pomiarów oznacza agregaty nieaktualne (np. po przerwanym zapisie).
+ */
+class RollupStore
+{
+public:
+    /**
+     * @enum Tier
+     * @brief Rozdzielczość danych.
+     */
+    enum Tier {
+        Hourly,     ///< Pomiary godzinowe (plik MeasurementStore).
+        Daily,      ///< Agregaty dobowe.
+        Monthly     ///< Agregaty miesięczne.
+    };
+
+    /** @brief Minimalna liczba punktów wykresu, którą musi zapewnić wybrany poziom. */
+    static const int MinimumBuckets = 100;
+
+    /**
+     * @brief Konstruktor klasy RollupStore.
+     * @param basePath Ścieżka bazowa; pliki poziomów mają przyrostki "-doby.bin" i "-miesiace.bin".
+     */
+    explicit RollupStore(const QString &basePath);
+
+    /**
+     * @brief Zwraca liczbę pomiarów objętych agregatami.
+     * @return Liczba pomiarów lub -1, jeśli plików brak, są uszkodzone albo poziomy się różnią.
+     */
+    qint64 pointCount() const;
+
+    /**
+     * @brief Dodaje nowe pomiary do wszystkich poziomów.
+     * @param series Pomiary, których nie ma jeszcze w agregatach.
+     * @return true, jeśli zapis się powiódł.
+     */
+    bool add(const MeasurementSeries &series);
+
+    /**
+     * @brief Tworzy agregaty od nowa na podstawie wszystkich pomiarów sensora.
+     * @param series Wszystkie pomiary sensora.
+     * @return true, jeśli zapis się powiódł.
+     */
+    bool rebuild(const MeasurementSeries &series);
+
+    /**
+     * @brief Wczytuje agregaty poziomu, których przedziały w całości mieszczą się w [from, to].
+     *
+     * Agregaty przedziałów obejmujących tylko część [from, to] są pomijane; wywołujący
+     * wyznacza je z pomiarów godzinowych (aggregate).
+     *
+     * @param tier Poziom (Daily lub Monthly).
+     * @param from Początek przedziału w milisekundach od epoki.
+     * @param to Koniec przedziału w milisekundach od epoki.
+     * @param buckets Wektor, do którego trafią agregaty.
+     * @return true, jeśli odczyt się powiódł.
+     */
+    bool read(Tier tier, qint64 from, qint64 to, QVector<RollupBucket> &buckets) const;
+
+    /**
+     * @brief Wybiera najmniej szczegółowy poziom, który daje co najmniej MinimumBuckets punktów.
+     * @param from Początek przedziału w milisekundach od epoki.
+     * @param to Koniec przedziału w milisekundach od epoki.
+     */
+    static Tier tierForRange(qint64 from, qint64 to);
+
+    /**
+     * @brief Zwraca początek przedziału poziomu zawierającego podany czas.
+     * @param tier Poziom (Daily lub Monthly).
+     * @param timestamp Czas w milisekundach od epoki.
+     */
+    static qint64 bucketStart(Tier tier, qint64 timestamp);
+
+    /**
+     * @brief Zwraca początek przedziału następującego po przedziale zaczynającym się w start.
+     * @param tier Poziom (Daily lub Monthly).
+     * @param start Początek przedziału.
+     */
+    static qint64 nextBucketStart(Tier tier, qint64 start);
+
+    /**
+     * @brief Sumuje posortowane pomiary w przedziały poziomu.
+     * @param tier Poziom (Daily lub Monthly).
+     * @param series Pomiary posortowane według czasu.
+     * @return Agregaty niepustych przedziałów.
+     */
+    static QVector<RollupBucket> aggregate(Tier tier, const MeasurementSeries &series);
+
+private:
+    QString tierPath(Tier tier) const;
+    bool load(Tier tier, QVector<RollupBucket> &buckets, qint64 &pointCount) const;
+    bool save(Tier tier, const QVector<RollupBucket> &buckets, qint64 pointCount) const;
+
+    QString basePath;
+};
+
+#endif // ROLLUPSTORE_H
@@ -0,0 +1,118 @@
+/**
+ * @file seriesjoin.cpp
+ * @brief Implementacja wyrównania serii pomiarów na wspólnej osi czasu.
+ */
+#include "seriesjoin.h"
+#include <QtMath>
+#include <cmath>
+#include <limits>
+
+/**
+ * @brief Zwraca liczbę wierszy, w których wszystkie serie mają pomiar.
+ * @return Liczba pełnych wierszy.
+ */
+int AlignedSeries::completeRows() const
+{
+    int count = 0;
+    for (int row = 0; row < size(); ++row) {
+        bool complete = true;
+        for (const QVector<double> &column : values)
+            complete = complete && !qIsNaN(column[row]);
+        count += complete ? 1 : 0;
+    }
+    return count;
+}
+
+/**
+ * @brief Łączy posortowane serie według znaczników czasu (złączenie zewnętrzne).
+ * @param series Serie posortowane według czasu.
+ * @return Tabela z kolumną wartości dla każdej serii wejściowej.
+ */
+AlignedSeries alignSeries(const QVector<MeasurementSeries> &series)
+{
+    const int columns = series.size();
+    AlignedSeries aligned;
+    aligned.values.resize(columns);
+
+    int longest = 0;
+    for (const MeasurementSeries &s : series)
+        longest = qMax(longest, s.size());
+    aligned.timestamps.reserve(longest);
+    for (QVector<double> &column : aligned.values)
+        column.reserve(longest);
+
+    const double missing = std::numeric_limits<double>::quiet_NaN();
+    QVector<int> cursors(columns, 0);
+    for (;;) {
+        qint64 next = std::numeric_limits<qint64>::max();
+        bool any = false;
+        for (int c = 0; c < columns; ++c) {
+            if (cursors[c] < series[c].size()) {
+                next = qMin(next, series[c].timestamp(cursors[c]));
+                any = true;
+            }
+        }
+        if (!any)
+            break;
+
+        aligned.timestamps.append(next);
+        for (int c = 0; c < columns; ++c) {
+            const MeasurementSeries &s = series[c];
+            int &cursor = cursors[c];
+            if (cursor < s.size() && s.timestamp(cursor) == next) {
+                aligned.values[c].append(s.value(cursor));
+                while (cursor < s.size() && s.timestamp(cursor) == next)
+                    ++cursor;
+            } else {
+                aligned.values[c].append(missing);
+            }
+        }
+    }
+    return aligned;
+}
+
+/**
+ * @brief Oblicza współczynnik korelacji Pearsona dwóch kolumn wyrównanej tabeli.
+ *
+ * Średnie liczone są w pierwszym przebiegu, a sumy iloczynów odchyleń w drugim, co
+ * zapobiega utracie dokładności przy dużych wartościach.
+ *
+ * @param aligned Wyrównane serie.
+ * @param first Numer pierwszej kolumny.
+ * @param second Numer drugiej kolumny.
+ * @param pairs Jeśli podano, otrzymuje liczbę uwzględnionych wierszy.
+ * @return Współczynnik korelacji lub NaN, jeśli nie da się go wyznaczyć.
+ */
+double correlation(const AlignedSeries &aligned, int first, int second, int *pairs)
+{
+    const QVector<double> &x = aligned.values[first];
+    const QVector<double> &y = aligned.values[second];
+
+    int count = 0;
+    double sumX = 0, sumY = 0;
+    for (int row = 0; row < aligned.size(); ++row) {
+        if (qIsNaN(x[row]) || qIsNaN(y[row]))
+            continue;
+        sumX += x[row];
+        sumY += y[row];
+        ++count;
+    }
+    if (pairs)
+        *pairs = count;
+    if (count < 2)
+        return std::numeric_limits<double>::quiet_NaN();
+
+    const double meanX = sumX / count, meanY = sumY / count;
+    double covariance = 0, varianceX = 0, varianceY = 0;
+    for (int row = 0; row < aligned.size(); ++row) {
+        if (qIsNaN(x[row]) || qIsNaN(y[row]))
+            continue;
+        const double dx = x[row] - meanX, dy = y[row] - meanY;
+        covariance += dx * dy;
+        varianceX += dx * dx;
+        varianceY += dy * dy;
+    }
+    if (varianceX <= 0 || varianceY <= 0)
+        return std::numeric_limits<double>::quiet_NaN();
+    return covariance / std::sqrt(varianceX * varianceY);
+}
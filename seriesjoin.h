@@ -0,0 +1,59 @@
+/**
+ * @file seriesjoin.h
+ * @brief Wyrównanie kilku serii pomiarów na wspólnej osi czasu.
+ */
+
+#ifndef SERIESJOIN_H
+#define SERIESJOIN_H
+
+#include <QVector>
+#include "measurementseries.h"
+
+/**
+ * @struct AlignedSeries
+ * @brief Kilka serii pomiarów zapisanych jako tabela o wspólnej kolumnie czasu.
+ *
+ * Wiersz tabeli odpowiada jednemu znacznikowi czasu występującemu w którejkolwiek
+ * serii. Brak pomiaru serii w danym wierszu oznaczany jest wartością NaN.
+ */
+struct AlignedSeries
+{
+    /** @brief Wspólna, rosnąca kolumna znaczników czasu. */
+    QVector<qint64> timestamps;
+
+    /** @brief Kolumny wartości, po jednej na serię, o długości kolumny czasu. */
+    QVector<QVector<double>> values;
+
+    /** @brief Zwraca liczbę wierszy. */
+    int size() const { return timestamps.size(); }
+
+    /** @brief Zwraca liczbę wierszy, w których wszystkie serie mają pomiar. */
+    int completeRows() const;
+};
+
+/**
+ * @brief Łączy posortowane serie według znaczników czasu (złączenie zewnętrzne).
+ *
+ * Serie przeglądane są jednocześnie, po jednym kursorze na serię (merge-join), więc
+ * koszt jest liniowy względem łącznej liczby pomiarów. Powtórzony znacznik czasu w jednej
+ * serii jest pomijany (zachowywany jest pierwszy pomiar).
+ *
+ * @param series Serie posortowane według czasu.
+ * @return Tabela z kolumną wartości dla każdej serii wejściowej.
+ */
+AlignedSeries alignSeries(const QVector<MeasurementSeries> &series);
+
+/**
+ * @brief Oblicza współczynnik korelacji Pearsona dwóch kolumn wyrównanej tabeli.
+ *
+ * Uwzględniane są tylko wiersze, w których obie serie mają pomiar.
+ *
+ * @param aligned Wyrównane serie.
+ * @param first Numer pierwszej kolumny.
+ * @param second Numer drugiej kolumny.
+ * @param pairs Jeśli podano, otrzymuje liczbę uwzględnionych wierszy.
+ * @return Współczynnik korelacji lub NaN, jeśli nie da się go wyznaczyć.
+ */
+double correlation(const AlignedSeries &aligned, int first, int second, int *pairs = nullptr);
+
+#endif // SERIESJOIN_H
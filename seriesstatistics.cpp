@@ -0,0 +1,421 @@
+/**
+ * @file seriesstatistics.cpp
+ * @brief Implementacja statystyk opisowych serii pomiarów.
+ */
+#include "seriesstatistics.h"
+#include "tracing.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+/** @brief Liczba niezależnych akumulatorów w pętlach sumujących. */
+const int Lanes = 4;
+
+/**
+ * @brief Sumuje wartości w kilku niezależnych akumulatorach.
+ */
+double sum(const double *values, int count)
+{
+    double acc[Lanes] = {};
+    int i = 0;
+    for (; i + Lanes <= count; i += Lanes)
+        for (int lane = 0; lane < Lanes; ++lane)
+            acc[lane] += values[i + lane];
+    for (; i < count; ++i)
+        acc[0] += values[i];
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+/**
+ * @struct Moments
+ * @brief Wyniki jednego przebiegu po serii: skrajne wartości z indeksami i sumy do momentów.
+ *
+ * Sumy liczone są względem przesunięcia (pierwszej wartości i pierwszego znacznika czasu,
+ * w godzinach), co zachowuje dokładność wariancji i regresji bez drugiego przebiegu.
+ */
+struct Moments
+{
+    double min = 0, max = 0;
+    int minIndex = -1, maxIndex = -1;
+    double sumY = 0, sumYY = 0, sumX = 0, sumXX = 0, sumXY = 0;
+};
+
+/**
+ * @brief Wyznacza w jednym przebiegu minimum, maksimum (z indeksami) i sumy momentów.
+ *
+ * Każdy z akumulatorów zapamiętuje najwcześniejszy indeks swojej skrajnej wartości;
+ * przy łączeniu akumulatorów remisy rozstrzygane są na korzyść mniejszego indeksu.
+ */
+Moments fusedMoments(const qint64 *timestamps, const double *values, int count)
+{
+    const double shift = values[0];
+    const qint64 origin = timestamps[0];
+    const double hoursPerMs = 1.0 / (3600.0 * 1000.0);
+    double lo[Lanes], hi[Lanes];
+    int loIndex[Lanes], hiIndex[Lanes];
+    double y[Lanes] = {}, yy[Lanes] = {}, x[Lanes] = {}, xx[Lanes] = {}, xy[Lanes] = {};
+    for (int lane = 0; lane < Lanes; ++lane) {
+        lo[lane] = hi[lane] = values[0];
+        loIndex[lane] = hiIndex[lane] = 0;
+    }
+
+    int i = 0;
+    for (; i + Lanes <= count; i += Lanes) {
+        for (int lane = 0; lane < Lanes; ++lane) {
+            const double v = values[i + lane];
+            const bool lower = v < lo[lane];
+            const bool higher = v > hi[lane];
+            lo[lane] = lower ? v : lo[lane];
+            loIndex[lane] = lower ? i + lane : loIndex[lane];
+            hi[lane] = higher ? v : hi[lane];
+            hiIndex[lane] = higher ? i + lane : hiIndex[lane];
+            const double dy = v - shift;
+            const double dx = double(timestamps[i + lane] - origin) * hoursPerMs;
+            y[lane] += dy;
+            yy[lane] += dy * dy;
+            x[lane] += dx;
+            xx[lane] += dx * dx;
+            xy[lane] += dx * dy;
+        }
+    }
+    for (; i < count; ++i) {
+        const double v = values[i];
+        if (v < lo[0] || (v == lo[0] && i < loIndex[0])) {
+            lo[0] = v;
+            loIndex[0] = i;
+        }
+        if (v > hi[0] || (v == hi[0] && i < hiIndex[0])) {
+            hi[0] = v;
+            hiIndex[0] = i;
+        }
+        const double dy = v - shift;
+        const double dx = double(timestamps[i] - origin) * hoursPerMs;
+        y[0] += dy;
+        yy[0] += dy * dy;
+        x[0] += dx;
+        xx[0] += dx * dx;
+        xy[0] += dx * dy;
+    }
+
+    Moments m;
+    m.min = lo[0];
+    m.minIndex = loIndex[0];
+    m.max = hi[0];
+    m.maxIndex = hiIndex[0];
+    for (int lane = 1; lane < Lanes; ++lane) {
+        if (lo[lane] < m.min || (lo[lane] == m.min && loIndex[lane] < m.minIndex)) {
+            m.min = lo[lane];
+            m.minIndex = loIndex[lane];
+        }
+        if (hi[lane] > m.max || (hi[lane] == m.max && hiIndex[lane] < m.maxIndex)) {
+            m.max = hi[lane];
+            m.maxIndex = hiIndex[lane];
+        }
+    }
+    m.sumY = (y[0] + y[1]) + (y[2] + y[3]);
+    m.sumYY = (yy[0] + yy[1]) + (yy[2] + yy[3]);
+    m.sumX = (x[0] + x[1]) + (x[2] + x[3]);
+    m.sumXX = (xx[0] + xx[1]) + (xx[2] + xx[3]);
+    m.sumXY = (xy[0] + xy[1]) + (xy[2] + xy[3]);
+    return m;
+}
+
+/**
+ * @brief Oblicza nachylenie prostej regresji y(t) metodą najmniejszych kwadratów.
+ *
+ * Czas liczony jest w godzinach od pierwszego pomiaru, a sumy - względem średnich,
+ * co zachowuje dokładność dla dużych znaczników czasu.
+ */
+double leastSquaresSlope(const qint64 *timestamps, const double *values, int count, double meanValue)
+{
+    if (count < 2)
+        return 0;
+
+    const qint64 origin = timestamps[0];
+    const double msPerHour = 3600.0 * 1000.0;
+    double accX[Lanes] = {};
+    int i = 0;
+    for (; i + Lanes <= count; i += Lanes)
+        for (int lane = 0; lane < Lanes; ++lane)
+            accX[lane] += double(timestamps[i + lane] - origin);
+    for (; i < count; ++i)
+        accX[0] += double(timestamps[i] - origin);
+    const double meanX = ((accX[0] + accX[1]) + (accX[2] + accX[3])) / count;
+
+    double accXY[Lanes] = {}, accXX[Lanes] = {};
+    i = 0;
+    for (; i + Lanes <= count; i += Lanes) {
+        for (int lane = 0; lane < Lanes; ++lane) {
+            const double dx = double(timestamps[i + lane] - origin) - meanX;
+            accXY[lane] += dx * (values[i + lane] - meanValue);
+            accXX[lane] += dx * dx;
+        }
+    }
+    for (; i < count; ++i) {
+        const double dx = double(timestamps[i] - origin) - meanX;
+        accXY[0] += dx * (values[i] - meanValue);
+        accXX[0] += dx * dx;
+    }
+    const double sxy = (accXY[0] + accXY[1]) + (accXY[2] + accXY[3]);
+    const double sxx = (accXX[0] + accXX[1]) + (accXX[2] + accXX[3]);
+    return sxx > 0 ? sxy / sxx * msPerHour : 0;
+}
+
+/**
+ * @brief Wyznacza wartość na (ułamkowej) pozycji w porządku rosnącym.
+ *
+ * Element na pozycji całkowitej wyznaczany jest przez std::nth_element w zakresie
+ * [from, count), a następny - jako minimum części tablicy za nim. Zakres można zawęzić,
+ * jeśli poprzednia selekcja umieściła na pozycji from element na właściwym miejscu,
+ * bo wszystkie elementy za nim są wtedy nie mniejsze.
+ */
+double selectInterpolated(double *values, int count, int from, double position)
+{
+    const int index = int(position);
+    std::nth_element(values + from, values + index, values + count);
+    const double lower = values[index];
+    if (index + 1 >= count)
+        return lower;
+    const double upper = *std::min_element(values + index + 1, values + count);
+    return lower + (upper - lower) * (position - index);
+}
+
+/**
+ * @brief Wyznacza percentyle P50, P95 i P98 na kopii wartości w podanym buforze.
+ *
+ * Każda kolejna selekcja obejmuje tylko górną część tablicy pozostawioną przez poprzednią.
+ */
+void selectPercentiles(const double *values, int count, QVector<double> &scratch, SeriesStatistics &stats)
+{
+    scratch.resize(count);
+    double *data = scratch.data();
+    std::copy(values, values + count, data);
+    const double p50Position = 0.50 * (count - 1);
+    const double p95Position = 0.95 * (count - 1);
+    const double p98Position = 0.98 * (count - 1);
+    stats.p50 = selectInterpolated(data, count, 0, p50Position);
+    stats.p95 = selectInterpolated(data, count, int(p50Position), p95Position);
+    stats.p98 = selectInterpolated(data, count, int(p95Position), p98Position);
+}
+
+/**
+ * @brief Oblicza statystyki serii z bufora roboczego na percentyle.
+ */
+SeriesStatistics computeWithScratch(const MeasurementSeries &series, QVector<double> &scratch)
+{
+    SeriesStatistics stats;
+    const int count = series.size();
+    if (count == 0)
+        return stats;
+
+    const double *values = series.values().constData();
+    const Moments m = fusedMoments(series.timestamps().constData(), values, count);
+    stats.count = count;
+    stats.min = m.min;
+    stats.minIndex = m.minIndex;
+    stats.max = m.max;
+    stats.maxIndex = m.maxIndex;
+
+    const double meanShifted = m.sumY / count;
+    stats.mean = values[0] + meanShifted;
+    stats.standardDeviation = std::sqrt(qMax(0.0, m.sumYY / count - meanShifted * meanShifted));
+    const double sxx = m.sumXX - m.sumX * m.sumX / count;
+    const double sxy = m.sumXY - m.sumX * m.sumY / count;
+    stats.slopePerHour = count > 1 && sxx > 0 ? sxy / sxx : 0;
+    selectPercentiles(values, count, scratch, stats);
+    return stats;
+}
+
+}
+
+/**
+ * @brief Oblicza statystyki serii.
+ *
+ * Minimum i maksimum z indeksami, średnia, odchylenie standardowe i regresja wyznaczane
+ * są w jednym przebiegu po kolumnach czasu i wartości (fusedMoments). Percentyle wymagają
+ * osobnej selekcji na kopii wartości.
+ *
+ * @param series Seria pomiarów.
+ * @return Statystyki serii.
+ */
+SeriesStatistics SeriesStatistics::compute(const MeasurementSeries &series)
+{
+    TRACE_SPAN("statistics");
+    QVector<double> scratch;
+    return computeWithScratch(series, scratch);
+}
+
+/**
+ * @brief Oblicza statystyki kilku serii w jednym wywołaniu.
+ *
+ * Każda seria przeglądana jest jednym przebiegiem, a wszystkie selekcje percentyli
+ * korzystają z jednego bufora roboczego o rozmiarze najdłuższej serii, więc obliczenia
+ * nie alokują pamięci dla każdej serii osobno. Serie nie są przeplatane w jednej pętli:
+ * mają różne długości i osie czasu, a każda z osobna wypełnia już wszystkie akumulatory.
+ *
+ * @param series Serie pomiarów.
+ * @return Statystyki w kolejności serii wejściowych.
+ */
+QVector<SeriesStatistics> SeriesStatistics::compute(const QVector<MeasurementSeries> &series)
+{
+    TRACE_SPAN("statistics");
+    int longest = 0;
+    for (const MeasurementSeries &s : series)
+        longest = qMax(longest, s.size());
+    QVector<double> scratch;
+    scratch.reserve(longest);
+
+    QVector<SeriesStatistics> result;
+    result.reserve(series.size());
+    for (const MeasurementSeries &s : series)
+        result.append(computeWithScratch(s, scratch));
+    return result;
+}
+
+/**
+ * @brief Oblicza statystyki na podstawie agregatów.
+ * @param buckets Agregaty posortowane według czasu.
+ * @return Statystyki agregatów.
+ */
+SeriesStatistics SeriesStatistics::fromRollups(const QVector<RollupBucket> &buckets)
+{
+    SeriesStatistics stats;
+    qint64 count = 0;
+    double total = 0, totalSquares = 0;
+    QVector<qint64> starts;
+    QVector<double> means;
+    starts.reserve(buckets.size());
+    means.reserve(buckets.size());
+
+    for (int i = 0; i < buckets.size(); ++i) {
+        const RollupBucket &bucket = buckets[i];
+        if (bucket.count == 0)
+            continue;
+        if (stats.minIndex < 0 || bucket.min < stats.min) {
+            stats.min = bucket.min;
+            stats.minIndex = i;
+        }
+        if (stats.maxIndex < 0 || bucket.max > stats.max) {
+            stats.max = bucket.max;
+            stats.maxIndex = i;
+        }
+        count += bucket.count;
+        total += bucket.sum;
+        totalSquares += bucket.sumSquares;
+        starts.append(bucket.start);
+        means.append(bucket.mean());
+    }
+    if (count == 0)
+        return stats;
+
+    stats.count = int(qMin<qint64>(count, std::numeric_limits<int>::max()));
+    stats.mean = total / count;
+    stats.standardDeviation = std::sqrt(qMax(0.0, totalSquares / count - stats.mean * stats.mean));
+    stats.p50 = stats.p95 = stats.p98 = std::numeric_limits<double>::quiet_NaN();
+    stats.slopePerHour = leastSquaresSlope(starts.constData(), means.constData(), means.size(),
+                                           sum(means.constData(), means.size()) / means.size());
+    return stats;
+}
+
+/**
+ * @brief Wyznacza percentyle P50, P95 i P98 z wartości pomiarów.
+ *
+ * Percentyle liczone są na jednej kopii wartości (selectPercentiles). Dla pustej serii
+ * percentyle mają wartość NaN.
+ *
+ * @param series Pomiary, z których liczone są percentyle.
+ */
+void SeriesStatistics::computePercentiles(const MeasurementSeries &series)
+{
+    const int count = series.size();
+    if (count == 0) {
+        p50 = p95 = p98 = std::numeric_limits<double>::quiet_NaN();
+        return;
+    }
+
+    QVector<double> scratch;
+    selectPercentiles(series.values().constData(), count, scratch, *this);
+}
+
+/**
+ * @brief Wyznacza percentyl metodą interpolacji liniowej między sąsiednimi pozycjami.
+ *
+ * Pozycja percentyla to fraction * (count - 1).
+ *
+ * @param values Wartości (kolejność zostanie zmieniona).
+ * @param count Liczba wartości.
+ * @param fraction Rząd percentyla z przedziału [0, 1].
+ * @return Wartość percentyla.
+ */
+double SeriesStatistics::percentile(double *values, int count, double fraction)
+{
+    if (count <= 0)
+        return 0;
+    return selectInterpolated(values, count, 0, qBound(0.0, fraction, 1.0) * (count - 1));
+}
+
+/**
+ * @brief Dodaje pomiar.
+ *
+ * Czas liczony jest w godzinach od pierwszego dodanego pomiaru, co zachowuje dokładność
+ * dla dużych znaczników czasu.
+ *
+ * @param timestamp Znacznik czasu w milisekundach od epoki.
+ * @param value Wartość pomiaru.
+ */
+void RunningStatistics::add(qint64 timestamp, double value)
+{
+    if (count == 0)
+        origin = timestamp;
+    if (count == 0 || value < min || (value == min && timestamp < minTime)) {
+        min = value;
+        minTime = timestamp;
+    }
+    if (count == 0 || value > max || (value == max && timestamp < maxTime)) {
+        max = value;
+        maxTime = timestamp;
+    }
+
+    ++count;
+    const double hours = double(timestamp - origin) / (3600.0 * 1000.0);
+    const double deltaValue = value - meanValue;
+    const double deltaHours = hours - meanHours;
+    meanValue += deltaValue / count;
+    meanHours += deltaHours / count;
+    squaredValue += deltaValue * (value - meanValue);
+    squaredHours += deltaHours * (hours - meanHours);
+    coMoment += deltaHours * (value - meanValue);
+}
+
+/**
+ * @brief Dodaje wszystkie pomiary serii.
+ * @param series Seria pomiarów.
+ */
+void RunningStatistics::add(const MeasurementSeries &series)
+{
+    const qint64 *timestamps = series.timestamps().constData();
+    const double *values = series.values().constData();
+    for (int i = 0; i < series.size(); ++i)
+        add(timestamps[i], values[i]);
+}
+
+/**
+ * @brief Zwraca bieżące statystyki.
+ * @return Statystyki dodanych pomiarów.
+ */
+SeriesStatistics RunningStatistics::statistics() const
+{
+    SeriesStatistics stats;
+    if (count == 0)
+        return stats;
+    stats.count = count;
+    stats.min = min;
+    stats.max = max;
+    stats.mean = meanValue;
+    stats.standardDeviation = std::sqrt(qMax(0.0, squaredValue / count));
+    stats.slopePerHour = squaredHours > 0 ? coMoment / squaredHours : 0;
+    stats.p50 = stats.p95 = stats.p98 = std::numeric_limits<double>::quiet_NaN();
+    return stats;
+}
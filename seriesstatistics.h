@@ -0,0 +1,166 @@
+/**
+ * @file seriesstatistics.h
+ * @brief Definicja struktury SeriesStatistics - statystyk opisowych serii pomiarów.
+ */
+
+#ifndef SERIESSTATISTICS_H
+#define SERIESSTATISTICS_H
+
+#include <QVector>
+#include "measurementseries.h"
+#include "rollupstore.h"
+
+/**
+ * @struct SeriesStatistics
+ * @brief Statystyki opisowe serii pomiarów.
+ *
+ * Obliczenia wykonywane są bezpośrednio na ciągłych kolumnach serii: skrajne wartości,
+ * średnia, odchylenie i trend wyznaczane są w jednym przebiegu z kilkoma niezależnymi
+ * akumulatorami, dzięki czemu kompilator może go wektoryzować. Percentyle wyznaczane są
+ * przez selekcję (std::nth_element), bez pełnego sortowania, a trend - metodą
+ * najmniejszych kwadratów względem czasu pomiaru.
+ */
+struct SeriesStatistics
+{
+    /** @brief Liczba pomiarów. */
+    int count = 0;
+
+    /** @brief Najmniejsza wartość. */
+    double min = 0;
+
+    /** @brief Indeks pierwszego pomiaru o najmniejszej wartości. */
+    int minIndex = -1;
+
+    /** @brief Największa wartość. */
+    double max = 0;
+
+    /** @brief Indeks pierwszego pomiaru o największej wartości. */
+    int maxIndex = -1;
+
+    /** @brief Średnia arytmetyczna. */
+    double mean = 0;
+
+    /** @brief Odchylenie standardowe (populacji). */
+    double standardDeviation = 0;
+
+    /** @brief Mediana. */
+    double p50 = 0;
+
+    /** @brief 95. percentyl. */
+    double p95 = 0;
+
+    /** @brief 98. percentyl. */
+    double p98 = 0;
+
+    /** @brief Nachylenie prostej regresji w jednostkach wartości na godzinę. */
+    double slopePerHour = 0;
+
+    /** @brief Sprawdza, czy statystyki zostały obliczone dla niepustej serii. */
+    bool isValid() const { return count > 0; }
+
+    /**
+     * @brief Oblicza statystyki serii.
+     * @param series Seria pomiarów (dla trendu posortowana według czasu).
+     * @return Statystyki serii; dla pustej serii isValid() zwraca false.
+     */
+    static SeriesStatistics compute(const MeasurementSeries &series);
+
+    /**
+     * @brief Oblicza statystyki kilku serii w jednym wywołaniu.
+     *
+     * Każda seria przeglądana jest jednym przebiegiem, a selekcje percentyli dzielą
+     * jeden bufor roboczy.
+     *
+     * @param series Serie pomiarów.
+     * @return Statystyki w kolejności serii wejściowych.
+     */
+    static QVector<SeriesStatistics> compute(const QVector<MeasurementSeries> &series);
+
+    /**
+     * @brief Oblicza statystyki na podstawie agregatów (dobowych lub miesięcznych).
+     *
+     * Liczba pomiarów, minimum, maksimum, średnia i odchylenie standardowe są dokładne
+     * dla pomiarów z uwzględnionych przedziałów. Indeksy minimum i maksimum wskazują agregat,
+     * a trend liczony jest ze średnich agregatów. Percentyli nie da się wyznaczyć z agregatów,
+     * więc mają wartość NaN; można je uzupełnić z pomiarów (computePercentiles).
+     *
+     * @param buckets Agregaty posortowane według czasu.
+     * @return Statystyki; indeksy odnoszą się do pozycji w buckets.
+     */
+    static SeriesStatistics fromRollups(const QVector<RollupBucket> &buckets);
+
+    /**
+     * @brief Wyznacza percentyle P50, P95 i P98 z wartości pomiarów.
+     * @param series Pomiary, z których liczone są percentyle.
+     */
+    void computePercentiles(const MeasurementSeries &series);
+
+    /**
+     * @brief Wyznacza percentyl metodą interpolacji liniowej między sąsiednimi pozycjami.
+     *
+     * Tablica jest częściowo przestawiana przez std::nth_element.
+     *
+     * @param values Wartości (kolejność zostanie zmieniona).
+     * @param count Liczba wartości.
+     * @param fraction Rząd percentyla z przedziału [0, 1].
+     * @return Wartość percentyla.
+     */
+    static double percentile(double *values, int count, double fraction);
+};
+
+/**
+ * @class RunningStatistics
+ * @brief Statystyki serii aktualizowane przyrostowo przy dopisywaniu kolejnych pomiarów.
+ *
+ * Średnia, wariancja i nachylenie trendu aktualizowane są metodą Welforda (wraz ze
+ * współmomentem czasu i wartości), więc dodanie pomiaru kosztuje stałą liczbę działań,
+ * niezależnie od liczby wcześniejszych, a kolejność pomiarów nie ma znaczenia.
+ * Percentyli nie da się wyznaczać przyrostowo, więc mają wartość NaN.
+ */
+class RunningStatistics
+{
+public:
+    /**
+     * @brief Dodaje pomiar.
+     * @param timestamp Znacznik czasu w milisekundach od epoki.
+     * @param value Wartość pomiaru.
+     */
+    void add(qint64 timestamp, double value);
+
+    /**
+     * @brief Dodaje wszystkie pomiary serii.
+     * @param series Seria pomiarów.
+     */
+    void add(const MeasurementSeries &series);
+
+    /**
+     * @brief Zwraca bieżące statystyki.
+     *
+     * Indeksy minimum i maksimum nie są wyznaczane (wartość -1); ich czas zwracają
+     * minTimestamp() i maxTimestamp().
+     *
+     * @return Statystyki dodanych pomiarów.
+     */
+    SeriesStatistics statistics() const;
+
+    /** @brief Zwraca czas najwcześniejszego pomiaru o najmniejszej wartości. */
+    qint64 minTimestamp() const { return minTime; }
+
+    /** @brief Zwraca czas najwcześniejszego pomiaru o największej wartości. */
+    qint64 maxTimestamp() const { return maxTime; }
+
+private:
+    int count = 0;
+    qint64 origin = 0;
+    double meanValue = 0;
+    double meanHours = 0;
+    double squaredValue = 0;
+    double squaredHours = 0;
+    double coMoment = 0;
+    double min = 0;
+    double max = 0;
+    qint64 minTime = 0;
+    qint64 maxTime = 0;
+};
+
+#endif // SERIESSTATISTICS_H
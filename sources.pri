@@ -0,0 +1,77 @@
+# Źródła wspólne dla aplikacji i pomiarów wydajności (benchmarks).
+
+QT       += core gui network charts concurrent
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+CONFIG += c++17
+
+# You can make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/analyticsrunner.cpp \
+    $$PWD/archiveanalytics.cpp \
+    $$PWD/batchrunner.cpp \
+    $$PWD/cachingnetworkmanager.cpp \
+    $$PWD/cancellationtoken.cpp \
+    $$PWD/chartwindow.cpp \
+    $$PWD/commandline.cpp \
+    $$PWD/comparisonquery.cpp \
+    $$PWD/coveragemap.cpp \
+    $$PWD/dataworker.cpp \
+    $$PWD/decimation.cpp \
+    $$PWD/fetchservice.cpp \
+    $$PWD/giosstreamparser.cpp \
+    $$PWD/gorillacodec.cpp \
+    $$PWD/httpcache.cpp \
+    $$PWD/jsonstorage.cpp \
+    $$PWD/mainwindow.cpp \
+    $$PWD/measurementseries.cpp \
+    $$PWD/measurementstore.cpp \
+    $$PWD/measurementwriter.cpp \
+    $$PWD/minmaxpyramid.cpp \
+    $$PWD/networktransport.cpp \
+    $$PWD/plotwidget.cpp \
+    $$PWD/rollupstore.cpp \
+    $$PWD/seriesjoin.cpp \
+    $$PWD/seriesstatistics.cpp \
+    $$PWD/syncscheduler.cpp \
+    $$PWD/tokenbucket.cpp \
+    $$PWD/tracing.cpp \
+    $$PWD/transportreply.cpp
+
+HEADERS += \
+    $$PWD/analyticsrunner.h \
+    $$PWD/archiveanalytics.h \
+    $$PWD/batchrunner.h \
+    $$PWD/cachingnetworkmanager.h \
+    $$PWD/cancellationtoken.h \
+    $$PWD/chartwindow.h \
+    $$PWD/commandline.h \
+    $$PWD/comparisonquery.h \
+    $$PWD/coveragemap.h \
+    $$PWD/dataworker.h \
+    $$PWD/decimation.h \
+    $$PWD/fetchservice.h \
+    $$PWD/giosstreamparser.h \
+    $$PWD/gorillacodec.h \
+    $$PWD/httpcache.h \
+    $$PWD/jsonstorage.h \
+    $$PWD/mainwindow.h \
+    $$PWD/measurementseries.h \
+    $$PWD/measurementstore.h \
+    $$PWD/measurementwriter.h \
+    $$PWD/minmaxpyramid.h \
+    $$PWD/networktransport.h \
+    $$PWD/plotwidget.h \
+    $$PWD/rollupstore.h \
+    $$PWD/seriesjoin.h \
+    $$PWD/seriesstatistics.h \
+    $$PWD/syncscheduler.h \
+    $$PWD/tokenbucket.h \
+    $$PWD/tracing.h \
+    $$PWD/transportreply.h
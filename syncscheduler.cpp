@@ -0,0 +1,235 @@
+/**
+ * @file syncscheduler.cpp
+ * @brief Implementacja synchronizacji lokalnej bazy w tle.
+ */
+#include "syncscheduler.h"
+#include "fetchservice.h"
+#include "measurementwriter.h"
+#include "dataworker.h"
+#include "jsonstorage.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+
+/** @brief Domyślna średnia liczba zapytań na sekundę. */
+const double DefaultRequestsPerSecond = 0.5;
+
+/** @brief Domyślna liczba zapytań wysłanych naraz. */
+const int DefaultBurst = 5;
+
+/** @brief Czas ponowienia, gdy kolejka puli wątków jest pełna. */
+const int RetryDelayMsecs = 5000;
+
+/** @brief Zwraca ścieżkę pliku punktu kontrolnego. */
+QString checkpointPath()
+{
+    return getJsonFilePath("synchronizacja.json");
+}
+
+}
+
+/**
+ * @brief Konstruktor klasy SyncScheduler.
+ * @param fetchService Pula wątków wykonująca zadania pobierania.
+ * @param writer Wątek zapisu pobranych pomiarów.
+ * @param parent Obiekt nadrzędny.
+ */
+SyncScheduler::SyncScheduler(FetchService *fetchService, MeasurementWriter *writer, QObject *parent)
+    : QObject(parent), fetchService(fetchService), writer(writer), bucket(DefaultRequestsPerSecond, DefaultBurst)
+{
+    timer.setSingleShot(true);
+}
+
+/**
+ * @brief Ustawia liczbę ostatnich dni synchronizowanych dla każdego sensora.
+ * @param days Liczba dni.
+ */
+void SyncScheduler::setSyncDays(int days)
+{
+    syncDays = qMax(1, days);
+}
+
+/**
+ * @brief Ustawia ograniczenie liczby zapytań do API.
+ * @param requestsPerSecond Średnia liczba zapytań na sekundę.
+ * @param burst Maksymalna liczba zapytań wysłanych naraz.
+ */
+void SyncScheduler::setRateLimit(double requestsPerSecond, int burst)
+{
+    bucket.setRate(requestsPerSecond, burst);
+}
+
+/**
+ * @brief Uruchamia synchronizację.
+ */
+void SyncScheduler::start()
+{
+    if (running)
+        return;
+    running = true;
+    timer.disconnect(this);
+    connect(&timer, &QTimer::timeout, this, &SyncScheduler::beginPass);
+    timer.start(StartDelaySecs * 1000);
+}
+
+/**
+ * @brief Zatrzymuje synchronizację.
+ */
+void SyncScheduler::stop()
+{
+    running = false;
+    timer.stop();
+}
+
+/**
+ * @brief Rozpoczyna przejście po wszystkich sensorach z lokalnego katalogu.
+ *
+ * Jeśli istnieje punkt kontrolny poprzedniego, przerwanego przejścia, przejście
+ * zaczyna się od sensora następującego po zapisanym.
+ */
+void SyncScheduler::beginPass()
+{
+    if (!running)
+        return;
+
+    targets.clear();
+    const QJsonArray stations = loadStationList();
+    for (const QJsonValue &station : stations) {
+        const int stationId = station.toObject()["id"].toInt();
+        const QJsonArray sensors = loadSensors(stationId);
+        for (const QJsonValue &sensor : sensors)
+            targets.append({ stationId, sensor.toObject()["id"].toInt() });
+    }
+    position = resumePosition();
+
+    timer.disconnect(this);
+    connect(&timer, &QTimer::timeout, this, &SyncScheduler::next);
+    next();
+}
+
+/**
+ * @brief Przekazuje do pobrania kolejny sensor wymagający uzupełnienia.
+ *
+ * Sensory z aktualnymi danymi są pomijane bez zapytań. Jeśli brakuje żetonów
+ * lub kolejka puli wątków jest pełna, próba jest ponawiana po odpowiednim czasie.
+ */
+void SyncScheduler::next()
+{
+    if (!running || jobActive)
+        return;
+
+    const QDateTime to = QDateTime::currentDateTime();
+    const QDateTime from = to.addDays(-syncDays);
+    while (position < targets.size()) {
+        const Target target = targets[position];
+        const QVector<QPair<QDateTime, QDateTime>> ranges = missingRanges(target.stationId, target.sensorId, from, to);
+        if (ranges.isEmpty()) {
+            saveCheckpoint(target);
+            ++position;
+            continue;
+        }
+
+        int pages = 0;
+        for (const QPair<QDateTime, QDateTime> &range : ranges)
+            pages += int(range.first.secsTo(range.second) / 3600) / DataWorker::DefaultPageHours + 1;
+        const int wait = bucket.msecsUntilAvailable(pages);
+        if (wait > 0) {
+            timer.start(wait);
+            return;
+        }
+
+        DataWorker *worker = new DataWorker(target.sensorId, ranges);
+        connect(worker, &DataWorker::dataReady, this, [this, target, ranges](MeasurementSeries series, bool complete) {
+            onJobFinished(target, ranges, series, complete);
+        });
+        if (!fetchService->submit(worker, FetchService::Background)) {
+            delete worker;
+            timer.start(RetryDelayMsecs);
+            return;
+        }
+        bucket.tryAcquire(pages);
+        jobActive = true;
+        return;
+    }
+    finishPass();
+}
+
+/**
+ * @brief Zleca zapis danych pobranego sensora, zapisuje punkt kontrolny i przechodzi do następnego.
+ *
+ * Sensor, którego nie udało się pobrać, jest pomijany; jego brakujące dane zostaną
+ * pobrane w kolejnym przejściu, bo nie są oznaczone w mapie pokrycia.
+ *
+ * @param target Sensor.
+ * @param ranges Pobrane przedziały.
+ * @param series Pobrane pomiary.
+ * @param complete true, jeśli pobrano wszystkie przedziały.
+ */
+void SyncScheduler::onJobFinished(const Target &target, const QVector<QPair<QDateTime, QDateTime>> &ranges,
+                                  const MeasurementSeries &series, bool complete)
+{
+    jobActive = false;
+    if (complete)
+        writer->enqueue(target.stationId, target.sensorId, ranges, series);
+    saveCheckpoint(target);
+    ++position;
+    next();
+}
+
+/**
+ * @brief Kończy przejście i planuje następne.
+ */
+void SyncScheduler::finishPass()
+{
+    clearCheckpoint();
+    targets.clear();
+    position = 0;
+
+    timer.disconnect(this);
+    connect(&timer, &QTimer::timeout, this, &SyncScheduler::beginPass);
+    timer.start(DefaultPassIntervalMinutes * 60 * 1000);
+}
+
+/**
+ * @brief Zapisuje ostatni zakończony sensor przejścia.
+ * @param target Sensor.
+ */
+void SyncScheduler::saveCheckpoint(const Target &target)
+{
+    QJsonObject checkpoint;
+    checkpoint.insert("stationId", target.stationId);
+    checkpoint.insert("sensorId", target.sensorId);
+    QFile file(checkpointPath());
+    if (file.open(QIODevice::WriteOnly))
+        file.write(QJsonDocument(checkpoint).toJson(QJsonDocument::Compact));
+}
+
+/**
+ * @brief Usuwa punkt kontrolny po zakończonym przejściu.
+ */
+void SyncScheduler::clearCheckpoint()
+{
+    QFile::remove(checkpointPath());
+}
+
+/**
+ * @brief Wyznacza pozycję, od której należy wznowić przejście.
+ * @return Indeks sensora po zapisanym w punkcie kontrolnym lub 0.
+ */
+int SyncScheduler::resumePosition() const
+{
+    const QJsonObject checkpoint = loadJsonDoc(checkpointPath()).object();
+    if (checkpoint.isEmpty())
+        return 0;
+
+    const int stationId = checkpoint["stationId"].toInt();
+    const int sensorId = checkpoint["sensorId"].toInt();
+    for (int i = 0; i < targets.size(); ++i) {
+        if (targets[i].stationId == stationId && targets[i].sensorId == sensorId)
+            return i + 1;
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file syncscheduler.h
+ * @brief Definicja klasy SyncScheduler - synchronizacji lokalnej bazy w tle.
+ */
+
+#ifndef SYNCSCHEDULER_H
+#define SYNCSCHEDULER_H
+
+#include <QObject>
+#include <QVector>
+#include <QPair>
+#include <QDateTime>
+#include <QTimer>
+#include "measurementseries.h"
+#include "tokenbucket.h"
+
+class FetchService;
+class MeasurementWriter;
+
+/**
+ * @class SyncScheduler
+ * @brief Cyklicznie uzupełnia lokalną bazę o najnowsze dane wszystkich znanych sensorów.
+ *
+ * Jedno przejście obejmuje wszystkie stacje z lokalnego katalogu (loadStationList) i ich
+ * sensory (loadSensors). Dla każdego sensora pobierane są brakujące fragmenty ostatnich
+ * dni jako zadania w tle puli FetchService, po jednym naraz. Liczba zapytań ograniczana jest
+ * przez TokenBucket. Po każdym sensorze zapisywany jest punkt kontrolny, więc przerwane
+ * przejście (np. zamknięcie programu) jest wznawiane od miejsca przerwania.
+ */
+class SyncScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** @brief Domyślna liczba ostatnich dni synchronizowanych dla każdego sensora. */
+    static const int DefaultSyncDays = 3;
+
+    /** @brief Domyślny odstęp między kolejnymi przejściami w minutach. */
+    static const int DefaultPassIntervalMinutes = 60;
+
+    /** @brief Opóźnienie pierwszego przejścia po uruchomieniu w sekundach. */
+    static const int StartDelaySecs = 30;
+
+    /**
+     * @brief Konstruktor klasy SyncScheduler.
+     * @param fetchService Pula wątków wykonująca zadania pobierania.
+     * @param writer Wątek zapisu pobranych pomiarów.
+     * @param parent Obiekt nadrzędny.
+     */
+    SyncScheduler(FetchService *fetchService, MeasurementWriter *writer, QObject *parent = nullptr);
+
+    /**
+     * @brief Ustawia liczbę ostatnich dni synchronizowanych dla każdego sensora.
+     * @param days Liczba dni.
+     */
+    void setSyncDays(int days);
+
+    /**
+     * @brief Ustawia ograniczenie liczby zapytań do API.
+     * @param requestsPerSecond Średnia liczba zapytań na sekundę.
+     * @param burst Maksymalna liczba zapytań wysłanych naraz po okresie bezczynności.
+     */
+    void setRateLimit(double requestsPerSecond, int burst);
+
+    /**
+     * @brief Uruchamia synchronizację (pierwsze przejście po StartDelaySecs).
+     */
+    void start();
+
+    /**
+     * @brief Zatrzymuje synchronizację. Trwające zadanie zostaje dokończone.
+     */
+    void stop();
+
+private:
+    /**
+     * @struct Target
+     * @brief Sensor synchronizowany w przejściu.
+     */
+    struct Target {
+        int stationId;
+        int sensorId;
+    };
+
+    void beginPass();
+    void next();
+    void onJobFinished(const Target &target, const QVector<QPair<QDateTime, QDateTime>> &ranges,
+                       const MeasurementSeries &series, bool complete);
+    void finishPass();
+    void saveCheckpoint(const Target &target);
+    void clearCheckpoint();
+    int resumePosition() const;
+
+    FetchService *fetchService;
+    MeasurementWriter *writer;
+    TokenBucket bucket;
+    QTimer timer;
+    QVector<Target> targets;
+    int position = 0;
+    int syncDays = DefaultSyncDays;
+    bool running = false;
+    bool jobActive = false;
+};
+
+#endif // SYNCSCHEDULER_H
@@ -0,0 +1,12 @@
+# Testy jednostkowe (QtTest); nie są częścią aplikacji.
+
+QT += testlib
+
+CONFIG += testcase
+
+TARGET = tests
+
+include(../sources.pri)
+
+SOURCES += \
+    tst_giosstreamparser.cpp
@@ -0,0 +1,144 @@
+/**
+ * @file tst_giosstreamparser.cpp
+ * @brief Testy strumieniowego parsera odpowiedzi GiosStreamParser.
+ *
+ * Sprawdzają, że odpowiedź podzielona na fragmenty w dowolnych miejscach (jak przy
+ * kolejnych sygnałach readyRead) daje ten sam wynik co odpowiedź przekazana w całości.
+ */
+#include "giosstreamparser.h"
+#include <QtTest>
+
+/**
+ * @class GiosStreamParserTest
+ * @brief Testy podziału odpowiedzi na fragmenty.
+ */
+class GiosStreamParserTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void splitAtEveryOffset_data();
+    void splitAtEveryOffset();
+    void splitAtEveryPair_data() { splitAtEveryOffset_data(); }
+    void splitAtEveryPair();
+    void byteByByte_data() { splitAtEveryOffset_data(); }
+    void byteByByte();
+
+private:
+    static bool parse(const QVector<QByteArray> &chunks, MeasurementSeries &series);
+    static void compare(const MeasurementSeries &actual, const MeasurementSeries &expected);
+};
+
+/**
+ * @brief Przekazuje parserowi kolejne fragmenty i zwraca odczytaną serię.
+ * @return Wynik GiosStreamParser::finish().
+ */
+bool GiosStreamParserTest::parse(const QVector<QByteArray> &chunks, MeasurementSeries &series)
+{
+    GiosStreamParser parser;
+    for (const QByteArray &chunk : chunks)
+        parser.feed(chunk);
+    const bool ok = parser.finish();
+    series = parser.takeSeries();
+    return ok;
+}
+
+/**
+ * @brief Porównuje serię z wynikiem parsowania całej odpowiedzi.
+ */
+void GiosStreamParserTest::compare(const MeasurementSeries &actual, const MeasurementSeries &expected)
+{
+    QCOMPARE(actual.timestamps(), expected.timestamps());
+    QCOMPARE(actual.values(), expected.values());
+}
+
+/**
+ * @brief Odpowiedzi testowe.
+ *
+ * Obejmują klucz "Wartość" zapisany wprost i jako sekwencje \\u, wartość null,
+ * liczby z wykładnikiem oraz pola pomijane przez parser.
+ */
+void GiosStreamParserTest::splitAtEveryOffset_data()
+{
+    QTest::addColumn<QByteArray>("response");
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("plain") << QByteArray(
+        "{\"Lista archiwalnych wyników pomiarów\":["
+        "{\"Kod stanowiska\":\"DsWrocWybCon-PM10-1g\",\"Data\":\"2024-01-02 03:00:00\",\"Wartość\":12.5},"
+        "{\"Kod stanowiska\":\"DsWrocWybCon-PM10-1g\",\"Data\":\"2024-01-02 02:00:00\",\"Wartość\":7}"
+        "],\"totalElements\":2,\"totalPages\":1}") << 2;
+    QTest::newRow("escaped-key") << QByteArray(
+        "{\"Lista archiwalnych wynik\\u00f3w pomiar\\u00f3w\":["
+        "{\"Data\":\"2024-01-02 03:00:00\",\"Warto\\u015b\\u0107\":12.5},"
+        "{\"Data\":\"2024-01-02 02:00:00\",\"Warto\\u015b\\u0107\":-3.25e1}"
+        "],\"totalElements\":2}") << 2;
+    QTest::newRow("null-value") << QByteArray(
+        "{\"Lista archiwalnych wyników pomiarów\":["
+        "{\"Data\":\"2024-01-02 03:00:00\",\"Wartość\":null},"
+        "{\"Data\":\"2024-01-02 02:00:00\",\"Warto\\u015b\\u0107\":null},"
+        "{\"Data\":\"2024-01-02 01:00:00\",\"Wartość\":1.0E+1}"
+        "],\"totalElements\":3}") << 3;
+}
+
+/**
+ * @brief Odpowiedź podzielona na dwa fragmenty w każdym możliwym miejscu.
+ */
+void GiosStreamParserTest::splitAtEveryOffset()
+{
+    QFETCH(QByteArray, response);
+    QFETCH(int, count);
+
+    MeasurementSeries expected;
+    QVERIFY(parse({ response }, expected));
+    QCOMPARE(expected.size(), count);
+
+    for (int offset = 0; offset <= response.size(); ++offset) {
+        MeasurementSeries series;
+        QVERIFY2(parse({ response.left(offset), response.mid(offset) }, series),
+                 qPrintable(QString("podział w miejscu %1").arg(offset)));
+        compare(series, expected);
+    }
+}
+
+/**
+ * @brief Odpowiedź podzielona na trzy fragmenty w każdej parze miejsc.
+ */
+void GiosStreamParserTest::splitAtEveryPair()
+{
+    QFETCH(QByteArray, response);
+
+    MeasurementSeries expected;
+    QVERIFY(parse({ response }, expected));
+
+    for (int first = 0; first <= response.size(); ++first) {
+        for (int second = first; second <= response.size(); ++second) {
+            MeasurementSeries series;
+            QVERIFY2(parse({ response.left(first), response.mid(first, second - first), response.mid(second) }, series),
+                     qPrintable(QString("podział w miejscach %1 i %2").arg(first).arg(second)));
+            compare(series, expected);
+        }
+    }
+}
+
+/**
+ * @brief Odpowiedź przekazywana po jednym bajcie.
+ */
+void GiosStreamParserTest::byteByByte()
+{
+    QFETCH(QByteArray, response);
+
+    MeasurementSeries expected;
+    QVERIFY(parse({ response }, expected));
+
+    QVector<QByteArray> chunks;
+    for (int i = 0; i < response.size(); ++i)
+        chunks.append(response.mid(i, 1));
+    MeasurementSeries series;
+    QVERIFY(parse(chunks, series));
+    compare(series, expected);
+}
+
+QTEST_APPLESS_MAIN(GiosStreamParserTest)
+
+#include "tst_giosstreamparser.moc"
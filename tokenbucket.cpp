@@ -0,0 +1,76 @@
+/**
+ * @file tokenbucket.cpp
+ * @brief Implementacja ogranicznika częstości zapytań.
+ */
+#include "tokenbucket.h"
+#include <QtGlobal>
+#include <cmath>
+/**
+ * @brief Konstruktor klasy TokenBucket.
+ * @param ratePerSecond Liczba żetonów przybywających na sekundę.
+ * @param capacity Pojemność wiadra.
+ */
+TokenBucket::TokenBucket(double ratePerSecond, double capacity)
+    : rate(qMax(1e-6, ratePerSecond)), capacity(qMax(1.0, capacity)), tokens(this->capacity)
+{
+    clock.start();
+}
+
+/**
+ * @brief Zmienia szybkość uzupełniania i pojemność wiadra.
+ * @param ratePerSecond Liczba żetonów przybywających na sekundę.
+ * @param capacity Pojemność wiadra.
+ */
+void TokenBucket::setRate(double ratePerSecond, double capacity)
+{
+    refill();
+    rate = qMax(1e-6, ratePerSecond);
+    this->capacity = qMax(1.0, capacity);
+    tokens = qMin(tokens, this->capacity);
+}
+
+/**
+ * @brief Pobiera żetony, jeśli są dostępne.
+ *
+ * Zlecenie większe niż pojemność wymaga pełnego wiadra, a pobiera wszystkie żetony;
+ * brakująca część staje się długiem (ujemną liczbą żetonów) spłacanym przez uzupełnianie.
+ *
+ * @param count Liczba żetonów.
+ * @return true, jeśli żetony zostały pobrane.
+ */
+bool TokenBucket::tryAcquire(double count)
+{
+    refill();
+    if (tokens < qMin(count, capacity))
+        return false;
+    tokens -= count;
+    return true;
+}
+
+/**
+ * @brief Zwraca czas oczekiwania na podaną liczbę żetonów.
+ *
+ * Uwzględnia spłatę długu po wcześniejszych dużych zleceniach; na zlecenie większe
+ * niż pojemność czeka się do zapełnienia wiadra.
+ *
+ * @param count Liczba żetonów.
+ * @return Czas w milisekundach.
+ */
+int TokenBucket::msecsUntilAvailable(double count)
+{
+    refill();
+    const double needed = qMin(count, capacity);
+    if (tokens >= needed)
+        return 0;
+    return int(std::ceil((needed - tokens) / rate * 1000.0));
+}
+
+/**
+ * @brief Dodaje żetony, które przybyły od ostatniego wywołania.
+ */
+void TokenBucket::refill()
+{
+    const qint64 now = clock.nsecsElapsed();
+    tokens = qMin(capacity, tokens + (now - lastRefillNsecs) * rate / 1e9);
+    lastRefillNsecs = now;
+}
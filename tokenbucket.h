@@ -0,0 +1,65 @@
+/**
+ * @file tokenbucket.h
+ * @brief Definicja klasy TokenBucket - ogranicznika częstości zapytań.
+ */
+
+#ifndef TOKENBUCKET_H
+#define TOKENBUCKET_H
+
+#include <QElapsedTimer>
+
+/**
+ * @class TokenBucket
+ * @brief Ogranicznik częstości w modelu "wiadra z żetonami".
+ *
+ * Żetony przybywają ze stałą szybkością aż do pojemności wiadra. Każde zapytanie zużywa
+ * żetony, więc średnia częstość zapytań nie przekracza szybkości uzupełniania, a pojemność
+ * określa dopuszczalną serię zapytań po okresie bezczynności.
+ *
+ * Zlecenie większe niż pojemność (np. zadanie z wieloma stronami) nie może czekać na
+ * tyle żetonów, więc rusza przy pełnym wiadrze i pobiera wszystkie żetony, zadłużając
+ * wiadro. Kolejne zlecenia czekają na spłatę długu, więc średnia częstość nadal
+ * nie przekracza szybkości uzupełniania.
+ */
+class TokenBucket
+{
+public:
+    /**
+     * @brief Konstruktor klasy TokenBucket. Wiadro jest początkowo pełne.
+     * @param ratePerSecond Liczba żetonów przybywających na sekundę.
+     * @param capacity Pojemność wiadra.
+     */
+    TokenBucket(double ratePerSecond, double capacity);
+
+    /**
+     * @brief Zmienia szybkość uzupełniania i pojemność wiadra.
+     * @param ratePerSecond Liczba żetonów przybywających na sekundę.
+     * @param capacity Pojemność wiadra.
+     */
+    void setRate(double ratePerSecond, double capacity);
+
+    /**
+     * @brief Pobiera żetony, jeśli są dostępne.
+     * @param count Liczba żetonów (większa niż pojemność zadłuża wiadro).
+     * @return true, jeśli żetony zostały pobrane.
+     */
+    bool tryAcquire(double count = 1);
+
+    /**
+     * @brief Zwraca czas oczekiwania na podaną liczbę żetonów.
+     * @param count Liczba żetonów.
+     * @return Czas w milisekundach (0, jeśli żetony są dostępne).
+     */
+    int msecsUntilAvailable(double count = 1);
+
+private:
+    void refill();
+
+    double rate;
+    double capacity;
+    double tokens;
+    QElapsedTimer clock;
+    qint64 lastRefillNsecs = 0;
+};
+
+#endif // TOKENBUCKET_H
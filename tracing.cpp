@@ -0,0 +1,270 @@
+/**
+ * @file tracing.cpp
+ * @brief Implementacja pomiaru czasu etapów przetwarzania.
+ */
+#include "tracing.h"
+#include <QCoreApplication>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QVector>
+#include <QDebug>
+#include <limits>
+#include <memory>
+#include <vector>
+
+std::atomic<bool> Tracer::enabled { false };
+
+namespace {
+
+/** @brief Maksymalna liczba odcinków zapamiętywanych przez jeden wątek (histogramy liczone są dalej). */
+const int MaxEventsPerThread = 1 << 20;
+
+/** @brief Liczba przedziałów histogramu; przedział b obejmuje czasy [2^b, 2^(b+1)) mikrosekund. */
+const int HistogramBuckets = 32;
+
+/**
+ * @struct Event
+ * @brief Zapisany odcinek.
+ */
+struct Event {
+    const char *name;
+    qint64 start;
+    qint64 duration;
+};
+
+/**
+ * @struct Histogram
+ * @brief Histogram czasów trwania jednego etapu w przedziałach logarytmicznych.
+ */
+struct Histogram {
+    qint64 count = 0;
+    qint64 sum = 0;
+    qint64 max = 0;
+    qint64 buckets[HistogramBuckets] = {};
+
+    void add(qint64 nsecs)
+    {
+        ++count;
+        sum += nsecs;
+        max = qMax(max, nsecs);
+        qint64 micros = nsecs / 1000;
+        int bucket = 0;
+        while (micros > 1 && bucket < HistogramBuckets - 1) {
+            micros >>= 1;
+            ++bucket;
+        }
+        ++buckets[bucket];
+    }
+
+    void merge(const Histogram &other)
+    {
+        count += other.count;
+        sum += other.sum;
+        max = qMax(max, other.max);
+        for (int i = 0; i < HistogramBuckets; ++i)
+            buckets[i] += other.buckets[i];
+    }
+
+    /** @brief Zwraca górną granicę przedziału zawierającego podany percentyl (nie większą niż max). */
+    qint64 percentile(double fraction) const
+    {
+        const qint64 rank = qMax<qint64>(1, qint64(fraction * double(count) + 0.5));
+        qint64 seen = 0;
+        for (int i = 0; i < HistogramBuckets; ++i) {
+            seen += buckets[i];
+            if (seen >= rank)
+                return qMin(max, (qint64(2) << i) * 1000);
+        }
+        return max;
+    }
+};
+
+/**
+ * @struct ThreadBuffer
+ * @brief Odcinki i histogramy jednego wątku.
+ *
+ * Blokada chroni bufor tylko przed równoczesnym eksportem, więc w praktyce nie jest sporna.
+ */
+struct ThreadBuffer {
+    int threadId = 0;
+    QMutex mutex;
+    std::vector<Event> events;
+    QHash<const char *, Histogram> histograms;
+    qint64 droppedEvents = 0;
+};
+
+QMutex &registryMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+std::vector<std::shared_ptr<ThreadBuffer>> &registry()
+{
+    static std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    return buffers;
+}
+
+QString &tracePath()
+{
+    static QString path;
+    return path;
+}
+
+/**
+ * @brief Zwraca bufor bieżącego wątku, rejestrując go przy pierwszym użyciu.
+ *
+ * Rejestr przechowuje współdzielony wskaźnik, więc odcinki wątku, który już się
+ * zakończył, pozostają dostępne do eksportu.
+ */
+ThreadBuffer &localBuffer()
+{
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+        QMutexLocker locker(&registryMutex());
+        buffer->threadId = int(registry().size()) + 1;
+        registry().push_back(buffer);
+    }
+    return *buffer;
+}
+
+}
+
+/**
+ * @brief Włącza lub wyłącza śledzenie.
+ * @param on true, aby włączyć.
+ */
+void Tracer::setEnabled(bool on)
+{
+    enabled.store(on, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Włącza śledzenie, jeśli ustawiona jest zmienna JP_TRACE.
+ */
+void Tracer::configureFromEnvironment()
+{
+    const QString path = qEnvironmentVariable("JP_TRACE");
+    if (path.isEmpty())
+        return;
+
+    tracePath() = path;
+    setEnabled(true);
+    qAddPostRoutine(&Tracer::writeReports);
+}
+
+/**
+ * @brief Zapisuje zakończony odcinek w buforze bieżącego wątku.
+ * @param name Nazwa etapu.
+ * @param startNsecs Początek odcinka.
+ * @param endNsecs Koniec odcinka.
+ */
+void Tracer::record(const char *name, qint64 startNsecs, qint64 endNsecs)
+{
+    if (!isEnabled())
+        return;
+
+    ThreadBuffer &buffer = localBuffer();
+    const qint64 duration = qMax<qint64>(0, endNsecs - startNsecs);
+    QMutexLocker locker(&buffer.mutex);
+    if (int(buffer.events.size()) < MaxEventsPerThread)
+        buffer.events.push_back({ name, startNsecs, duration });
+    else
+        ++buffer.droppedEvents;
+    buffer.histograms[name].add(duration);
+}
+
+/**
+ * @brief Zapisuje zebrane odcinki w formacie Chrome Trace Event.
+ *
+ * Czasy liczone są od najwcześniejszego odcinka, w mikrosekundach.
+ *
+ * @param path Ścieżka pliku.
+ * @return true, jeśli zapis się powiódł.
+ */
+bool Tracer::writeChromeTrace(const QString &path)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QMutexLocker registryLocker(&registryMutex());
+    qint64 origin = std::numeric_limits<qint64>::max();
+    for (const std::shared_ptr<ThreadBuffer> &buffer : registry()) {
+        QMutexLocker locker(&buffer->mutex);
+        for (const Event &event : buffer->events)
+            origin = qMin(origin, event.start);
+    }
+
+    file.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (const std::shared_ptr<ThreadBuffer> &buffer : registry()) {
+        QMutexLocker locker(&buffer->mutex);
+        for (const Event &event : buffer->events) {
+            QByteArray line = first ? "" : ",\n";
+            line += "{\"name\":\"";
+            line += event.name;
+            line += "\",\"ph\":\"X\",\"pid\":1,\"tid\":" + QByteArray::number(buffer->threadId)
+                    + ",\"ts\":" + QByteArray::number(double(event.start - origin) / 1000.0, 'f', 3)
+                    + ",\"dur\":" + QByteArray::number(double(event.duration) / 1000.0, 'f', 3) + "}";
+            file.write(line);
+            first = false;
+        }
+    }
+    file.write("\n]}\n");
+    return file.commit();
+}
+
+/**
+ * @brief Wypisuje histogramy czasów trwania etapów.
+ *
+ * Dla każdego etapu: liczba odcinków, średnia, przybliżone percentyle 50/90/99
+ * (górne granice przedziałów histogramu) i maksimum, w milisekundach.
+ *
+ * @param out Strumień wyjściowy.
+ */
+void Tracer::printHistograms(QTextStream &out)
+{
+    QMap<QString, Histogram> merged;
+    qint64 dropped = 0;
+    {
+        QMutexLocker registryLocker(&registryMutex());
+        for (const std::shared_ptr<ThreadBuffer> &buffer : registry()) {
+            QMutexLocker locker(&buffer->mutex);
+            for (auto it = buffer->histograms.cbegin(); it != buffer->histograms.cend(); ++it)
+                merged[QString::fromLatin1(it.key())].merge(it.value());
+            dropped += buffer->droppedEvents;
+        }
+    }
+
+    const auto msecs = [](qint64 nsecs) { return QString::number(double(nsecs) / 1e6, 'f', 3); };
+    out << "etap\tliczba\tsrednia_ms\tp50_ms\tp90_ms\tp99_ms\tmax_ms\n";
+    for (auto it = merged.cbegin(); it != merged.cend(); ++it) {
+        const Histogram &histogram = it.value();
+        out << it.key() << '\t' << histogram.count << '\t' << msecs(histogram.sum / qMax<qint64>(1, histogram.count))
+            << '\t' << msecs(histogram.percentile(0.5)) << '\t' << msecs(histogram.percentile(0.9))
+            << '\t' << msecs(histogram.percentile(0.99)) << '\t' << msecs(histogram.max) << '\n';
+    }
+    if (dropped > 0)
+        out << "Pominięte odcinki (pełny bufor): " << dropped << '\n';
+    out.flush();
+}
+
+/**
+ * @brief Zapisuje plik śladu i wypisuje histogramy przy zamykaniu aplikacji.
+ */
+void Tracer::writeReports()
+{
+    setEnabled(false);
+    QTextStream err(stderr);
+    printHistograms(err);
+    if (writeChromeTrace(tracePath()))
+        err << "Zapisano ślad: " << tracePath() << '\n';
+    else
+        err << "Nie udało się zapisać śladu: " << tracePath() << '\n';
+    err.flush();
+}
@@ -0,0 +1,122 @@
+/**
+ * @file tracing.h
+ * @brief Definicja klas Tracer i TraceSpan - pomiaru czasu etapów przetwarzania.
+ */
+
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <QString>
+#include <QTextStream>
+#include <atomic>
+#include <chrono>
+
+/**
+ * @class Tracer
+ * @brief Zbiera odcinki czasu (spany) etapów przetwarzania i eksportuje je.
+ *
+ * Każdy wątek zapisuje odcinki do własnego bufora, więc wątki nie rywalizują o wspólną
+ * blokadę. Wyłączony Tracer kosztuje
+ * jedno odczytanie zmiennej atomowej na odcinek. Zebrane odcinki można zapisać w formacie
+ * Chrome Trace Event (do otwarcia w chrome://tracing lub Perfetto), a dla każdego etapu
+ * prowadzony jest histogram czasów trwania.
+ *
+ * Śledzenie włącza zmienna środowiskowa JP_TRACE ze ścieżką pliku śladu; plik i histogramy
+ * zapisywane są przy zamykaniu programu.
+ */
+class Tracer
+{
+public:
+    /** @brief Sprawdza, czy śledzenie jest włączone. */
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Włącza lub wyłącza śledzenie.
+     * @param on true, aby włączyć.
+     */
+    static void setEnabled(bool on);
+
+    /**
+     * @brief Włącza śledzenie, jeśli ustawiona jest zmienna JP_TRACE.
+     *
+     * Przy zamykaniu aplikacji ślad zapisywany jest do pliku wskazanego w JP_TRACE,
+     * a histogramy wypisywane na standardowe wyjście błędów.
+     */
+    static void configureFromEnvironment();
+
+    /** @brief Zwraca bieżący czas zegara śledzenia w nanosekundach. */
+    static qint64 now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Zapisuje zakończony odcinek.
+     *
+     * Służy do odcinków, które nie mieszczą się w jednym zakresie kodu (np. od wysłania
+     * zapytania do odpowiedzi).
+     *
+     * @param name Nazwa etapu (napis o statycznym czasie życia).
+     * @param startNsecs Początek odcinka (Tracer::now()).
+     * @param endNsecs Koniec odcinka (Tracer::now()).
+     */
+    static void record(const char *name, qint64 startNsecs, qint64 endNsecs);
+
+    /**
+     * @brief Zapisuje zebrane odcinki w formacie Chrome Trace Event.
+     * @param path Ścieżka pliku.
+     * @return true, jeśli zapis się powiódł.
+     */
+    static bool writeChromeTrace(const QString &path);
+
+    /**
+     * @brief Wypisuje histogramy czasów trwania etapów.
+     * @param out Strumień wyjściowy.
+     */
+    static void printHistograms(QTextStream &out);
+
+private:
+    static void writeReports();
+
+    static std::atomic<bool> enabled;
+};
+
+/**
+ * @class TraceSpan
+ * @brief Odcinek obejmujący czas życia obiektu (od konstrukcji do destrukcji).
+ */
+class TraceSpan
+{
+public:
+    /**
+     * @brief Rozpoczyna odcinek, jeśli śledzenie jest włączone.
+     * @param name Nazwa etapu (napis o statycznym czasie życia).
+     */
+    explicit TraceSpan(const char *name)
+        : name(name), start(Tracer::isEnabled() ? Tracer::now() : 0)
+    {
+    }
+
+    /** @brief Kończy odcinek. */
+    ~TraceSpan()
+    {
+        if (start != 0)
+            Tracer::record(name, start, Tracer::now());
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *name;
+    qint64 start;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+/** @brief Mierzy czas do końca bieżącego zakresu kodu jako etap o podanej nazwie. */
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name)
+
+#endif // TRACING_H
@@ -0,0 +1,111 @@
+/**
+ * @file transportreply.cpp
+ * @brief Implementacja odpowiedzi sieciowej z danymi podawanymi przez NetworkTransport.
+ */
+#include "transportreply.h"
+#include <cstring>
+/**
+ * @brief Konstruktor klasy TransportReply.
+ * @param operation Rodzaj operacji HTTP.
+ * @param request Zapytanie.
+ * @param parent Obiekt nadrzędny.
+ */
+TransportReply::TransportReply(QNetworkAccessManager::Operation operation, const QNetworkRequest &request,
+                               QObject *parent)
+    : QNetworkReply(parent)
+{
+    setOperation(operation);
+    setRequest(request);
+    setUrl(request.url());
+    open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+}
+
+/**
+ * @brief Ustawia kod statusu i nagłówki odpowiedzi.
+ * @param statusCode Kod statusu HTTP.
+ * @param headers Nagłówki odpowiedzi.
+ * @param fromCache true, jeśli odpowiedź pochodzi z pamięci podręcznej.
+ */
+void TransportReply::setResponseMetaData(int statusCode, const QList<QPair<QByteArray, QByteArray>> &headers,
+                                         bool fromCache)
+{
+    setAttribute(QNetworkRequest::HttpStatusCodeAttribute, statusCode);
+    setAttribute(QNetworkRequest::SourceIsFromCacheAttribute, fromCache);
+    for (const QPair<QByteArray, QByteArray> &header : headers)
+        setRawHeader(header.first, header.second);
+    emit metaDataChanged();
+}
+
+/**
+ * @brief Dopisuje kolejny fragment treści i powiadamia odbiorcę.
+ * @param data Fragment treści.
+ */
+void TransportReply::appendData(const QByteArray &data)
+{
+    if (isFinished() || data.isEmpty())
+        return;
+
+    if (readOffset > 0 && readOffset == buffer.size()) {
+        buffer.clear();
+        readOffset = 0;
+    }
+    buffer.append(data);
+    emit readyRead();
+}
+
+/**
+ * @brief Kończy odpowiedź.
+ * @param error Kod błędu.
+ * @param errorString Opis błędu.
+ */
+void TransportReply::finishReply(NetworkError error, const QString &errorString)
+{
+    if (isFinished())
+        return;
+
+    if (error != NoError) {
+        setError(error, errorString);
+        emit errorOccurred(error);
+    }
+    setFinished(true);
+    emit finished();
+}
+
+/**
+ * @brief Przerywa odpowiedź i odrzuca nieodczytane dane.
+ */
+void TransportReply::abort()
+{
+    if (isFinished())
+        return;
+
+    buffer.clear();
+    readOffset = 0;
+    emit aborted();
+    finishReply(OperationCanceledError, "Operation canceled");
+}
+
+/**
+ * @brief Zwraca liczbę bajtów gotowych do odczytu.
+ */
+qint64 TransportReply::bytesAvailable() const
+{
+    return buffer.size() - readOffset + QNetworkReply::bytesAvailable();
+}
+
+/**
+ * @brief Odczytuje dane z bufora odpowiedzi.
+ * @param data Bufor docelowy.
+ * @param maxSize Maksymalna liczba bajtów.
+ * @return Liczba odczytanych bajtów lub -1 po zakończeniu odpowiedzi.
+ */
+qint64 TransportReply::readData(char *data, qint64 maxSize)
+{
+    const qint64 count = qMin(maxSize, qint64(buffer.size()) - readOffset);
+    if (count <= 0)
+        return isFinished() ? -1 : 0;
+
+    std::memcpy(data, buffer.constData() + readOffset, size_t(count));
+    readOffset += count;
+    return count;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file transportreply.h
+ * @brief Definicja klasy TransportReply - odpowiedzi sieciowej z danymi podawanymi przez NetworkTransport.
+ */
+
+#ifndef TRANSPORTREPLY_H
+#define TRANSPORTREPLY_H
+
+#include <QNetworkReply>
+#include <QNetworkAccessManager>
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+
+/**
+ * @class TransportReply
+ * @brief Odpowiedź, której nagłówki i treść dostarcza NetworkTransport.
+ *
+ * Służy zarówno do odtwarzania nagranych odpowiedzi, jak i do przekazywania odpowiedzi
+ * z sieci w trakcie ich nagrywania. Dla odbiorcy zachowuje się jak zwykła QNetworkReply:
+ * emituje metaDataChanged, readyRead i finished.
+ */
+class TransportReply : public QNetworkReply
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Konstruktor klasy TransportReply.
+     * @param operation Rodzaj operacji HTTP.
+     * @param request Zapytanie.
+     * @param parent Obiekt nadrzędny.
+     */
+    TransportReply(QNetworkAccessManager::Operation operation, const QNetworkRequest &request,
+                   QObject *parent = nullptr);
+
+    /**
+     * @brief Ustawia kod statusu i nagłówki odpowiedzi.
+     * @param statusCode Kod statusu HTTP.
+     * @param headers Nagłówki odpowiedzi.
+     * @param fromCache true, jeśli odpowiedź pochodzi z pamięci podręcznej.
+     */
+    void setResponseMetaData(int statusCode, const QList<QPair<QByteArray, QByteArray>> &headers,
+                             bool fromCache = false);
+
+    /**
+     * @brief Dopisuje kolejny fragment treści i powiadamia odbiorcę.
+     * @param data Fragment treści.
+     */
+    void appendData(const QByteArray &data);
+
+    /**
+     * @brief Kończy odpowiedź.
+     * @param error Kod błędu (NoError, jeśli odpowiedź jest poprawna).
+     * @param errorString Opis błędu.
+     */
+    void finishReply(NetworkError error = NoError, const QString &errorString = QString());
+
+    /** @brief Przerywa odpowiedź. */
+    void abort() override;
+
+    /** @brief Zwraca liczbę bajtów gotowych do odczytu. */
+    qint64 bytesAvailable() const override;
+
+    /** @brief Odpowiedź jest urządzeniem sekwencyjnym. */
+    bool isSequential() const override { return true; }
+
+signals:
+    /** @brief Emitowany, gdy odbiorca przerwał odpowiedź. */
+    void aborted();
+
+protected:
+    /**
+     * @brief Odczytuje dane z bufora odpowiedzi.
+     * @param data Bufor docelowy.
+     * @param maxSize Maksymalna liczba bajtów.
+     * @return Liczba odczytanych bajtów lub -1 po zakończeniu odpowiedzi.
+     */
+    qint64 readData(char *data, qint64 maxSize) override;
+
+private:
+    QByteArray buffer;
+    qint64 readOffset = 0;
+};
+
+#endif // TRANSPORTREPLY_H